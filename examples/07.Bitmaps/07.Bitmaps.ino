@@ -26,6 +26,9 @@
     *If no option is changed by the user, the following defaults are used:
       * transparency = TLBFISLib::OPAQUE
       * color = TLBFISLib::NORMAL
+
+    *Bitmaps are split into blocks of up to 42 bytes; calibrateBlockSize() finds out whether the cluster accepts longer ones (up to TLB_MAX_BYTES_PER_BLOCK),
+    or only shorter ones, so that bitmaps are sent in as few blocks as it allows.
 */
 
 //Include the FIS library.
@@ -114,6 +117,9 @@ void setup() {
   FIS.begin();
   FIS.initScreen();
 
+  //Find the largest block the cluster accepts (the probes don't change the screen).
+  FIS.calibrateBlockSize();
+
   //All commands have been moved to the drawScreen() function (defined below), so that the custom functions can also execute it.
   drawScreen();
 }
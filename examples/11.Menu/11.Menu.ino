@@ -0,0 +1,97 @@
+/*
+  Title:
+    11.Menu.ino
+
+  Description:
+    Demonstrates how to display a scrolling menu with the TLBFISMenu class.
+
+  Notes:
+    *The menu keeps track of its items, the selected item and which items are visible, and only redraws what changed.
+    *Moving the cursor between visible items only toggles the highlighting of two lines; scrolling redraws the menu.
+    *In this demo, the cursor moves to the next item every second, and jumps back to the first one after reaching the end of the list.
+*/
+
+//Include the FIS library and the menu class.
+#include <TLBFISLib.h>
+#include <TLBFISMenu.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create a menu covering the entire HALFSCREEN area (6 rows of 8 pixels).
+TLBFISMenu Menu(FIS);
+
+//Menu items
+const char* items[] = {
+  "Trip data",
+  "Fuel",
+  "Temperatures",
+  "Navigation",
+  "Radio",
+  "Phone",
+  "Lights",
+  "Settings",
+  "About"
+};
+
+//Timer for moving the cursor
+unsigned long last_move_time;
+
+void setup() {
+  //If an error occurs, initialize the screen again and redraw the entire menu.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      Menu.draw();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  
+  //Give the items to the menu and draw it.
+  Menu.setItems(items, sizeof(items) / sizeof(items[0]));
+  Menu.draw();
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Every second, move the cursor.
+  if (millis() - last_move_time >= 1000) {
+    last_move_time = millis();
+    
+    //After the last item, jump back to the first one.
+    if (Menu.getSelected() + 1 >= Menu.getItemCount()) {
+      Menu.select(0);
+    }
+    else {
+      Menu.next();
+    }
+  }
+}
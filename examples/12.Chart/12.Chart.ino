@@ -0,0 +1,85 @@
+/*
+  Title:
+    12.Chart.ino
+
+  Description:
+    Demonstrates how to plot a sensor's history with the TLBFISChart class.
+
+  Notes:
+    *The chart sweeps from left to right, drawing every sample in the next column and wrapping around at the right edge.
+    *Adding a sample only sends the part of the column which changed (and clears the column in front of it), so the chart is never redrawn entirely.
+    *In this demo, the value of an analog input is plotted 10 times per second.
+*/
+
+//Include the FIS library and the chart class.
+#include <TLBFISLib.h>
+#include <TLBFISChart.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+#define SENSOR_PIN   A0
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create a chart below the title, covering the rest of the HALFSCREEN area.
+TLBFISChart Chart(FIS, 0, 10, 64, 38, TLBFISChart::LINE_CHART);
+
+//Timer for taking samples
+unsigned long last_sample_time;
+
+void setup() {
+  //If an error occurs, initialize the screen again and redraw the chart (the samples are kept).
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      drawTitle();
+      Chart.draw();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  drawTitle();
+  
+  //The analog input gives values between 0 and 1023.
+  Chart.setRange(0, 1023);
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Take a sample every 100ms.
+  if (millis() - last_sample_time >= 100) {
+    last_sample_time = millis();
+    Chart.addSample(analogRead(SENSOR_PIN));
+  }
+}
+
+void drawTitle() {
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.setTextAlignment(TLBFISLib::CENTER);
+  FIS.writeText(0, 1, "SENSOR");
+}
@@ -0,0 +1,91 @@
+/*
+  Title:
+    13.Ticker.ino
+
+  Description:
+    Demonstrates how to scroll a long message with the TLBFISTicker class.
+
+  Notes:
+    *The message is converted to the cluster's character set once, when it's set; every frame is a single text command.
+    *The workspace is set to the ticker's area after drawing the title, so that the ticker doesn't have to change it for every frame.
+    *In this demo, the message moves by one pixel every 40ms.
+*/
+
+//Include the FIS library and the ticker class.
+#include <TLBFISLib.h>
+#include <TLBFISTicker.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create a ticker in the middle of the HALFSCREEN area.
+TLBFISTicker Ticker(FIS, 0, 20, 64);
+
+//The message is stored in PROGMEM, and ends with spaces to separate the repetitions.
+const char message[] PROGMEM = "Now playing: a song title which is too long for the screen    ";
+
+//Timer for scrolling
+unsigned long last_step_time;
+
+void setup() {
+  //If an error occurs, initialize the screen again and redraw everything.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      drawTitle();
+      Ticker.draw();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  drawTitle();
+  
+  //Convert the message once.
+  Ticker.setText(message, true);
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Scroll by one pixel every 40ms.
+  if (millis() - last_step_time >= 40) {
+    last_step_time = millis();
+    Ticker.step();
+  }
+}
+
+void drawTitle() {
+  FIS.resetWorkspace();
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.setTextAlignment(TLBFISLib::CENTER);
+  FIS.writeText(0, 1, "RADIO");
+  
+  //Leave the workspace set to the ticker's area.
+  FIS.setWorkspace(0, 20, 64, TLBFIS_TICKER_HEIGHT);
+}
@@ -0,0 +1,87 @@
+/*
+  Title:
+    14.Console.ino
+
+  Description:
+    Demonstrates how to display a log with the TLBFISConsole class.
+
+  Notes:
+    *Lines are added at the bottom, and the oldest line scrolls off when the console is full.
+    *When scrolling, only the characters which differ from what's already displayed on each row are sent, so similar lines are cheap to scroll.
+    *In this demo, the uptime and the value of an analog input are logged every second.
+*/
+
+//Include the FIS library and the console class.
+#include <TLBFISLib.h>
+#include <TLBFISConsole.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+#define SENSOR_PIN   A0
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create a console below the title, covering the rest of the HALFSCREEN area.
+TLBFISConsole Console(FIS, 0, 10, 64, 38);
+
+//Timer for logging
+unsigned long last_log_time;
+
+void setup() {
+  //If an error occurs, initialize the screen again and redraw everything (the lines are kept).
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      drawTitle();
+      Console.draw();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  drawTitle();
+  
+  Console.println("Started");
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Log a line every second.
+  if (millis() - last_log_time >= 1000) {
+    last_log_time = millis();
+    
+    char line[21];
+    snprintf(line, sizeof(line), "%lus A0=%d", millis() / 1000, analogRead(SENSOR_PIN));
+    Console.println(line);
+  }
+}
+
+void drawTitle() {
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.setTextAlignment(TLBFISLib::CENTER);
+  FIS.writeText(0, 1, "LOG");
+}
@@ -0,0 +1,97 @@
+/*
+  Title:
+    15.Formatting.ino
+
+  Description:
+    Demonstrates how to display values with printAt() and with the Arduino print() functions, through the TLBFISPrint class.
+
+  Notes:
+    *printAt() works like printf(), but the characters are added to the text command as they are produced, so no buffer is needed.
+    *With the COMPACT font, numbers padded to a width (like "%5d") use spaces as wide as a digit, so fixNumberPadding() is not needed.
+    *%q displays an integer as a fixed point number: with "%.1q", 235 is displayed as "23.5".
+*/
+
+//Include the FIS library and the print adapter.
+#include <TLBFISLib.h>
+#include <TLBFISPrint.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+#define SENSOR_PIN   A0
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create a print adapter, which will write starting from the 5th line.
+TLBFISPrint Printer(FIS, 0, 33);
+
+//Timer for refreshing the values
+unsigned long refresh_timer;
+
+void setup() {
+  //If an error occurs, initialize the screen again.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  
+  //Set the font to be used for the demo.
+  FIS.setFont(TLBFISLib::COMPACT);
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Refresh the values every 200ms.
+  if (millis() - refresh_timer >= 200) {
+    refresh_timer = millis();
+    
+    int raw = analogRead(SENSOR_PIN);
+    
+    //An integer padded to 4 digits.
+    FIS.printAt(0, 1, "Raw: %4d", raw);
+    
+    //The same value as a voltage, in hundredths of a volt, displayed as a fixed point number.
+    FIS.printAt(0, 9, "U: %4.2qV", (int)((long)raw * 500 / 1023));
+    
+    //The format string can also be stored in PROGMEM.
+    FIS.printAt_P(0, 17, PSTR("Up: %6lus"), millis() / 1000);
+    
+    //The Arduino print() functions can be used as well; a newline moves to the next line.
+    Printer.setCursor(0, 33);
+    Printer.print("Float: ");
+    Printer.println(raw / 1023.0, 3);
+    Printer.print(F("Hex: 0x"));
+    Printer.print(raw, HEX);
+    Printer.print("   ");
+    
+    //Send the last line right away.
+    Printer.flush();
+  }
+}
@@ -0,0 +1,97 @@
+/*
+  Title:
+    16.Numeric_fields.ino
+
+  Description:
+    Demonstrates how to display values which change often with the TLBFISNumber class.
+
+  Notes:
+    *A field always has the same width: missing digits are replaced by blank characters, so the digits don't move and nothing "ghosts".
+    *When the value changes, only the characters which differ are sent (for example, only the last digit when going from 850 to 851).
+    *Values with decimals are given as integers: with 1 decimal, 235 is displayed as "23.5".
+    *In this demo, simulated values are refreshed 20 times per second.
+*/
+
+//Include the FIS library and the numeric field class.
+#include <TLBFISLib.h>
+#include <TLBFISNumber.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create the fields: 4 digits for RPM, 3 digits for speed, 3 digits with 1 decimal (and a sign) for temperature.
+TLBFISNumber RPM(FIS, 20, 1, 4);
+TLBFISNumber Speed(FIS, 20, 9, 3);
+TLBFISNumber Temperature(FIS, 20, 17, 3, 1, true);
+
+//Timer for refreshing the values
+unsigned long refresh_timer;
+
+void setup() {
+  //If an error occurs, initialize the screen again and redraw everything.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      drawLabels();
+      RPM.invalidate();
+      Speed.invalidate();
+      Temperature.invalidate();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  drawLabels();
+  
+  //Set the units, displayed after the numbers.
+  RPM.setUnit(" rpm");
+  Speed.setUnit(" km/h");
+  Temperature.setUnit(" " DEGREE "C");
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Refresh the values every 50ms.
+  if (millis() - refresh_timer >= 50) {
+    refresh_timer = millis();
+    
+    //Simulate some values.
+    unsigned long t = millis() / 50;
+    RPM.setValue(800 + (t * 37) % 5200);
+    Speed.setValue((t / 4) % 200);
+    Temperature.setValue((long)(t % 800) - 200);
+  }
+}
+
+void drawLabels() {
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.writeText(0, 1, "RPM");
+  FIS.writeText(0, 9, "SPD");
+  FIS.writeText(0, 17, "TMP");
+}
@@ -0,0 +1,84 @@
+/*
+  Title:
+    17.Big_digits.ino
+  
+  Description:
+    Demonstrates how to display a large readout (like the speed) with the TLBFISSegments class.
+  
+  Notes:
+    *Every digit is made of 7 rectangular segments, and every segment is a single 7-byte command.
+    *When the value changes, only the segments which turn on or off are sent (for example, a single segment when going from 88 to 89).
+    *In this demo, a simulated speed is refreshed 10 times per second.
+*/
+
+//Include the FIS library and the 7-segment display class.
+#include <TLBFISLib.h>
+#include <TLBFISSegments.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create a display with 3 digits, 12x25 pixels each, with 3-pixel-thick segments, centered in the HALFSCREEN area.
+TLBFISSegments Speed(FIS, 9, 6, 3, 12, 25, 3, 5);
+
+//Timer for refreshing the value
+unsigned long refresh_timer;
+
+void setup() {
+  //If an error occurs, initialize the screen again and redraw everything.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      drawLabel();
+      Speed.invalidate();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  drawLabel();
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Refresh the value every 100ms.
+  if (millis() - refresh_timer >= 100) {
+    refresh_timer = millis();
+    
+    //Simulate the speed.
+    Speed.setValue((millis() / 100) % 250);
+  }
+}
+
+void drawLabel() {
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.setTextAlignment(TLBFISLib::CENTER);
+  FIS.writeText(0, 36, "km/h");
+  FIS.setTextAlignment(TLBFISLib::LEFT);
+}
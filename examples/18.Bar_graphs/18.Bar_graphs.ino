@@ -0,0 +1,98 @@
+/*
+  Title:
+    18.Bar_graphs.ino
+
+  Description:
+    Demonstrates how to display levels and progress with the TLBFISBar class.
+
+  Notes:
+    *When the value changes, only the span between the old and the new level is sent, as a single 7-byte command; the border and the tick marks
+    are only drawn once.
+    *Horizontal bars grow from left to right, vertical bars grow from bottom to top.
+    *In this demo, simulated values are refreshed 20 times per second.
+*/
+
+//Include the FIS library and the bar class.
+#include <TLBFISLib.h>
+#include <TLBFISBar.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create a horizontal progress bar with tick marks, and two vertical bars without a border.
+TLBFISBar Progress(FIS, 2, 8, 60, 7);
+TLBFISBar Left(FIS, 20, 22, 8, 24, TLBFISLib::VERTICAL, false);
+TLBFISBar Right(FIS, 36, 22, 8, 24, TLBFISLib::VERTICAL, false);
+
+//Timer for refreshing the values
+unsigned long refresh_timer;
+
+void setup() {
+  //If an error occurs, initialize the screen again and redraw everything.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      drawLabels();
+      Progress.invalidate();
+      Left.invalidate();
+      Right.invalidate();
+    }
+  );
+  
+  //Divide the progress bar into quarters.
+  Progress.setTicks(4);
+  
+  //The vertical bars display values between -100 and 100.
+  Left.setRange(-100, 100);
+  Right.setRange(-100, 100);
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  drawLabels();
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Refresh the values every 50ms.
+  if (millis() - refresh_timer >= 50) {
+    refresh_timer = millis();
+    
+    //Simulate some values.
+    unsigned long t = millis() / 50;
+    Progress.setValue(t % 101);
+    Left.setValue((long)(t * 7 % 200) - 100);
+    Right.setValue((long)(t * 3 % 200) - 100);
+  }
+}
+
+void drawLabels() {
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.writeText(2, 0, "PROGRESS");
+  FIS.writeText(2, 30, "L/R");
+}
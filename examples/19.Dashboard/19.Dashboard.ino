@@ -0,0 +1,104 @@
+/*
+  Title:
+    19.Dashboard.ino
+  
+  Description:
+    Demonstrates how to let update() refresh several widgets, each at its own rate.
+  
+  Notes:
+    *Widgets registered with addWidget() don't send anything when their value is set; update() sends the latest value of each widget which changed,
+    at most once per refresh interval, so the sketch can set values as often as it wants without timers.
+    *setWidgetBudget() limits how long a single call to update() may spend on widgets; the ones which don't get a turn are refreshed by the
+    following calls.
+    *Registered widgets are redrawn entirely after initScreen(), so the error function doesn't need to invalidate them.
+*/
+
+//Include the FIS library and the widget classes.
+#include <TLBFISLib.h>
+#include <TLBFISNumber.h>
+#include <TLBFISBar.h>
+#include <TLBFISSegments.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create the widgets: a large speed readout, an RPM field with a bar below it, and a coolant temperature field.
+TLBFISSegments Speed(FIS, 15, 0, 3, 9, 17, 2, 3);
+TLBFISNumber RPM(FIS, 16, 22, 4);
+TLBFISBar RPM_bar(FIS, 2, 30, 60, 5, TLBFISLib::HORIZONTAL, false);
+TLBFISNumber Coolant(FIS, 16, 40, 3, 0, true);
+
+void setup() {
+  //If an error occurs, initialize the screen again (which makes the registered widgets redraw) and redraw the labels.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      drawLabels();
+    }
+  );
+  
+  //Configure the widgets.
+  RPM.setUnit(" rpm");
+  RPM_bar.setRange(0, 7000);
+  Coolant.setUnit(" " DEGREE "C");
+  
+  //Register the widgets, with how often each of them may be refreshed.
+  Speed.setRefreshInterval(250);
+  RPM.setRefreshInterval(100);
+  RPM_bar.setRefreshInterval(50);
+  Coolant.setRefreshInterval(1000);
+  FIS.addWidget(Speed);
+  FIS.addWidget(RPM);
+  FIS.addWidget(RPM_bar);
+  FIS.addWidget(Coolant);
+  
+  //Don't spend more than 20ms refreshing widgets in a single call to update().
+  FIS.setWidgetBudget(20);
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  drawLabels();
+}
+
+void loop() {
+  //Maintain the connection and refresh the widgets.
+  FIS.update();
+  
+  //Simulate some values; nothing is sent until update() decides to.
+  unsigned long t = millis();
+  long rpm = 800 + (t / 3) % 6200;
+  Speed.setValue(rpm / 40);
+  RPM.setValue(rpm);
+  RPM_bar.setValue(rpm);
+  Coolant.setValue((t / 2000) % 110);
+}
+
+void drawLabels() {
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.writeText(0, 22, "RPM");
+  FIS.writeText(0, 40, "H2O");
+}
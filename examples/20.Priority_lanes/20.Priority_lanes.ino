@@ -0,0 +1,116 @@
+/*
+  Title:
+    20.Priority_lanes.ino
+  
+  Description:
+    Demonstrates how to load a large image without delaying more urgent commands, with the bulk lane.
+  
+  Notes:
+    *drawBitmap() sends the entire image before returning, which takes a while for a large one; queueBitmap() only records it, and update() sends
+    one block of it in every call (see setBulkBlocksPerUpdate()).
+    *Anything drawn while the image is loading (like the radio text in this demo) is sent right away, so it never waits for more than one block.
+    *The bitmap must remain valid until it was sent entirely (getQueuedBitmaps() returns 0).
+    *Widgets registered with addWidget() can also be given a lane: LANE_URGENT widgets are refreshed first, LANE_BULK widgets after the queued
+    bitmaps.
+*/
+
+//Include the FIS library.
+#include <TLBFISLib.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//64x45
+const unsigned char logo[] PROGMEM = {
+	0xff, 0xff, 0xc0, 0x7e, 0x00, 0x03, 0xff, 0xf0, 0xff, 0xff, 0xc0, 0x7e, 0x00, 0x03, 0xff, 0xf8, 
+	0xff, 0xff, 0xc0, 0x7e, 0x00, 0x03, 0xff, 0xfc, 0xff, 0xff, 0xc0, 0x7e, 0x00, 0x03, 0xff, 0xfc, 
+	0xff, 0xff, 0xc0, 0x7e, 0x00, 0x03, 0xff, 0xfc, 0xff, 0xff, 0xc0, 0x7e, 0x00, 0x03, 0xff, 0xfc, 
+	0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xf0, 0x3c, 0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xf0, 0x3c, 
+	0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xff, 0xfc, 0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xff, 0xf8, 
+	0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xff, 0xf0, 0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xff, 0xfc, 
+	0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xff, 0xfe, 0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xff, 0xff, 
+	0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xf0, 0x3f, 0x03, 0xf0, 0x00, 0x7e, 0x00, 0x03, 0xf0, 0x3f, 
+	0x03, 0xf0, 0x00, 0x7f, 0xfe, 0x03, 0xff, 0xff, 0x03, 0xf0, 0x00, 0x7f, 0xfe, 0x03, 0xff, 0xff, 
+	0x03, 0xf0, 0x00, 0x7f, 0xfe, 0x03, 0xff, 0xff, 0x03, 0xf0, 0x00, 0x7f, 0xfe, 0x03, 0xff, 0xff, 
+	0x03, 0xf0, 0x00, 0x7f, 0xfe, 0x03, 0xff, 0xfe, 0x03, 0xf0, 0x00, 0x7f, 0xfe, 0x03, 0xff, 0xfc, 
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xc0, 0x07, 0xe0, 0x00, 0xff, 0xff, 
+	0xff, 0xff, 0xc0, 0x07, 0xe0, 0x01, 0xff, 0xff, 0xff, 0xff, 0xc0, 0x07, 0xe0, 0x03, 0xff, 0xff, 
+	0xff, 0xff, 0xc0, 0x07, 0xe0, 0x03, 0xff, 0xff, 0xff, 0xff, 0xc0, 0x07, 0xe0, 0x03, 0xff, 0xff, 
+	0xff, 0xff, 0xc0, 0x07, 0xe0, 0x03, 0xff, 0xff, 0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xf0, 0x00, 
+	0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xf0, 0x00, 0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xfc, 
+	0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xfe, 0xff, 0xfc, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xff, 
+	0xff, 0xfc, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xff, 0xff, 0xfc, 0x00, 0x07, 0xe0, 0x01, 0xff, 0xff, 
+	0xff, 0xfc, 0x00, 0x07, 0xe0, 0x00, 0xff, 0xff, 0xff, 0xfc, 0x00, 0x07, 0xe0, 0x00, 0x00, 0x3f, 
+	0xff, 0xfc, 0x00, 0x07, 0xe0, 0x00, 0x00, 0x3f, 0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xff, 
+	0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xff, 0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xff, 
+	0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xff, 0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xfe, 
+	0xfc, 0x00, 0x00, 0x07, 0xe0, 0x03, 0xff, 0xfc
+};
+
+//Timers for the image and the radio text
+unsigned long image_timer, radio_timer;
+bool inverted = false;
+
+void setup() {
+  //If an error occurs, initialize the screen again and load the image again.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      FIS.clearBitmapQueue();
+      FIS.queueBitmap(0, 2, 64, 45, logo);
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  
+  //Queue the image; it will be sent by update().
+  FIS.queueBitmap(0, 2, 64, 45, logo);
+}
+
+void loop() {
+  //Maintain the connection, sending a block of the image if it's still loading.
+  FIS.update();
+  
+  //Every 5 seconds, load the image again with the other color.
+  if (millis() - image_timer >= 5000) {
+    image_timer = millis();
+    
+    inverted = !inverted;
+    FIS.setDrawColor(inverted ? TLBFISLib::INVERTED : TLBFISLib::NORMAL);
+    FIS.queueBitmap(0, 2, 64, 45, logo);
+  }
+  
+  //Every 100ms, update the radio text; it's sent right away, even while the image is loading.
+  if (millis() - radio_timer >= 100) {
+    radio_timer = millis();
+    
+    char buffer[9];
+    snprintf(buffer, sizeof(buffer), "%7lu", millis() / 100);
+    FIS.writeRadioText(0, buffer);
+  }
+}
@@ -0,0 +1,100 @@
+/*
+  Title:
+    21.Sleep.ino
+  
+  Description:
+    Demonstrates how to sleep between calls to update(), instead of calling it constantly.
+  
+  Notes:
+    *msUntilNextUpdate() provides how long the sketch may wait before update() has something to do: maintain the connection, refresh a widget or
+    send queued data.
+    *Calling update() earlier is harmless, so the sketch can also wake up for its own events (like a button) in the meantime.
+    *On AVR boards, this sketch uses the idle sleep mode, which stops the CPU until the next interrupt (the millis() timer wakes it every
+    millisecond); other boards have their own sleep modes, which can be used the same way.
+    *If the board wakes up late, the cluster may drop the connection; setKeepaliveInterval() can be used to leave more margin.
+*/
+
+//Include the FIS library.
+#include <TLBFISLib.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+#ifdef __AVR__
+//Include the AVR sleep functions.
+#include <avr/sleep.h>
+#endif
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Timer for the clock
+unsigned long clock_timer;
+
+void setup() {
+  //If an error occurs, initialize the screen again.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Every second, display how long the sketch has been running.
+  if (millis() - clock_timer >= 1000) {
+    clock_timer = millis();
+    
+    unsigned long seconds = millis() / 1000;
+    FIS.printAt(0, 20, "%02lu:%02lu", seconds / 60 % 60, seconds % 60);
+  }
+  
+  //Sleep until update() or the clock needs to run again.
+  unsigned long wait = FIS.msUntilNextUpdate();
+  unsigned long clock_wait = 1000 - (millis() - clock_timer);
+  if (clock_wait < wait) {
+    wait = clock_wait;
+  }
+  sleep_for(wait);
+}
+
+//Wait for the given time (in milliseconds), sleeping as much as possible.
+void sleep_for(unsigned long wait)
+{
+  unsigned long start = millis();
+  while (millis() - start < wait) {
+#ifdef __AVR__
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+#else
+    yield();
+#endif
+  }
+}
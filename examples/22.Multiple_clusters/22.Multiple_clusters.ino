@@ -0,0 +1,93 @@
+/*
+  Title:
+    22.Multiple_clusters.ino
+  
+  Description:
+    Demonstrates how to drive several clusters connected to the same bus, each with its own ENA pin.
+  
+  Notes:
+    *Every cluster has its own instance of the library, and all of them are registered to a TLBFISBus, whose update() replaces theirs.
+    *The clusters take turns, a few blocks at a time: their widgets and the bitmaps queued with queueBitmap() are sent interleaved, and a cluster
+    which isn't ready gives up its turn (after the slice set by setSlice()) instead of holding up the others.
+    *Drawing functions called directly still wait for their own cluster, so work which should be shared fairly should go through widgets or
+    queueBitmap().
+*/
+
+//Include the FIS library, the bus scheduler and the numeric field widget.
+#include <TLBFISLib.h>
+#include <TLBFISBus.h>
+#include <TLBFISNumber.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN_1    9
+#define ENA_PIN_2    8
+
+//Define the function to be called when the library needs to send a byte (the same for all clusters).
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library for each cluster.
+TLBFISLib FIS1(ENA_PIN_1, sendFunction, beginFunction);
+TLBFISLib FIS2(ENA_PIN_2, sendFunction, beginFunction);
+
+//Create the bus scheduler.
+TLBFISBus bus;
+
+//Create a numeric field on each cluster.
+TLBFISNumber counter1(FIS1, 8, 20, 6);
+TLBFISNumber counter2(FIS2, 8, 20, 6);
+
+void setup() {
+  //If an error occurs on a cluster, initialize its screen again (its registered widgets are redrawn by the bus).
+  FIS1.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS1.initScreen();
+    }
+  );
+  FIS2.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS2.initScreen();
+    }
+  );
+  
+  //Start the library and initialize the screen of each cluster.
+  FIS1.begin();
+  FIS1.initScreen();
+  FIS2.begin();
+  FIS2.initScreen();
+  
+  //Let the clusters' update() send the widgets.
+  FIS1.addWidget(counter1);
+  FIS2.addWidget(counter2);
+  
+  //Register the clusters to the bus.
+  bus.addCluster(FIS1);
+  bus.addCluster(FIS2);
+}
+
+void loop() {
+  //Maintain the connections, giving every cluster a turn.
+  bus.update();
+  
+  //Display the time in tenths of a second on the first cluster, and in seconds on the second one.
+  counter1.setValue(millis() / 100);
+  counter2.setValue(millis() / 1000);
+}
@@ -0,0 +1,105 @@
+/*
+  Title:
+    23.RTOS_tasks.ino
+  
+  Description:
+    Demonstrates how to draw in one FreeRTOS task while another task transmits, with a submission queue (ESP32).
+  
+  Notes:
+    *With submissionQueue(), drawing functions only encode the blocks and add them to the queue, so they return right away unless the queue is
+    full; update(), called by the bus task, transmits them and maintains the connection.
+    *The drawing task must call updateWidgets() instead of update(), and the bus task must not use any drawing functions.
+    *The queue has a single producer and a single consumer and uses no locks, so neither task ever blocks the other.
+    *The error function is executed by the bus task, so it only signals the drawing task to initialize the screen again.
+*/
+
+#ifndef ARDUINO_ARCH_ESP32
+#error This example requires an ESP32.
+#endif
+
+//Include the FIS library and the submission queue.
+#include <TLBFISLib.h>
+#include <TLBFISQueue.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create the submission queue.
+TLBFISQueue queue;
+
+//Set by the error function, cleared by the drawing task
+volatile bool reinit_requested = false;
+
+//The bus task transmits the queued blocks.
+void busTask(void* parameter)
+{
+  (void) parameter;
+  
+  while (true) {
+    FIS.update();
+    
+    //Sleep until something must be transmitted (at least one tick, to let the idle task run).
+    unsigned long wait = FIS.msUntilNextUpdate();
+    vTaskDelay(wait > portTICK_PERIOD_MS ? pdMS_TO_TICKS(wait) : 1);
+  }
+}
+
+void setup() {
+  //If an error occurs, ask the drawing task to initialize the screen again.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      reinit_requested = true;
+    }
+  );
+  
+  //Start the library and attach the queue, before the bus task starts.
+  FIS.begin();
+  FIS.submissionQueue(&queue);
+  
+  //Start the bus task on the other core.
+  xTaskCreatePinnedToCore(busTask, "busTask", 4096, nullptr, 2, nullptr, 0);
+  
+  //Initialize the screen (queued like any other command).
+  FIS.initScreen();
+}
+
+//loop() runs in the drawing task.
+void loop() {
+  //If the bus task reported an error, initialize the screen again.
+  if (reinit_requested) {
+    reinit_requested = false;
+    FIS.initScreen();
+  }
+  
+  //Draw a frame; the functions return as soon as the blocks are queued.
+  FIS.printAt(0, 8, "%8lu", millis());
+  FIS.printAt(0, 24, "Queue: %u/%u", queue.getCount(), queue.getCapacity());
+  
+  //Send the text waiting to be merged (and the widgets, if there are any).
+  FIS.updateWidgets();
+  
+  delay(20);
+}
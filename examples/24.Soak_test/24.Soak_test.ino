@@ -0,0 +1,124 @@
+/*
+  Title:
+    24.Soak_test.ino
+  
+  Description:
+    Demonstrates how to soak-test a dashboard on the cluster, with transport statistics.
+  
+  Notes:
+    *transportStatistics() counts the blocks, retries and recoveries; the report printed every 10 seconds shows the throughput, the longest time a
+    single block blocked the sketch and the longest time the cluster took to recover.
+    *The library only uses millis(), micros() and delayMicroseconds() for timing, so the same dashboard also runs on a computer, against a
+    simulated cluster which misbehaves on purpose (REPEAT storms, FAIL bursts and calls of the error function) and with a virtual clock, to run
+    hours of traffic in seconds: see extras/host/soak_test.cpp.
+*/
+
+//Include the FIS library and the widget classes.
+#include <TLBFISLib.h>
+#include <TLBFISNumber.h>
+#include <TLBFISBar.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Create the dashboard.
+TLBFISNumber speed(FIS, 4, 4, 3);
+TLBFISBar rpm(FIS, 4, 24, 56, 8);
+
+//Counters
+TLBFISLib::transportStats stats;
+unsigned long errors = 0;
+
+//Timer for the report
+unsigned long report_timer;
+
+void setup() {
+  Serial.begin(115200);
+  
+  //If an error occurs, initialize the screen again; the widgets are redrawn by update().
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      errors++;
+      FIS.initScreen();
+    }
+  );
+  
+  //Give up on a block after 3 errors, and on a call after 50ms.
+  FIS.setRetryPolicy(3, 50, 100);
+  
+  //Start counting.
+  FIS.transportStatistics(&stats);
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  
+  //Register the dashboard.
+  rpm.setRange(0, 7000);
+  speed.setRefreshInterval(100);
+  rpm.setRefreshInterval(50);
+  FIS.addWidget(speed);
+  FIS.addWidget(rpm);
+}
+
+void loop() {
+  //Maintain the connection and refresh the dashboard.
+  FIS.update();
+  
+  //Simulate the values.
+  speed.setValue((millis() / 100) % 250);
+  rpm.setValue((millis() * 7) % 7000);
+  
+  //Every 10 seconds, print the report and start counting again.
+  if (millis() - report_timer >= 10000) {
+    unsigned long elapsed = millis() - report_timer;
+    report_timer = millis();
+    
+    Serial.print(F("Throughput: "));
+    Serial.print(stats.bytes * 1000 / elapsed);
+    Serial.print(F(" B/s, blocks: "));
+    Serial.print(stats.blocks);
+    Serial.print(F(", repeats: "));
+    Serial.print(stats.repeats);
+    Serial.print(F(", failures: "));
+    Serial.print(stats.failures);
+    Serial.print(F(", given up: "));
+    Serial.print(stats.given_up);
+    Serial.print(F(", errors: "));
+    Serial.println(errors);
+    
+    Serial.print(F("Worst block: "));
+    Serial.print(stats.worst_block_us);
+    Serial.print(F(" us, worst recovery: "));
+    Serial.print(stats.worst_recovery_ms);
+    Serial.print(F(" ms over "));
+    Serial.print(stats.recoveries);
+    Serial.println(F(" recoveries"));
+    
+    FIS.resetTransportStatistics();
+    errors = 0;
+  }
+}
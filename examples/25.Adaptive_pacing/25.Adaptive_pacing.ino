@@ -0,0 +1,109 @@
+/*
+  Title:
+    25.Adaptive_pacing.ino
+  
+  Description:
+    Demonstrates how to let the library pace the blocks according to how quickly the cluster accepts them.
+  
+  Notes:
+    *Without pacing, a block which the cluster isn't ready for is attempted again right away, until it's accepted; with setAdaptivePacing(), the
+    library learns how long the cluster needs between blocks and waits that long instead, so most blocks are accepted on the first attempt.
+    *While there is a pause, text which update() would send is kept a little longer (the coalescing window), so the characters written by this
+    sketch, one at a time, are sent together.
+    *The pause and the window are printed every second; they follow the cluster, so they change while it's busy.
+*/
+
+//Include the FIS library.
+#include <TLBFISLib.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Message which is typed on the screen
+const char message[] = "PACED TEXT";
+uint8_t typed = 0;
+
+//Counters
+TLBFISLib::transportStats stats;
+
+//Timers
+unsigned long type_timer, report_timer;
+
+void setup() {
+  Serial.begin(115200);
+  
+  //If an error occurs, initialize the screen again.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+      typed = 0;
+    }
+  );
+  
+  //Count the retries, to see the effect of the pacing.
+  FIS.transportStatistics(&stats);
+  
+  //Enable the adaptive pacing.
+  FIS.setAdaptivePacing(true);
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+}
+
+void loop() {
+  //Maintain the connection and send the text when the coalescing window ends.
+  FIS.update();
+  
+  //Type a character every 5ms, starting again on an empty line at the end of the message.
+  if (millis() - type_timer >= 5) {
+    type_timer = millis();
+    
+    if (!message[typed]) {
+      FIS.writeText(0, 8, "          ");
+      typed = 0;
+    }
+    
+    FIS.writeChar(typed * 6, 8, message[typed]);
+    typed++;
+  }
+  
+  //Every second, print the pacing and the number of blocks and retries.
+  if (millis() - report_timer >= 1000) {
+    report_timer = millis();
+    
+    Serial.print(F("Pause: "));
+    Serial.print(FIS.getPacing());
+    Serial.print(F(" us, window: "));
+    Serial.print(FIS.getCoalescingWindow());
+    Serial.print(F(" ms, blocks: "));
+    Serial.print(stats.blocks);
+    Serial.print(F(", repeats: "));
+    Serial.println(stats.repeats);
+    
+    FIS.resetTransportStatistics();
+  }
+}
@@ -0,0 +1,107 @@
+/*
+  Title:
+    26.Streaming_bitmaps.ino
+  
+  Description:
+    Demonstrates how to draw bitmaps which are generated one row at a time, without storing them.
+  
+  Notes:
+    *drawBitmapStream() asks a function for every row, right when it's needed; the function could just as well read the rows from an SD card,
+    decompress them or receive them over a serial link.
+    *Rows can be packed (8 pixels per byte, like for drawBitmap()), or in grayscale (one byte per pixel), in which case the library dithers them.
+    *Here, a wave is generated as packed rows on the upper half of the screen, and a shaded ball as grayscale rows on the lower half.
+    *The functions can't draw anything themselves, since they are called while the library is building a block.
+*/
+
+//Include the FIS library.
+#include <TLBFISLib.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//Phase of the wave, advanced every frame
+uint8_t phase = 0;
+
+//Provide a row of the wave (64x24 pixels), as packed pixels.
+bool waveRow(uint8_t row, uint8_t* data, uint8_t length)
+{
+  for (uint8_t x = 0; x < length * 8; x++) {
+    //Light the pixels between the middle of the area and the wave.
+    int8_t wave = 11 * sin((x + phase) * 0.2);
+    int8_t Y = 11 - row;
+    if ((wave >= 0 && Y >= 0 && Y <= wave) || (wave < 0 && Y < 0 && Y >= wave)) {
+      data[x / 8] |= 0x80 >> (x % 8);
+    }
+  }
+  return true;
+}
+
+//Provide a row of the ball (64x24 pixels), as grayscale pixels.
+bool ballRow(uint8_t row, uint8_t* data, uint8_t length)
+{
+  for (uint8_t x = 0; x < length; x++) {
+    //Brightest at the top-left of the ball, fading towards its edge.
+    int16_t dx = x - 32, dy = row - 12;
+    int16_t distance = sqrt(dx * dx + dy * dy);
+    if (distance > 11) {
+      data[x] = 0;
+      continue;
+    }
+    int16_t light = sqrt((dx + 4) * (dx + 4) + (dy + 4) * (dy + 4));
+    data[x] = (light < 16) ? 255 - light * 15 : 30;
+  }
+  return true;
+}
+
+void setup() {
+  //If an error occurs, initialize the screen again.
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      
+      FIS.initScreen();
+    }
+  );
+  
+  //Start the library and initialize the screen.
+  FIS.begin();
+  FIS.initScreen();
+  
+  //Draw the ball once.
+  FIS.drawBitmapStream(0, 24, 64, 24, ballRow, true);
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Move the wave, drawing it again every 100ms.
+  static unsigned long wave_timer;
+  if (millis() - wave_timer >= 100) {
+    wave_timer = millis();
+    
+    phase++;
+    FIS.drawBitmapStream(0, 0, 64, 24, waveRow);
+  }
+}
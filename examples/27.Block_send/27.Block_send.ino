@@ -0,0 +1,122 @@
+/*
+  Title:
+    27.Block_send.ino
+  
+  Description:
+    Demonstrates how to transmit entire blocks with a function of the sketch, completed by another FreeRTOS task (ESP32).
+  
+  Notes:
+    *blockSendFunction() replaces TLBLib::send() for the blocks of the drawing functions: the function must take the bus (ENA handshake), transmit the
+    block, read the cluster's answer and report it with blockSendComplete(), exactly like TLBLib::send() would return it (SUCCESS, REPEAT or FAIL).
+    *The function must not retry by itself; after REPEAT or FAIL, the library gives it the same block again, according to setRetryPolicy().
+    *Here, the function only hands the block to a transfer task and returns; the transfer task performs the handshake with its own TLBLib object,
+    then calls blockSendComplete(). With a DMA-capable peripheral, this is where the transfer would be started, and blockSendComplete() would be
+    called by the completion interrupt, once the answer was read.
+    *The drawing function returns as soon as its block is handed over, so the next block is encoded during the transfer; the answer is waited for
+    (calling yield() meanwhile) by the next call which uses the bus, which also reports a block the cluster didn't accept. flush() waits for the
+    answer to the last block.
+    *update() still maintains the connection with the library's own TLB object, after the last transfer has ended.
+*/
+
+#ifndef ARDUINO_ARCH_ESP32
+#error This example requires an ESP32.
+#endif
+
+//Include the FIS library.
+#include <TLBFISLib.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+//TLB object used by the transfer task for the handshake (on the same pins)
+TLBLib TLB(ENA_PIN, sendFunction);
+
+//Buffer holding the block until the cluster answers (DMA-capable memory on the ESP32)
+DMA_ATTR uint8_t block_buffer[TLB_MAX_BYTES_PER_BLOCK];
+
+//Handle of the transfer task, which is notified for every block
+TaskHandle_t transfer_task;
+
+//Define the function to be called when the library needs to transmit a block.
+void blockSendFunction(const uint8_t* data, uint8_t length)
+{
+  (void) data;
+  (void) length;
+  
+  //The block stays in block_buffer until blockSendComplete() is called, so the transfer task can read it from there.
+  xTaskNotifyGive(transfer_task);
+}
+
+//The transfer task transmits the blocks and reports the cluster's answers.
+void transferTask(void* parameter)
+{
+  (void) parameter;
+  
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    
+    //Take the bus, transmit the block and read the answer.
+    TLBLib::sendStatus answer = TLB.send(block_buffer);
+    
+    //Report the answer; after REPEAT or FAIL, the library calls blockSendFunction() again with the same block.
+    FIS.blockSendComplete(answer);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  
+  //Start the transfer task on the other core.
+  xTaskCreatePinnedToCore(transferTask, "transferTask", 4096, nullptr, 2, &transfer_task, 0);
+  
+  //Give up on a block after 3 errors, and on a call after 100ms.
+  FIS.setRetryPolicy(3, 100);
+  
+  //Start the library, and let it transmit the blocks with the function.
+  FIS.begin();
+  TLB.begin();
+  FIS.blockSendFunction(blockSendFunction, block_buffer);
+  
+  //Initialize the screen.
+  if (FIS.initScreen() != TLBFISLib::SENT) {
+    Serial.println(F("The cluster did not accept the initialization."));
+  }
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+  
+  //Draw, then wait for the cluster's answer to the last block.
+  TLBFISLib::status result = FIS.printAt(0, 8, "%8lu", millis());
+  if (result == TLBFISLib::SENT) {
+    result = FIS.flush();
+  }
+  if (result != TLBFISLib::SENT) {
+    Serial.print(F("The cluster did not accept the text: "));
+    Serial.println(result == TLBFISLib::FAILED ? F("FAILED") : F("TIMED_OUT"));
+  }
+  
+  delay(20);
+}
@@ -0,0 +1,62 @@
+/*
+  Title:
+    Arduino.h
+
+  Description:
+    The parts of the Arduino core used by the library, for building it on a computer together with the mock TLB library.
+
+  Notes:
+    *The clock is virtual: it only advances when something spends time (a delay, or the mock cluster accepting or answering a block), so a test
+    runs the same every time and hours of traffic take seconds.
+    *The clock can be read and advanced from several threads.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <atomic>
+#include <thread>
+
+//Program memory is ordinary memory on the host.
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_byte_near(address) (*(const uint8_t*)(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+//Virtual clock (in microseconds)
+extern std::atomic<unsigned long> host_clock_us;
+
+inline unsigned long micros() { return host_clock_us.load(); }
+inline unsigned long millis() { return host_clock_us.load() / 1000; }
+inline void delayMicroseconds(unsigned int us) { host_clock_us += us; }
+inline void delay(unsigned long ms) { host_clock_us += ms * 1000; }
+inline void yield() { std::this_thread::yield(); }
+
+//Base class of the library's text widgets
+class Print
+{
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t data) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+      size_t written = 0;
+      while (size--) {
+        written += write(*buffer++);
+      }
+      return written;
+    }
+    virtual void flush() {}
+
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t println(const char* text) { return print(text) + write('\n'); }
+};
+
+#endif
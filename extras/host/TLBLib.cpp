@@ -0,0 +1,170 @@
+#include "TLBLib.h"
+#include <stdlib.h> //abort()
+
+//The virtual clock starts at 1 second, so that times measured from 0 are never mistaken for "not started".
+std::atomic<unsigned long> host_clock_us(1000000);
+
+//Every simulated cluster, so that tests can find them by their ENA pin (created on first use, since clusters may be global objects).
+static std::vector<TLBLib*>& clusters()
+{
+  static std::vector<TLBLib*> list;
+  return list;
+}
+
+TLBLib::TLBLib(uint8_t ENA_pin, sendFunction_type sendFunction, beginFunction_type beginFunction, endFunction_type endFunction) :
+  _ENA_pin(ENA_pin)
+{
+  (void)sendFunction;
+  (void)beginFunction;
+  (void)endFunction;
+  clusters().push_back(this);
+}
+
+TLBLib::~TLBLib()
+{
+  std::vector<TLBLib*> &list = clusters();
+  for (size_t i = 0; i < list.size(); i++) {
+    if (list[i] == this) {
+      list.erase(list.begin() + i);
+      break;
+    }
+  }
+}
+
+TLBLib& TLBLib::cluster(uint8_t ENA_pin)
+{
+  for (TLBLib* tlb : clusters()) {
+    if (tlb->_ENA_pin == ENA_pin) {
+      return *tlb;
+    }
+  }
+  fprintf(stderr, "No cluster on ENA pin %u\n", ENA_pin);
+  abort();
+}
+
+void TLBLib::errorFunction(errorFunction_type function)
+{
+  _error_function = function;
+}
+
+void TLBLib::begin()
+{
+}
+
+void TLBLib::end()
+{
+}
+
+void TLBLib::update()
+{
+  //The error function is executed without holding the lock, since it usually draws again.
+  unsigned long duration;
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!_fault_error) {
+      return;
+    }
+    _fault_error = false;
+    _errors++;
+    duration = _faults ? _faults->error_duration_ms : 0;
+  }
+
+  if (_error_function) {
+    _error_function(duration);
+  }
+}
+
+void TLBLib::turnOff()
+{
+}
+
+TLBLib::sendStatus TLBLib::send(uint8_t* data)
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  _attempts++;
+
+  if (_faults) {
+    //Start new faults, with the chances given by the profile.
+    if (!_fault_repeats && !_fault_failures) {
+      if (fault_random() < _faults->repeat_chance) {
+        _fault_repeats = 1 + fault_random() % (_faults->repeat_storm ? _faults->repeat_storm : 1);
+      }
+      else if (fault_random() < _faults->fail_chance) {
+        _fault_failures = 1 + fault_random() % (_faults->fail_burst ? _faults->fail_burst : 1);
+      }
+      if (fault_random() < _faults->error_chance) {
+        _fault_error = true;
+      }
+    }
+
+    //While a fault lasts, the block is answered without being accepted.
+    if (_fault_repeats || _fault_failures) {
+      delayMicroseconds(_faults->latency_us);
+
+      if (_fault_repeats) {
+        _fault_repeats--;
+        return REPEAT;
+      }
+
+      _fault_failures--;
+      return FAIL;
+    }
+  }
+
+  //The length byte doesn't count the command and length bytes.
+  uint8_t length = data[1] + 2;
+
+  //A block longer than the cluster's buffer is rejected after it was transmitted.
+  delayMicroseconds(length * byteTime);
+  if (maxBlockSize && length > maxBlockSize) {
+    return FAIL;
+  }
+
+  _blocks.push_back(std::vector<uint8_t>(data, data + length));
+  return SUCCESS;
+}
+
+std::vector<std::vector<uint8_t>> TLBLib::blocks()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _blocks;
+}
+
+void TLBLib::clearBlocks()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  _blocks.clear();
+}
+
+unsigned long TLBLib::attempts()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _attempts;
+}
+
+void TLBLib::faultInjection(const faultProfile* profile)
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  _faults = profile;
+  _fault_repeats = 0;
+  _fault_failures = 0;
+  _fault_error = false;
+
+  //The generator must not start from 0, or it would stay there.
+  _fault_state = (profile && profile->seed) ? profile->seed : 0x2545F491;
+}
+
+unsigned long TLBLib::errors()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _errors;
+}
+
+//Advance the generator (xorshift32), so the same seed always gives the same faults.
+uint16_t TLBLib::fault_random()
+{
+  _fault_state ^= _fault_state << 13;
+  _fault_state ^= _fault_state >> 17;
+  _fault_state ^= _fault_state << 5;
+  return _fault_state >> 16;
+}
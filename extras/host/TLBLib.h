@@ -0,0 +1,108 @@
+/*
+  Title:
+    TLBLib.h
+
+  Description:
+    Mock of the TLB library, for running TLBFISLib on a computer: instead of driving the bus, send() is answered by a simulated cluster, which
+    records the blocks it accepts.
+
+  Notes:
+    *Every accepted block advances the virtual clock (see Arduino.h) by the time it would take on the wire.
+    *Blocks longer than maxBlockSize are answered with FAIL, like a cluster with a smaller buffer.
+    *faultInjection() makes the cluster misbehave: before every attempt, a REPEAT storm or a FAIL burst may start, and update() may execute the
+    error function, like when the screen is taken over; the faults only depend on the seed and on the number of attempts, so a run can be repeated
+    exactly.
+    *Tests reach the cluster behind a TLBFISLib object with TLBLib::cluster(), by the ENA pin given to the FIS library.
+*/
+
+#ifndef TLBLib_h
+#define TLBLib_h
+
+#include <Arduino.h> //virtual clock
+#include <vector> //recorded blocks
+#include <mutex> //access to the recorded blocks from several threads
+
+class TLBLib
+{
+  public:
+    //Function types, as in the TLB library
+    typedef void (*sendFunction_type)(uint8_t data);
+    typedef void (*beginFunction_type)();
+    typedef void (*endFunction_type)();
+    typedef void (*errorFunction_type)(unsigned long duration);
+
+    //Simulated faults for the faultInjection() function (chances are out of 65536 attempts)
+    struct faultProfile {
+      uint16_t repeat_chance; //chance of an attempt starting a REPEAT storm
+      uint8_t repeat_storm; //longest REPEAT storm (in attempts)
+      uint16_t fail_chance; //chance of an attempt starting a FAIL burst
+      uint8_t fail_burst; //longest FAIL burst (in attempts)
+      uint16_t error_chance; //chance of an attempt making update() execute the error function
+      uint16_t error_duration_ms; //duration given to the error function
+      uint16_t latency_us; //how long every simulated answer takes
+      uint32_t seed; //start of the pseudo-random sequence (the same seed gives the same faults)
+    };
+
+    //Answers to send()
+    enum sendStatus {
+      FAIL,
+      SUCCESS,
+      REPEAT
+    };
+
+    //Constructor (the functions are never called, since there is no bus)
+    TLBLib(uint8_t ENA_pin, sendFunction_type sendFunction, beginFunction_type beginFunction = nullptr, endFunction_type endFunction = nullptr);
+    //Destructor
+    ~TLBLib();
+
+    //Get the simulated cluster connected to an ENA pin (the FIS library's TLB object is private)
+    static TLBLib& cluster(uint8_t ENA_pin);
+
+    //Same interface as the TLB library
+    void errorFunction(errorFunction_type function);
+    void begin();
+    void end();
+    void update();
+    void turnOff();
+    sendStatus send(uint8_t* data);
+
+    ///SIMULATED CLUSTER
+
+    //Longest block accepted, including the command and length bytes (0 = any)
+    uint8_t maxBlockSize = 0;
+    //How long a byte takes on the wire (in microseconds)
+    unsigned long byteTime = 200;
+
+    //Get a copy of the blocks accepted so far
+    std::vector<std::vector<uint8_t>> blocks();
+    //Forget the blocks accepted so far
+    void clearBlocks();
+    //Get how many times send() was called
+    unsigned long attempts();
+
+    //Simulate a misbehaving cluster, according to the given profile (nullptr = stop simulating)
+    void faultInjection(const faultProfile* profile);
+    //Get how many times the error function was executed
+    unsigned long errors();
+
+  private:
+    uint8_t _ENA_pin;
+    errorFunction_type _error_function = nullptr;
+
+    std::mutex _lock;
+    std::vector<std::vector<uint8_t>> _blocks;
+    unsigned long _attempts = 0;
+
+    //Fault injection
+    const faultProfile* _faults = nullptr; //provided by the test
+    uint32_t _fault_state = 0; //state of the pseudo-random generator
+    uint8_t _fault_repeats = 0; //REPEAT answers left in the current storm
+    uint8_t _fault_failures = 0; //FAIL answers left in the current burst
+    bool _fault_error = false; //set when update() must execute the error function
+    unsigned long _errors = 0;
+
+    //Get the next pseudo-random number for the fault injection
+    uint16_t fault_random();
+};
+
+#endif
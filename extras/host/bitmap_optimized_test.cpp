@@ -0,0 +1,115 @@
+/*
+  Title:
+    bitmap_optimized_test.cpp
+
+  Description:
+    Checks that drawBitmapOptimized() leaves the same pixels on the screen as drawBitmap(), for random bitmaps, positions, workspaces and modes.
+
+  Notes:
+    *The bitmaps mix random rows, rows which are entirely off or on, and rows which alternate between both, so that every kind of command the
+    encoder can choose (bitmap blocks, fills, merged rows, narrowed workspaces) is used.
+    *Both functions start from the same random screen; the bytes sent by each are added up, so the result also shows how much the encoder saves.
+*/
+
+#include <TLBFISLib.h>
+#include "screen.h"
+#include "check.h"
+
+//ENA pin of the simulated cluster
+#define ENA_PIN 9
+
+//How many random cases to check
+#define CASES 4000
+
+TLBFISLib FIS(ENA_PIN, [](uint8_t) {});
+
+//Workspace of the cluster, following every block it accepted
+simulatedScreen state;
+
+//Send the blocks accepted by the cluster to the screen and to the workspace tracker, and count their bytes.
+unsigned long apply(simulatedScreen &screen)
+{
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+  unsigned long bytes = 0;
+  for (const std::vector<uint8_t> &block : cluster.blocks()) {
+    state.apply(block);
+    screen.apply(block);
+    bytes += block.size();
+  }
+  cluster.clearBlocks();
+  return bytes;
+}
+
+int main()
+{
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+  unsigned long plain_bytes = 0, optimized_bytes = 0, mismatches = 0;
+
+  FIS.begin();
+  CHECK(FIS.initScreen() == TLBFISLib::SENT);
+  state.apply(cluster);
+  cluster.clearBlocks();
+
+  srand(26);
+  static uint8_t bitmap[8 * 48];
+  for (int i = 0; i < CASES; i++) {
+    //Random workspace (the entire HALFSCREEN area a third of the time)
+    bool full = !(rand() % 3);
+    uint8_t wsX = full ? 0 : rand() % 20, wsY = full ? 0 : rand() % 10;
+    uint8_t wsW = full ? 64 : 8 + rand() % (64 - wsX - 8 + 1), wsH = full ? 48 : 4 + rand() % (48 - wsY - 4 + 1);
+
+    //Random bitmap and position (which may also be partly outside the workspace)
+    uint8_t W = 1 + rand() % 64, H = 1 + rand() % 48, X = rand() % 64, Y = rand() % wsH;
+    uint8_t width_in_bytes = (W + 7) / 8;
+    int kind = rand() % 4;
+    for (int row = 0; row < H; row++) {
+      int row_kind = kind ? kind : rand() % 4;
+      for (int i = 0; i < width_in_bytes; i++) {
+        bitmap[row * width_in_bytes + i] = (row_kind == 1) ? 0x00 : (row_kind == 2) ? 0xFF : (row_kind == 3) ? ((rand() % 2) ? 0x00 : 0xFF) : rand();
+      }
+    }
+    bool transparent = rand() % 2, inverted = rand() % 2;
+
+    //Same random screen for both functions
+    uint8_t pixels[88][64];
+    for (int y = 0; y < 88; y++) {
+      for (int x = 0; x < 64; x++) {
+        pixels[y][x] = rand() % 2;
+      }
+    }
+
+    simulatedScreen plain, optimized;
+    for (int pass = 0; pass < 2; pass++) {
+      simulatedScreen &screen = pass ? optimized : plain;
+      screen = state;
+      memcpy(screen.pixels, pixels, sizeof(pixels));
+
+      FIS.setWorkspace(wsX, wsY, wsW, wsH);
+      FIS.setBitmapTransparency(transparent ? TLBFISLib::TRANSPARENT : TLBFISLib::OPAQUE);
+      FIS.setDrawColor(inverted ? TLBFISLib::INVERTED : TLBFISLib::NORMAL);
+      if (pass) {
+        CHECK(FIS.drawBitmapOptimized(X, Y, W, H, bitmap, false) == TLBFISLib::SENT);
+      }
+      else {
+        CHECK(FIS.drawBitmap(X, Y, W, H, bitmap, false) == TLBFISLib::SENT);
+      }
+      FIS.resetWorkspace();
+      FIS.flush();
+      (pass ? optimized_bytes : plain_bytes) += apply(screen);
+    }
+
+    if (memcmp(plain.pixels, optimized.pixels, sizeof(plain.pixels))) {
+      if (!mismatches) {
+        printf("case %d: workspace %u,%u %ux%u, bitmap at %u,%u %ux%u, transparent %d, inverted %d, kind %d\n", i, wsX, wsY, wsW, wsH, X, Y, W, H,
+               transparent, inverted, kind);
+      }
+      mismatches++;
+    }
+  }
+
+  printf("%lu/%d cases differ; drawBitmap() sent %lu bytes, drawBitmapOptimized() %lu bytes\n", mismatches, CASES, plain_bytes, optimized_bytes);
+  CHECK(mismatches == 0);
+  CHECK(optimized_bytes < plain_bytes);
+
+  return check_result("bitmap_optimized_test");
+}
@@ -0,0 +1,143 @@
+/*
+  Title:
+    block_send_test.cpp
+
+  Description:
+    Checks blockSendFunction() with functions which hand the blocks to a simulated cluster, right away or from another thread.
+
+  Notes:
+    *The blocks must reach the cluster exactly as with the TLB library, and REPEAT and FAIL answers must make the library send the block again.
+    *A drawing function must return as soon as its block is handed over; the answer must be waited for, and a block given up on reported, by the
+    next call which uses the bus.
+*/
+
+#include <TLBFISLib.h>
+#include <thread>
+#include "check.h"
+
+//ENA pins of the simulated clusters
+#define DIRECT_PIN 9
+#define BLOCK_PIN  10
+
+TLBFISLib direct(DIRECT_PIN, [](uint8_t) {});
+TLBFISLib fis(BLOCK_PIN, [](uint8_t) {});
+
+//Buffer holding the block while it's transmitted
+uint8_t block_buffer[TLB_MAX_BYTES_PER_BLOCK];
+
+//Transmit the block right away, and report the cluster's answer.
+void sendNow(const uint8_t* data, uint8_t length)
+{
+  uint8_t block[TLB_MAX_BYTES_PER_BLOCK];
+  memcpy(block, data, length);
+  fis.blockSendComplete(TLBLib::cluster(BLOCK_PIN).send(block));
+}
+
+//Transmit the block from another thread, like a DMA transfer completed by an interrupt.
+std::thread transfer;
+void sendLater(const uint8_t* data, uint8_t length)
+{
+  if (transfer.joinable()) {
+    transfer.join();
+  }
+  transfer = std::thread(
+    [data, length]() {
+      uint8_t block[TLB_MAX_BYTES_PER_BLOCK];
+      memcpy(block, data, length);
+      fis.blockSendComplete(TLBLib::cluster(BLOCK_PIN).send(block));
+    }
+  );
+}
+
+//Leave the transfer running until the test completes it.
+unsigned long started = 0;
+void sendNever(const uint8_t*, uint8_t)
+{
+  started++;
+}
+
+//Draw a few frames of everything, the same way on both clusters.
+uint8_t bitmap[8 * 20];
+void draw(TLBFISLib &target)
+{
+  for (uint8_t frame = 0; frame < 20; frame++) {
+    target.printAt(0, frame % 40, "Frame %u", frame);
+    target.drawLine(0, 45, frame * 3);
+    for (uint8_t i = 0; i < sizeof(bitmap); i++) {
+      bitmap[i] = frame * 13 + i;
+    }
+    target.drawBitmap(0, 20, 64, 20, bitmap, false);
+    target.flush();
+  }
+}
+
+int main()
+{
+  TLBLib &direct_cluster = TLBLib::cluster(DIRECT_PIN);
+  TLBLib &cluster = TLBLib::cluster(BLOCK_PIN);
+
+  direct.begin();
+  direct.initScreen();
+  draw(direct);
+  std::vector<std::vector<uint8_t>> expected = direct_cluster.blocks();
+
+  //Blocks sent right away reach the cluster like with the TLB library.
+  fis.begin();
+  fis.blockSendFunction(sendNow, block_buffer);
+  CHECK(fis.initScreen() == TLBFISLib::SENT);
+  draw(fis);
+  CHECK(cluster.blocks() == expected);
+
+  //Blocks completed by another thread, while the cluster gives REPEAT and FAIL answers, are sent again until they are accepted.
+  TLBLib::faultProfile faults = {
+    6000, //REPEAT storm chance (~9%)
+    10,   //longest REPEAT storm
+    3000, //FAIL burst chance (~5%)
+    2,    //longest FAIL burst
+    0,    //error function chance
+    0,    //duration given to the error function (ms)
+    300,  //latency of every simulated answer (us)
+    99    //seed
+  };
+  cluster.clearBlocks();
+  cluster.faultInjection(&faults);
+  fis.blockSendFunction(sendLater, block_buffer);
+  unsigned long attempts = cluster.attempts();
+  CHECK(fis.initScreen() == TLBFISLib::SENT);
+  draw(fis);
+  printf("threaded: %zu blocks in %lu attempts\n", cluster.blocks().size(), cluster.attempts() - attempts);
+  CHECK(cluster.blocks() == expected);
+  CHECK(cluster.attempts() - attempts > expected.size());
+  cluster.faultInjection(nullptr);
+
+  //A block the cluster rejects is reported by the next call which uses the bus, and then forgotten.
+  fis.blockSendFunction(sendNow, block_buffer);
+  fis.setRetryPolicy(3);
+  cluster.maxBlockSize = 30;
+  TLBFISLib::status drawn = fis.drawBitmap(0, 0, 64, 20, bitmap, false);
+  TLBFISLib::status flushed = fis.flush();
+  CHECK(drawn == TLBFISLib::FAILED || flushed == TLBFISLib::FAILED);
+  cluster.maxBlockSize = 0;
+  CHECK(fis.drawLine(0, 0, 10) == TLBFISLib::SENT);
+  CHECK(fis.flush() == TLBFISLib::SENT);
+
+  //The drawing function returns while its block is still being transmitted.
+  fis.blockSendFunction(sendNever, block_buffer);
+  fis.setRetryPolicy(3, 5, 100);
+  CHECK(fis.drawLine(0, 0, 10) == TLBFISLib::SENT);
+  CHECK(started == 1);
+  fis.blockSendComplete(TLBLib::SUCCESS);
+  CHECK(fis.flush() == TLBFISLib::SENT);
+
+  //A transfer which never completes times out in the call which waits for it.
+  CHECK(fis.drawLine(0, 0, 10) == TLBFISLib::SENT);
+  unsigned long start = millis();
+  CHECK(fis.flush() == TLBFISLib::TIMED_OUT);
+  CHECK(millis() - start <= 6);
+  fis.blockSendComplete(TLBLib::SUCCESS);
+
+  if (transfer.joinable()) {
+    transfer.join();
+  }
+  return check_result("block_send_test");
+}
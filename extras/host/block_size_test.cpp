@@ -0,0 +1,98 @@
+/*
+  Title:
+    block_size_test.cpp
+
+  Description:
+    Checks calibrateBlockSize() against simulated clusters which only accept blocks up to a given size.
+
+  Notes:
+    *Every cluster is probed directly; the bitmap drawn afterwards must then be split into blocks the cluster accepts.
+    *While a submission queue is attached, blocks are reported as sent before the cluster answers, so the calibration must refuse to run instead
+    of settling on the largest size; a block send function reports the answers, so the calibration works through it.
+*/
+
+#include <TLBFISLib.h>
+#include <TLBFISQueue.h>
+#include "check.h"
+
+//ENA pin of the simulated cluster
+#define ENA_PIN 9
+
+TLBFISLib FIS(ENA_PIN, [](uint8_t) {});
+
+//Random bitmap covering the whole HALFSCREEN area
+uint8_t bitmap[64 * 48 / 8];
+
+//Block send function which gives the blocks to the simulated cluster and reports its answers
+uint8_t block_buffer[TLB_MAX_BYTES_PER_BLOCK];
+void blockSendFunction(const uint8_t* data, uint8_t length)
+{
+  uint8_t block[TLB_MAX_BYTES_PER_BLOCK];
+  memcpy(block, data, length);
+  FIS.blockSendComplete(TLBLib::cluster(ENA_PIN).send(block));
+}
+
+//Calibrate against a cluster limited to the given size, and check that a bitmap is then sent without errors.
+void calibrate(uint8_t limit, uint8_t expected)
+{
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+  cluster.maxBlockSize = limit;
+  FIS.setBlockSize(TLB_DEFAULT_BYTES_PER_BLOCK);
+
+  uint8_t size = FIS.calibrateBlockSize();
+  printf("limit %2u: calibrated %2u, block size %2u\n", limit, size, FIS.getBlockSize());
+  CHECK(size == expected);
+  CHECK(FIS.getBlockSize() == (expected ? expected : TLB_DEFAULT_BYTES_PER_BLOCK));
+
+  //A failed calibration keeps a size the cluster rejects, so the bitmap is only checked after a successful one.
+  if (!expected) {
+    return;
+  }
+
+  cluster.clearBlocks();
+  unsigned long attempts = cluster.attempts();
+  CHECK(FIS.drawBitmap(0, 0, 64, 48, bitmap, false) == TLBFISLib::SENT);
+
+  std::vector<std::vector<uint8_t>> blocks = cluster.blocks();
+  CHECK(cluster.attempts() - attempts == blocks.size());
+  for (const std::vector<uint8_t> &block : blocks) {
+    CHECK(!limit || block.size() <= limit);
+  }
+}
+
+int main()
+{
+  for (uint8_t &data : bitmap) {
+    data = rand();
+  }
+
+  FIS.begin();
+  FIS.setRetryPolicy(3);
+  CHECK(FIS.initScreen() == TLBFISLib::SENT);
+
+  //Clusters which accept every size down to the smallest one
+  calibrate(0, TLB_MAX_BYTES_PER_BLOCK);
+  calibrate(TLB_MAX_BYTES_PER_BLOCK, TLB_MAX_BYTES_PER_BLOCK);
+  calibrate(30, 30);
+  calibrate(20, 20);
+  calibrate(TLB_MIN_BYTES_PER_BLOCK, TLB_MIN_BYTES_PER_BLOCK);
+
+  //A cluster which doesn't even accept the smallest size
+  calibrate(TLB_MIN_BYTES_PER_BLOCK - 1, 0);
+
+  //Queued blocks are only transmitted by update(), so the answers can't be known.
+  TLBFISQueue queue;
+  FIS.submissionQueue(&queue);
+  calibrate(30, 0);
+  FIS.submissionQueue(nullptr);
+
+  //The block send function reports the cluster's answers.
+  FIS.blockSendFunction(blockSendFunction, block_buffer);
+  calibrate(20, 20);
+  FIS.blockSendFunction(nullptr, nullptr);
+
+  //Once detached, the same cluster is calibrated correctly.
+  calibrate(30, 30);
+
+  return check_result("block_size_test");
+}
@@ -0,0 +1,111 @@
+/*
+  Title:
+    bus_yield_test.cpp
+
+  Description:
+    Checks that a cluster which gives up its turns on a shared bus keeps its widgets as they are, instead of drawing them again from scratch.
+
+  Notes:
+    *While the slow cluster answers every attempt with REPEAT, each of its turns ends after the slice, and the other cluster keeps being served.
+    *Once the slow cluster is ready again, its widgets must be updated with the same blocks as when nothing was given up.
+*/
+
+#include <TLBFISLib.h>
+#include <TLBFISBus.h>
+#include <TLBFISSegments.h>
+#include <TLBFISBar.h>
+#include "check.h"
+
+//ENA pins of the simulated clusters
+#define SLOW_PIN 9
+#define FAST_PIN 10
+
+//How long a cluster may keep the bus waiting (in milliseconds)
+#define SLICE_MS 10
+
+TLBFISLib slow(SLOW_PIN, [](uint8_t) {});
+TLBFISLib fast(FAST_PIN, [](uint8_t) {});
+TLBFISBus bus;
+
+TLBFISSegments slow_digits(slow, 4, 2, 3);
+TLBFISBar slow_bar(slow, 4, 24, 56, 8);
+TLBFISBar fast_bar(fast, 4, 24, 56, 8);
+
+//A cluster which is never ready (chances out of 65536 attempts)
+TLBLib::faultProfile busy = {
+  65535, //REPEAT storm chance
+  255,   //longest REPEAT storm
+  0,     //FAIL burst chance
+  0,     //longest FAIL burst
+  0,     //error function chance
+  0,     //duration given to the error function (ms)
+  1000,  //latency of every simulated answer (us)
+  44     //seed
+};
+
+//Give every cluster a few turns.
+void run_turns(uint8_t turns)
+{
+  for (uint8_t i = 0; i < turns; i++) {
+    bus.update();
+    delay(20);
+  }
+}
+
+//Change the values of the slow cluster's widgets.
+void change_values(int16_t value)
+{
+  slow_digits.setValue(value);
+  slow_bar.setValue(value);
+}
+
+int main()
+{
+  TLBLib &slow_cluster = TLBLib::cluster(SLOW_PIN);
+  TLBLib &fast_cluster = TLBLib::cluster(FAST_PIN);
+
+  slow.begin();
+  fast.begin();
+  CHECK(slow.initScreen() == TLBFISLib::SENT);
+  CHECK(fast.initScreen() == TLBFISLib::SENT);
+  slow.addWidget(slow_digits);
+  slow.addWidget(slow_bar);
+  fast.addWidget(fast_bar);
+  bus.addCluster(slow);
+  bus.addCluster(fast);
+  bus.setSlice(SLICE_MS);
+
+  //Draw every widget, then measure how many blocks a change of the values takes.
+  change_values(10);
+  fast_bar.setValue(10);
+  run_turns(3);
+  slow_cluster.clearBlocks();
+  change_values(20);
+  run_turns(3);
+  size_t change_blocks = slow_cluster.blocks().size();
+  CHECK(change_blocks && !slow_digits.isDirty() && !slow_bar.isDirty());
+  change_values(10);
+  run_turns(3);
+
+  //While the slow cluster isn't ready, its widgets stay dirty and the other cluster is still served.
+  slow_cluster.faultInjection(&busy);
+  change_values(20);
+  slow_cluster.clearBlocks();
+  fast_cluster.clearBlocks();
+  for (int16_t value = 30; value < 100; value += 10) {
+    fast_bar.setValue(value);
+    run_turns(1);
+  }
+  CHECK(slow_cluster.blocks().empty());
+  CHECK(slow_digits.isDirty() && slow_bar.isDirty());
+  CHECK(fast_cluster.blocks().size() >= 7 && !fast_bar.isDirty());
+
+  //Once it's ready again, the change takes as many blocks as before: nothing is drawn again from scratch.
+  slow_cluster.faultInjection(nullptr);
+  run_turns(3);
+  printf("change: %zu blocks, after the given up turns: %zu blocks\n", change_blocks, slow_cluster.blocks().size());
+  CHECK(slow_cluster.blocks().size() == change_blocks);
+  CHECK(!slow_digits.isDirty() && !slow_bar.isDirty());
+
+  return check_result("bus_yield_test");
+}
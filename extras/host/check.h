@@ -0,0 +1,32 @@
+/*
+  Title:
+    check.h
+
+  Description:
+    Minimal assertions for the host tests: a failed check is printed with its line, and the test keeps running so that every failure is listed.
+*/
+
+#ifndef check_h
+#define check_h
+
+#include <stdio.h>
+
+//Number of failed checks
+static unsigned long check_failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      check_failures++; \
+    } \
+  } while (0)
+
+//Print the result of a test and get its exit code.
+static inline int check_result(const char* test)
+{
+  printf("%s: %s\n", test, check_failures ? "FAILED" : "passed");
+  return check_failures ? 1 : 0;
+}
+
+#endif
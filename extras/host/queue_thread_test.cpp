@@ -0,0 +1,158 @@
+/*
+  Title:
+    queue_thread_test.cpp
+
+  Description:
+    Checks the submission queue with a real drawing thread and a real transmitting thread, like the 23.RTOS_tasks example.
+
+  Notes:
+    *The same frames are drawn on two simulated clusters, one directly and one through a small queue emptied by another thread; both clusters must
+    receive exactly the same blocks, in the same order.
+    *The queued cluster is then made to misbehave (REPEAT storms, FAIL bursts and calls of the error function) with adaptive pacing enabled; the error
+    function only signals the drawing thread, which initializes the screen again, and no block may be lost.
+    *Building with "make CXXFLAGS='-std=gnu++11 -g -fsanitize=thread'" also checks that the two threads never access the same data unsafely.
+*/
+
+#include <TLBFISLib.h>
+#include <TLBFISQueue.h>
+#include <thread>
+#include "check.h"
+
+//ENA pins of the simulated clusters
+#define DIRECT_PIN 9
+#define QUEUED_PIN 10
+
+//How many frames each run draws
+#define FRAMES 500
+
+TLBFISLib direct(DIRECT_PIN, [](uint8_t) {});
+TLBFISLib queued(QUEUED_PIN, [](uint8_t) {});
+TLBFISQueue queue;
+
+//Set by the drawing thread when it's done, so the transmitting thread can stop once the queue is empty
+std::atomic<bool> drawing_done(false);
+
+//Set by the error function (in the transmitting thread), cleared by the drawing thread
+std::atomic<bool> reinit_requested(false);
+
+//Bitmap drawn in every frame (changes with the frame number)
+uint8_t bitmap[4 * 12];
+
+//Draw a frame which uses most kinds of commands, depending only on the frame number.
+void draw_frame(TLBFISLib &fis, unsigned long frame)
+{
+  fis.printAt(0, 0, "F%5lu", frame);
+  fis.writeChar(frame % 60, 10, (char)('A' + frame % 26));
+  fis.writeChar(frame % 60 + 6, 10, (char)('a' + frame % 26));
+
+  fis.drawLine(0, 20, 10 + frame % 50);
+  fis.drawLine(frame % 64, 22, 10, TLBFISLib::VERTICAL);
+
+  for (uint8_t i = 0; i < sizeof(bitmap); i++) {
+    bitmap[i] = frame * 31 + i * 7;
+  }
+  fis.drawBitmap(frame % 32, 34, 32, 12, bitmap, false);
+
+  fis.setWorkspace(32, 0, 32, 16);
+  fis.writeText(0, 0, (frame & 1) ? "ODD" : "EVEN");
+  fis.resetWorkspace();
+
+  //Send the text waiting to be merged, like the drawing task of a sketch.
+  fis.updateWidgets();
+}
+
+//Transmitting thread: calls update() until everything was drawn and transmitted.
+void transmit()
+{
+  while (!drawing_done || queue.getCount()) {
+    queued.update();
+    yield();
+  }
+}
+
+int main()
+{
+  TLBLib &direct_cluster = TLBLib::cluster(DIRECT_PIN);
+  TLBLib &queued_cluster = TLBLib::cluster(QUEUED_PIN);
+
+  //Draw the frames directly.
+  direct.begin();
+  direct.initScreen();
+  for (unsigned long frame = 0; frame < FRAMES; frame++) {
+    draw_frame(direct, frame);
+  }
+  direct.flush();
+
+  //Draw the same frames through the queue, while another thread transmits them.
+  queued.begin();
+  queued.submissionQueue(&queue);
+  std::thread bus(transmit);
+  queued.initScreen();
+  for (unsigned long frame = 0; frame < FRAMES; frame++) {
+    draw_frame(queued, frame);
+  }
+  queued.flush();
+  drawing_done = true;
+  bus.join();
+
+  std::vector<std::vector<uint8_t>> expected = direct_cluster.blocks(), received = queued_cluster.blocks();
+  printf("direct: %zu blocks, queued: %zu blocks\n", expected.size(), received.size());
+  CHECK(expected == received);
+
+  //Make the queued cluster misbehave, and keep drawing.
+  TLBLib::faultProfile faults = {
+    2000, //REPEAT storm chance (~3%)
+    20,   //longest REPEAT storm
+    1000, //FAIL burst chance (~1.5%)
+    3,    //longest FAIL burst
+    300,  //error function chance (~0.5%)
+    500,  //duration given to the error function (ms)
+    300,  //latency of every simulated answer (us)
+    4242  //seed
+  };
+  queued_cluster.clearBlocks();
+  queued_cluster.faultInjection(&faults);
+
+  //The error function runs in the transmitting thread, so it only signals the drawing thread.
+  queued.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      reinit_requested = true;
+    }
+  );
+
+  TLBFISLib::transportStats stats = {};
+  queued.transportStatistics(&stats);
+  queued.setAdaptivePacing(true);
+
+  drawing_done = false;
+  bus = std::thread(transmit);
+  unsigned long reinits = 0, max_window = 0;
+  for (unsigned long frame = 0; frame < FRAMES; frame++) {
+    if (reinit_requested.exchange(false)) {
+      reinits++;
+      queued.initScreen();
+    }
+    draw_frame(queued, frame);
+
+    //The coalescing window follows the pause learned by the transmitting thread.
+    if (queued.getCoalescingWindow() > max_window) {
+      max_window = queued.getCoalescingWindow();
+    }
+  }
+  queued.flush();
+  drawing_done = true;
+  bus.join();
+
+  printf("faulty: %lu blocks, %lu repeats, %lu failures, %lu errors, %lu screens initialized again, pause %u us, longest window %lu ms\n",
+         stats.blocks, stats.repeats, stats.failures, queued_cluster.errors(), reinits, queued.getPacing(), max_window);
+
+  //Without a retry policy, every block is eventually accepted.
+  CHECK(stats.given_up == 0);
+  CHECK(stats.blocks == queued_cluster.blocks().size());
+  CHECK(stats.repeats > 0 && stats.failures > 0);
+  CHECK(queued_cluster.errors() > 0 && reinits > 0);
+  CHECK(queue.getCount() == 0);
+
+  return check_result("queue_thread_test");
+}
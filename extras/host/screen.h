@@ -0,0 +1,94 @@
+/*
+  Title:
+    screen.h
+
+  Description:
+    Simulated screen for the host tests: draws the workspace (clear) and bitmap commands accepted by the simulated cluster into a frame buffer, so
+    that tests can compare what different drawing functions leave on the screen.
+
+  Notes:
+    *Only the commands which change pixels through the workspace are simulated (0x53 and 0x55); text and radio commands are ignored.
+    *Bitmap lines are as long as the space between their X coordinate and the right edge of the workspace, rounded up to a whole byte.
+*/
+
+#ifndef screen_h
+#define screen_h
+
+#include <TLBLib.h>
+#include <string.h>
+
+struct simulatedScreen {
+  //Pixels of the entire screen (1 = on)
+  uint8_t pixels[88][64];
+
+  //Current workspace
+  uint8_t X = 0, Y = 0, W = 64, H = 88;
+
+  simulatedScreen()
+  {
+    memset(pixels, 0, sizeof(pixels));
+  }
+
+  //Apply a pixel of a bitmap, according to the command options.
+  void bitmap_pixel(int x, int y, bool on, uint8_t options)
+  {
+    if (x < X || x >= X + W || y < Y || y >= Y + H || x >= 64 || y >= 88) {
+      return;
+    }
+
+    bool transparent = options & 0x01, or_output = options & 0x02;
+    if (transparent) {
+      //Transparent bitmaps only change the pixels which are set: either turn them on, or toggle them.
+      if (on) {
+        pixels[y][x] = or_output ? 1 : !pixels[y][x];
+      }
+    }
+    else {
+      pixels[y][x] = or_output ? on : !on;
+    }
+  }
+
+  //Apply a block accepted by the cluster.
+  void apply(const std::vector<uint8_t> &block)
+  {
+    if (block[0] == 0x53) {
+      uint8_t options = block[2];
+      X = block[3];
+      Y = block[4];
+      W = block[5];
+      H = block[6];
+
+      //Clear (or fill) the new workspace.
+      if (options & 0x02) {
+        for (int y = Y; y < Y + H && y < 88; y++) {
+          for (int x = X; x < X + W && x < 64; x++) {
+            pixels[y][x] = options & 0x01;
+          }
+        }
+      }
+    }
+    else if (block[0] == 0x55) {
+      uint8_t options = block[2], startX = block[3], startY = block[4];
+      int bytes_per_line = (W - startX + 7) / 8;
+      int length = block[1] - 3;
+
+      for (int i = 0; i < length; i++) {
+        int row = i / bytes_per_line, column = (i % bytes_per_line) * 8;
+        for (int bit = 0; bit < 8; bit++) {
+          bitmap_pixel(X + startX + column + bit, Y + startY + row, (block[5 + i] >> (7 - bit)) & 1, options);
+        }
+      }
+    }
+  }
+
+  //Apply every block the cluster accepted, and forget them.
+  void apply(TLBLib &cluster)
+  {
+    for (const std::vector<uint8_t> &block : cluster.blocks()) {
+      apply(block);
+    }
+    cluster.clearBlocks();
+  }
+};
+
+#endif
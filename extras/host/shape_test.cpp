@@ -0,0 +1,170 @@
+/*
+  Title:
+    shape_test.cpp
+
+  Description:
+    Checks the software rasterizer (drawPolygon(), drawCircle(), drawArc()) on a simulated screen.
+
+  Notes:
+    *A shape drawn with the INVERTED draw color on a lit screen must clear exactly the pixels it lights with the NORMAL draw color on a dark
+    screen, including the corners shared by straight edges (sent as fills) and slanted ones (sent as XOR bitmaps).
+    *An arc must contain the pixels of its circle whose angle is between its ends; pixels within half a degree of an end are not checked.
+*/
+
+#include <TLBFISLib.h>
+#include <math.h>
+#include "screen.h"
+#include "check.h"
+
+//ENA pin of the simulated cluster
+#define ENA_PIN 9
+
+TLBFISLib FIS(ENA_PIN, [](uint8_t) {});
+
+//Workspace of the cluster, following every block it accepted
+simulatedScreen state;
+
+//Draw something with both draw colors, and check that the inverted drawing clears exactly what the normal one lights.
+template <typename draw_function> bool check_inverted(draw_function draw)
+{
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+  simulatedScreen normal = state;
+
+  //Normal, on a dark screen
+  memset(normal.pixels, 0, sizeof(normal.pixels));
+  FIS.setDrawColor(TLBFISLib::NORMAL);
+  draw();
+  FIS.flush();
+  for (const std::vector<uint8_t> &block : cluster.blocks()) {
+    state.apply(block);
+    normal.apply(block);
+  }
+  cluster.clearBlocks();
+
+  //Inverted, on a lit screen (which starts from the workspace the previous drawing left)
+  simulatedScreen inverted = state;
+  memset(inverted.pixels, 1, sizeof(inverted.pixels));
+  FIS.setDrawColor(TLBFISLib::INVERTED);
+  draw();
+  FIS.flush();
+  for (const std::vector<uint8_t> &block : cluster.blocks()) {
+    state.apply(block);
+    inverted.apply(block);
+  }
+  cluster.clearBlocks();
+
+  for (int y = 0; y < 88; y++) {
+    for (int x = 0; x < 64; x++) {
+      if (normal.pixels[y][x] == inverted.pixels[y][x]) {
+        printf("pixel %d,%d: %s both times\n", x, y, normal.pixels[y][x] ? "on" : "off");
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//Draw an arc and a full circle, and check that the arc contains the right part of the circle.
+bool check_arc(uint8_t centerX, uint8_t centerY, uint8_t radius, uint16_t start_angle, uint16_t end_angle)
+{
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+  simulatedScreen circle = state;
+  memset(circle.pixels, 0, sizeof(circle.pixels));
+
+  FIS.setDrawColor(TLBFISLib::NORMAL);
+  FIS.drawCircle(centerX, centerY, radius);
+  FIS.flush();
+  for (const std::vector<uint8_t> &block : cluster.blocks()) {
+    state.apply(block);
+    circle.apply(block);
+  }
+  cluster.clearBlocks();
+
+  simulatedScreen arc = state;
+  memset(arc.pixels, 0, sizeof(arc.pixels));
+  FIS.drawArc(centerX, centerY, radius, start_angle, end_angle);
+  FIS.flush();
+  for (const std::vector<uint8_t> &block : cluster.blocks()) {
+    state.apply(block);
+    arc.apply(block);
+  }
+  cluster.clearBlocks();
+
+  double span = fmod(end_angle - start_angle + 360.0, 360.0);
+  for (int y = 0; y < 88; y++) {
+    for (int x = 0; x < 64; x++) {
+      if (arc.pixels[y][x] && !circle.pixels[y][x]) {
+        printf("arc %u-%u: pixel %d,%d is not on the circle\n", start_angle, end_angle, x, y);
+        return false;
+      }
+      if (!circle.pixels[y][x]) {
+        continue;
+      }
+
+      //Angle clockwise from the top (the workspace of the HALFSCREEN size starts at row 27 of the screen), and how far it is from the ends.
+      double angle = atan2(x - centerX, -(y - 27 - centerY)) * 180.0 / M_PI;
+      double from_start = fmod(angle - start_angle + 720.0, 360.0);
+      double from_end = fmod(angle - end_angle + 720.0, 360.0);
+      if (from_start < 0.5 || from_start > 359.5 || from_end < 0.5 || from_end > 359.5) {
+        continue;
+      }
+
+      bool inside = (end_angle == 360 && !start_angle) || from_start <= span;
+      if (inside != (bool)arc.pixels[y][x]) {
+        printf("arc %u-%u: pixel %d,%d (%.1f degrees) should be %s\n", start_angle, end_angle, x, y, angle, inside ? "on" : "off");
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+
+  FIS.begin();
+  CHECK(FIS.initScreen() == TLBFISLib::SENT);
+  state.apply(cluster);
+
+  //Triangle with a horizontal base, whose corners are shared by a fill and a slanted edge
+  static const uint8_t triangle[] = {0, 0, 10, 0, 5, 8};
+  CHECK(check_inverted([]() { FIS.drawPolygon(triangle, 3); }));
+
+  //Polygons mixing straight and slanted edges
+  srand(33);
+  for (int i = 0; i < 300; i++) {
+    uint8_t points[12];
+    uint8_t count = 2 + rand() % 5;
+    for (uint8_t p = 0; p < count; p++) {
+      points[2 * p] = rand() % 70;
+      points[2 * p + 1] = rand() % 52;
+
+      //Often share a coordinate with the previous corner, for straight edges.
+      if (p && rand() % 2) {
+        uint8_t axis = rand() % 2;
+        points[2 * p + axis] = points[2 * p - 2 + axis];
+      }
+    }
+    bool closed = rand() % 2;
+    CHECK(check_inverted([&]() { FIS.drawPolygon(points, count, closed); }));
+  }
+
+  //Circles and arcs toggle exactly their own pixels.
+  CHECK(check_inverted([]() { FIS.drawCircle(32, 24, 20); }));
+  CHECK(check_inverted([]() { FIS.drawArc(20, 20, 15, 225, 135); }));
+
+  //Arcs keep the pixels of the circle between their ends.
+  static const uint16_t arcs[][2] = {
+    {0, 90}, {90, 180}, {45, 135}, {225, 135}, {300, 60}, {10, 350}, {0, 180}, {180, 360}, {90, 90}, {1, 359}, {170, 190}, {0, 360}
+  };
+  for (const uint16_t* ends : arcs) {
+    CHECK(check_arc(32, 24, 22, ends[0], ends[1]));
+    CHECK(check_arc(30, 20, 7, ends[0], ends[1]));
+  }
+  for (int i = 0; i < 200; i++) {
+    CHECK(check_arc(32, 24, 1 + rand() % 23, rand() % 360, rand() % 361));
+  }
+
+  return check_result("shape_test");
+}
@@ -0,0 +1,150 @@
+/*
+  Title:
+    soak_test.cpp
+
+  Description:
+    Runs the dashboard of the 24.Soak_test example for hours of virtual time against a misbehaving simulated cluster, and reports the throughput,
+    the longest time the sketch was blocked and the longest time the cluster took to recover.
+
+  Usage:
+    soak_test [hours] [seed] -> simulate the given number of hours (1 by default), with the faults generated from the seed
+
+  Notes:
+    *The faults are REPEAT storms, FAIL bursts and calls of the error function (see faultInjection() in TLBLib.h); the same seed always gives the
+    same run.
+    *A report is printed every 10 minutes of virtual time; the test fails if a call to update() blocks for much longer than the deadline set with
+    setRetryPolicy(), or if the dashboard stops being refreshed.
+*/
+
+#include <TLBFISLib.h>
+#include <TLBFISNumber.h>
+#include <TLBFISBar.h>
+#include <stdlib.h>
+#include "check.h"
+
+//ENA pin of the simulated cluster
+#define ENA_PIN 9
+
+//Retry policy: give up on a block after 3 errors, and on a call after 50ms.
+#define MAX_FAILURES 3
+#define TIMEOUT_MS   50
+
+//Time between two reports (in milliseconds)
+#define REPORT_INTERVAL 600000UL
+
+TLBFISLib FIS(ENA_PIN, [](uint8_t) {});
+
+//Dashboard
+TLBFISNumber speed(FIS, 4, 4, 3);
+TLBFISBar rpm(FIS, 4, 24, 56, 8);
+
+//Faults to simulate (chances out of 65536 attempts)
+TLBLib::faultProfile faults = {
+  600,  //REPEAT storm chance (~1%)
+  40,   //longest REPEAT storm
+  300,  //FAIL burst chance (~0.5%)
+  5,    //longest FAIL burst
+  20,   //error function chance (~0.03%)
+  500,  //duration given to the error function (ms)
+  200,  //latency of every simulated answer (us)
+  12345 //seed
+};
+
+TLBFISLib::transportStats stats;
+
+//Totals over the whole run
+unsigned long total_bytes = 0, total_given_up = 0, worst_block_us = 0, worst_recovery_ms = 0, worst_update_us = 0;
+
+int main(int argc, char* argv[])
+{
+  unsigned long hours = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1;
+  if (argc > 2) {
+    faults.seed = strtoul(argv[2], nullptr, 10);
+  }
+
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+  cluster.faultInjection(&faults);
+
+  //If the screen is taken over, initialize it again; the widgets are redrawn by update().
+  FIS.errorFunction(
+    [](unsigned long duration) {
+      (void) duration;
+      FIS.initScreen();
+    }
+  );
+
+  FIS.setRetryPolicy(MAX_FAILURES, TIMEOUT_MS, 100);
+  FIS.transportStatistics(&stats);
+
+  FIS.begin();
+  FIS.initScreen();
+
+  rpm.setRange(0, 7000);
+  speed.setRefreshInterval(100);
+  rpm.setRefreshInterval(50);
+  FIS.addWidget(speed);
+  FIS.addWidget(rpm);
+
+  unsigned long start = millis(), report_timer = millis(), errors = 0;
+  unsigned long worst_update_interval_us = 0;
+  bool done = false;
+
+  while (!done) {
+    //Maintain the connection and refresh the dashboard, measuring how long the sketch is blocked.
+    unsigned long update_start = micros();
+    FIS.update();
+    unsigned long blocked = micros() - update_start;
+    if (blocked > worst_update_interval_us) {
+      worst_update_interval_us = blocked;
+    }
+
+    //Simulate the values.
+    speed.setValue((millis() / 100) % 250);
+    rpm.setValue((millis() * 7) % 7000);
+
+    //Sleep until update() has work to do again, like a sketch which saves power.
+    unsigned long sleep = FIS.msUntilNextUpdate();
+    delay(sleep ? sleep : 1);
+
+    //Report every interval, and what is left of the last one at the end.
+    done = (millis() - start >= hours * 3600000UL);
+    if (millis() - report_timer >= REPORT_INTERVAL || done) {
+      unsigned long elapsed = millis() - report_timer;
+      report_timer = millis();
+      unsigned long new_errors = cluster.errors() - errors;
+      errors = cluster.errors();
+
+      printf("%5lu min: %4lu B/s, blocks %6lu, repeats %5lu, failures %4lu, given up %3lu, errors %2lu | worst block %6lu us, worst update %6lu us, "
+             "worst recovery %4lu ms over %lu recoveries\n",
+             (millis() - start) / 60000, stats.bytes * 1000 / elapsed, stats.blocks, stats.repeats, stats.failures, stats.given_up, new_errors,
+             stats.worst_block_us, worst_update_interval_us, stats.worst_recovery_ms, stats.recoveries);
+
+      //The dashboard must keep being refreshed, whatever the cluster does.
+      CHECK(stats.blocks > 0);
+
+      total_bytes += stats.bytes;
+      total_given_up += stats.given_up;
+      if (stats.worst_block_us > worst_block_us) {
+        worst_block_us = stats.worst_block_us;
+      }
+      if (stats.worst_recovery_ms > worst_recovery_ms) {
+        worst_recovery_ms = stats.worst_recovery_ms;
+      }
+      if (worst_update_interval_us > worst_update_us) {
+        worst_update_us = worst_update_interval_us;
+      }
+      worst_update_interval_us = 0;
+      FIS.resetTransportStatistics();
+    }
+  }
+
+  printf("%lu h (seed %lu): %lu B/s, %lu blocks given up, %lu errors | worst block %lu us, worst update %lu us, worst recovery %lu ms\n",
+         hours, (unsigned long)faults.seed, total_bytes * 1000 / (millis() - start), total_given_up, cluster.errors(), worst_block_us, worst_update_us,
+         worst_recovery_ms);
+
+  //Nothing may block the sketch for much longer than the deadline (the last attempt may start just before it passes).
+  CHECK(worst_block_us <= TIMEOUT_MS * 1000UL + 5000);
+  CHECK(worst_update_us <= TIMEOUT_MS * 1000UL + 5000);
+
+  return check_result("soak_test");
+}
@@ -0,0 +1,77 @@
+/*
+  Title:
+    text_merge_test.cpp
+
+  Description:
+    Checks that left-aligned text kept to be merged reaches the cluster, even if the cluster rejects it at first.
+
+  Notes:
+    *Text written next to the previous text must be sent in a single block, when the next command needs the bus.
+    *Text which the cluster doesn't accept must stay waiting, the call which tried to send it must return the error, and the text must be sent by
+    the next call once the cluster accepts it again.
+*/
+
+#include <TLBFISLib.h>
+#include "check.h"
+
+//ENA pin of the simulated cluster
+#define ENA_PIN 9
+
+TLBFISLib FIS(ENA_PIN, [](uint8_t) {});
+
+//Count the text blocks received by the cluster which contain exactly the given characters.
+size_t text_blocks(TLBLib &cluster, const char* text)
+{
+  size_t count = 0, length = strlen(text);
+  for (const std::vector<uint8_t> &block : cluster.blocks()) {
+    if (block.size() == length + 5 && !memcmp(block.data() + 5, text, length)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+int main()
+{
+  TLBLib &cluster = TLBLib::cluster(ENA_PIN);
+
+  FIS.begin();
+  FIS.setRetryPolicy(2);
+  CHECK(FIS.initScreen() == TLBFISLib::SENT);
+
+  //Consecutive text is kept, and sent as one block by flush().
+  cluster.clearBlocks();
+  CHECK(FIS.writeText(0, 0, "AB") == TLBFISLib::SENT);
+  CHECK(FIS.writeText(12, 0, "CD") == TLBFISLib::SENT);
+  CHECK(cluster.blocks().empty());
+  CHECK(FIS.flush() == TLBFISLib::SENT);
+  CHECK(cluster.blocks().size() == 1 && text_blocks(cluster, "ABCD") == 1);
+
+  //Text the cluster rejects stays waiting, and every call which tries to send it reports the error.
+  cluster.clearBlocks();
+  CHECK(FIS.writeText(0, 8, "EFGH") == TLBFISLib::SENT);
+  cluster.maxBlockSize = 8;
+  CHECK(FIS.flush() == TLBFISLib::FAILED);
+  CHECK(FIS.setFont(TLBFISLib::COMPACT) == TLBFISLib::FAILED);
+  CHECK(FIS.drawLine(0, 20, 10) == TLBFISLib::FAILED);
+  FIS.update();
+  CHECK(text_blocks(cluster, "EFGH") == 0);
+
+  //Once the cluster accepts it, the text is sent before the next command, with its own settings.
+  cluster.maxBlockSize = 0;
+  CHECK(FIS.drawLine(0, 20, 10) == TLBFISLib::SENT);
+  CHECK(text_blocks(cluster, "EFGH") == 1);
+  CHECK(FIS.flush() == TLBFISLib::SENT);
+
+  //initScreen() discards text which is still waiting.
+  CHECK(FIS.writeText(0, 0, "IJ") == TLBFISLib::SENT);
+  cluster.maxBlockSize = 6;
+  CHECK(FIS.flush() == TLBFISLib::FAILED);
+  cluster.maxBlockSize = 0;
+  CHECK(FIS.initScreen() == TLBFISLib::SENT);
+  cluster.clearBlocks();
+  CHECK(FIS.flush() == TLBFISLib::SENT);
+  CHECK(text_blocks(cluster, "IJ") == 0);
+
+  return check_result("text_merge_test");
+}
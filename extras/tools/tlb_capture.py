@@ -0,0 +1,692 @@
+#!/usr/bin/env python3
+"""
+  Title:
+    tlb_capture.py
+
+  Description:
+    Decodes captures of the 3LB bus (ENA/CLK/DATA) into the commands sent by TLBFISLib, reports where the wire time goes, compares two
+    captures and turns a capture into a sketch which sends the same commands through the library.
+
+  Usage:
+    tlb_capture.py decode  capture.csv             -> list every block with its timing, followed by a summary per command
+    tlb_capture.py stats   capture.csv             -> only the summary
+    tlb_capture.py compare original.csv other.csv  -> compare the summaries and list the blocks which differ
+    tlb_capture.py sketch  capture.csv > replay.ino -> generate a sketch which replays the capture with the library's functions
+
+  Capture formats:
+    *Sampled lines: a CSV export of a logic analyzer (for example Saleae or sigrok), with a time column (in seconds) followed by one column per line;
+    the columns are found by their names (CLK/CLOCK, DATA/DAT/MOSI, ENA/EN), or can be given with --clk/--data/--ena.
+    Rows may contain every sample or only the changes.
+    *Byte dumps: one or more bytes per line (as "53" or "0x53", separated by spaces or commas), optionally preceded by a time in seconds; the
+    CSV export of an SPI analyzer also works (the MOSI/DATA column is used).
+
+  Notes:
+    *Bytes are read MSB-first on the rising edge of CLK (SPI mode 3, like the examples); use --edge and --invert if the capture was taken
+    differently, and --checksum if every block is followed by a checksum byte.
+    *Blocks are framed by their length byte; a pause longer than --block-gap in the middle of a block drops the incomplete block.
+    *The sketch generated from a capture can be run and captured again, then compared with the original, to see what the library sends differently.
+"""
+
+import argparse
+import csv
+import difflib
+import os
+import re
+import sys
+
+# Opcodes used by TLBFISLib
+OPCODES = {
+  0x53: "WORKSPACE",
+  0x56: "TEXT",
+  0x55: "BITMAP",
+  0x63: "LINE",
+  0x81: "RADIO",
+}
+
+# Text options
+TEXT_TRANSPARENT = 0x01
+TEXT_OR_OUTPUT   = 0x02
+TEXT_COMPACT     = 0x04
+TEXT_GRAPHICS    = 0x08
+TEXT_RIGHT       = 0x10
+TEXT_CENTER      = 0x20
+
+# Bitmap options
+BMP_TRANSPARENT = 0x01
+BMP_OR_OUTPUT   = 0x02
+
+# Blocks longer than this are not accepted when framing (the library sends at most TLB_MAX_BYTES_PER_BLOCK bytes, 42 by default)
+MAX_BLOCK_LENGTH = 64
+
+
+class Block:
+  """A block of the capture: its bytes and when they were transmitted (in seconds, None if the capture has no times)."""
+
+  def __init__(self, data, start, end, lead=None, checksum=None, complete=True):
+    self.data = data
+    self.start = start
+    self.end = end
+    self.lead = lead  # time between the last ENA change before the block and its first bit
+    self.checksum = checksum
+    self.complete = complete
+
+  @property
+  def opcode(self):
+    return self.data[0] if self.data else None
+
+  @property
+  def name(self):
+    if self.opcode in OPCODES:
+      return OPCODES[self.opcode]
+    return "0x%02X" % self.opcode
+
+  @property
+  def duration(self):
+    if self.start is None or self.end is None:
+      return None
+    return self.end - self.start
+
+
+###CAPTURE PARSING
+
+def find_column(header, wanted, candidates):
+  """Finds the index of a column, by the name given on the command line or by the usual names."""
+  names = [name.strip().lower() for name in header]
+
+  if wanted is not None:
+    # A number selects the column directly.
+    if wanted.isdigit():
+      return int(wanted)
+    for index, name in enumerate(names):
+      if name == wanted.lower():
+        return index
+    sys.exit("error: column '%s' not found in %s" % (wanted, header))
+
+  for candidate in candidates:
+    for index, name in enumerate(names):
+      if re.search(r"\b%s\b" % candidate, name):
+        return index
+  return None
+
+
+def read_rows(path):
+  """Reads a CSV file, skipping comments (sigrok) and empty lines."""
+  with open(path, newline="") as file:
+    lines = [line for line in file if line.strip() and not line.startswith(";") and not line.startswith("#")]
+  return list(csv.reader(lines))
+
+
+def is_number(text):
+  try:
+    float(text)
+    return True
+  except ValueError:
+    return False
+
+
+def parse_lines(rows, args):
+  """Decodes a capture of sampled lines into bytes: returns a list of (byte, start, end, lead)."""
+  header = rows[0]
+  clk = find_column(header, args.clk, ["clk", "clock", "sck", "scl"])
+  data = find_column(header, args.data, ["data", "dat", "mosi", "sda"])
+  ena = find_column(header, args.ena, ["ena", "enable", "en"])
+  if clk is None or data is None:
+    sys.exit("error: the CLK and DATA columns were not found in %s (use --clk and --data)" % header)
+
+  active = 1 if args.edge == "rising" else 0
+  byte_gap = args.byte_gap / 1e6
+
+  result = []
+  value, bits, first_edge, last_edge = 0, 0, None, None
+  previous_clk, previous_ena, ena_change = None, None, None
+
+  for row in rows[1:]:
+    if len(row) <= max(clk, data) or not is_number(row[0]):
+      continue
+    time = float(row[0])
+    level = int(float(row[clk]))
+
+    # Remember when ENA last changed, to measure how long the handshake took before each block.
+    if ena is not None and len(row) > ena:
+      ena_level = int(float(row[ena]))
+      if previous_ena is not None and ena_level != previous_ena:
+        ena_change = time
+      previous_ena = ena_level
+
+    # Sample DATA on the active edge of CLK.
+    if previous_clk is not None and level != previous_clk and level == active:
+      # A long pause means that the previous byte was incomplete.
+      if bits and time - last_edge > byte_gap:
+        value, bits = 0, 0
+      if not bits:
+        first_edge = time
+
+      value = (value << 1) | (int(float(row[data])) & 1)
+      bits += 1
+      last_edge = time
+
+      if bits == 8:
+        lead = first_edge - ena_change if ena_change is not None and ena_change <= first_edge else None
+        result.append((value ^ (0xFF if args.invert else 0), first_edge, last_edge, lead))
+        value, bits = 0, 0
+
+    previous_clk = level
+
+  return result
+
+
+def parse_bytes(rows, args):
+  """Reads a byte dump: returns a list of (byte, start, end, lead)."""
+  result = []
+  column = None
+
+  # The CSV export of an SPI analyzer has a header; only the data column is used.
+  if rows and not any(is_number(cell) or re.fullmatch(r"(0x)?[0-9a-fA-F]{1,2}", cell) for field in rows[0] for cell in field.split()):
+    column = find_column(rows[0], args.data, ["mosi", "data", "value"])
+    rows = rows[1:]
+
+  for row in rows:
+    cells = [cell for field in row for cell in field.split()]
+    time = None
+
+    # A time in seconds (with a decimal point) can precede the bytes.
+    if cells and "." in cells[0] and is_number(cells[0]):
+      time = float(cells[0])
+
+    if column is not None:
+      values = [row[column]] if len(row) > column else []
+    else:
+      values = cells[1:] if time is not None else cells
+
+    for text in values:
+      text = text.strip()
+      if not text:
+        continue
+      try:
+        result.append((int(text, 16) ^ (0xFF if args.invert else 0), time, time, None))
+      except ValueError:
+        sys.exit("error: '%s' is not a byte" % text)
+
+  return result
+
+
+def frame_blocks(stream, args):
+  """Groups bytes into blocks, using the length byte of every block."""
+  blocks = []
+  current = []
+  block_gap = args.block_gap / 1e6
+  extra = 1 if args.checksum else 0
+
+  def close(complete):
+    data = [byte for byte, _, _, _ in current]
+    checksum = None
+    if complete and extra:
+      checksum = data.pop()
+    blocks.append(Block(data, current[0][1], current[-1][2], current[0][3], checksum, complete))
+
+  for item in stream:
+    # A long pause in the middle of a block means that the block was cut off.
+    if current and item[1] is not None and current[-1][2] is not None and item[1] - current[-1][2] > block_gap:
+      close(False)
+      current = []
+
+    current.append(item)
+
+    # An impossible length can't be framed; report the byte alone and look for the next block.
+    if len(current) == 2 and current[1][0] > MAX_BLOCK_LENGTH:
+      first = current.pop(0)
+      current, rest = [first], current
+      close(False)
+      current = rest
+      continue
+
+    if len(current) >= 2 and len(current) == current[1][0] + 2 + extra:
+      close(True)
+      current = []
+
+  if current:
+    close(False)
+
+  return blocks
+
+
+def load(path, args):
+  """Reads a capture in either format and frames it into blocks."""
+  rows = read_rows(path)
+  if not rows:
+    sys.exit("error: '%s' is empty" % path)
+
+  capture_format = args.format
+  if capture_format == "auto":
+    header = [cell.strip().lower() for cell in rows[0]]
+    has_clk = any(re.search(r"\b(clk|clock|sck|scl)\b", cell) for cell in header)
+    capture_format = "lines" if has_clk or args.clk else "bytes"
+
+  stream = parse_lines(rows, args) if capture_format == "lines" else parse_bytes(rows, args)
+  return frame_blocks(stream, args)
+
+
+###DECODING
+
+def load_character_table():
+  """Builds the reverse of the library's character lookup table (cluster character -> ISO/IEC 8859-1), from src/characters.h."""
+  path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "src", "characters.h")
+  reverse = {}
+  try:
+    with open(path, encoding="latin-1") as file:
+      source = file.read()
+  except OSError:
+    return reverse
+
+  match = re.search(r"TLBFIS_ISO_IEC_8859_1\[\]\s*=\s*\{(.*?)\};", source, re.S)
+  if not match:
+    return reverse
+  table = [int(value, 16) for value in re.findall(r"0x([0-9A-Fa-f]{2})", re.sub(r"//[^\n]*", "", match.group(1)))]
+
+  # Prefer printable ASCII, then the rest of the printable characters, for codes which several characters map to.
+  def preference(character):
+    if 0x20 <= character < 0x7F:
+      return 0
+    if character >= 0xA0:
+      return 1
+    return 2
+
+  for character, code in enumerate(table):
+    if code not in reverse or preference(character) < preference(reverse[code]):
+      reverse[code] = character
+  return reverse
+
+
+CHARACTERS = load_character_table()
+
+
+def text_string(codes, graphics=False):
+  """Shows cluster characters as readable text (characters without an equivalent are shown as \\xNN)."""
+  result = ""
+  for code in codes:
+    character = code if graphics else CHARACTERS.get(code)
+    if character is not None and (0x20 <= character < 0x7F or character >= 0xA0) and not graphics:
+      result += chr(character)
+    else:
+      result += "\\x%02X" % code
+  return result
+
+
+def describe(block, state):
+  """Describes a block in terms of the library's commands, updating the tracked workspace."""
+  data = block.data
+  if len(data) < 2:
+    return "incomplete"
+  payload = data[2:]
+
+  if block.opcode == 0x53 and len(payload) >= 5:
+    options, X, Y, W, H = payload[:5]
+    state["workspace"] = (X, Y, W, H)
+    kind = {0x00: "set", 0x02: "fill off", 0x03: "fill on", 0x82: "claim normal", 0x83: "claim inverted"}.get(options, "options 0x%02X" % options)
+    return "%s X=%d Y=%d W=%d H=%d" % (kind, X, Y, W, H)
+
+  if block.opcode == 0x56 and len(payload) >= 3:
+    options, X, Y = payload[:3]
+    font = "GRAPHICS" if options & TEXT_GRAPHICS else ("COMPACT" if options & TEXT_COMPACT else "STANDARD")
+    alignment = "RIGHT" if options & TEXT_RIGHT else ("CENTER" if options & TEXT_CENTER else "LEFT")
+    flags = "%s %s %s %s" % (font, alignment, "TRANSPARENT" if options & TEXT_TRANSPARENT else "OPAQUE", "NORMAL" if options & TEXT_OR_OUTPUT else "INVERTED")
+    return "X=%d Y=%d %s \"%s\"" % (X, Y, flags, text_string(payload[3:], options & TEXT_GRAPHICS))
+
+  if block.opcode == 0x55 and len(payload) >= 3:
+    options, X, Y = payload[:3]
+    count = len(payload) - 3
+    rows = ""
+    if "workspace" in state:
+      bytes_per_line = (state["workspace"][2] - X + 7) // 8
+      if bytes_per_line > 0:
+        rows = " (%d rows of %d bytes)" % (count // bytes_per_line, bytes_per_line)
+    flags = "%s %s" % ("TRANSPARENT" if options & BMP_TRANSPARENT else "OPAQUE", "NORMAL" if options & BMP_OR_OUTPUT else "INVERTED")
+    return "X=%d Y=%d %s %d bytes%s" % (X, Y, flags, count, rows)
+
+  if block.opcode == 0x63 and len(payload) >= 4:
+    options, X, Y, length = payload[:4]
+    orientation = {0x10: "VERTICAL", 0x20: "HORIZONTAL"}.get(options, "options 0x%02X" % options)
+    return "%s X=%d Y=%d length=%d" % (orientation, X, Y, length)
+
+  if block.opcode == 0x81 and len(payload) >= 17 and payload[0] == 0xF0:
+    return "\"%s\" / \"%s\"" % (text_string(payload[1:9]), text_string(payload[9:17]))
+
+  return " ".join("%02X" % byte for byte in data)
+
+
+def checksum_note(block):
+  """Checks the checksum byte against the two usual conventions (XOR of all bytes, inverted or not)."""
+  if block.checksum is None:
+    return ""
+  value = 0
+  for byte in block.data:
+    value ^= byte
+  if block.checksum == value or block.checksum == value ^ 0xFF:
+    return ""
+  return " [checksum %02X, expected %02X or %02X]" % (block.checksum, value, value ^ 0xFF)
+
+
+def milliseconds(seconds):
+  return "%9.3f" % (seconds * 1000) if seconds is not None else "        -"
+
+
+###REPORTS
+
+def summarize(blocks):
+  """Adds up the blocks, bytes, wire time and gaps of every command type."""
+  summary = {}
+  previous_end = None
+  for block in blocks:
+    entry = summary.setdefault(block.name, {"blocks": 0, "bytes": 0, "wire": 0.0, "gap": 0.0, "gaps": 0, "lead": 0.0, "leads": 0})
+    entry["blocks"] += 1
+    entry["bytes"] += len(block.data)
+    if block.duration is not None:
+      entry["wire"] += block.duration
+    if block.start is not None and previous_end is not None:
+      entry["gap"] += block.start - previous_end
+      entry["gaps"] += 1
+    if block.lead is not None:
+      entry["lead"] += block.lead
+      entry["leads"] += 1
+    previous_end = block.end
+  return summary
+
+
+def print_summary(blocks, title=None):
+  summary = summarize(blocks)
+  timed = [block for block in blocks if block.start is not None]
+  total_wire = sum(entry["wire"] for entry in summary.values())
+
+  if title:
+    print("== %s" % title)
+  print("%-10s %7s %7s %10s %7s %10s %10s %10s" % ("command", "blocks", "bytes", "wire ms", "wire %", "avg ms", "gap ms", "lead ms"))
+  for name in sorted(summary, key=lambda name: -summary[name]["wire"] or -summary[name]["bytes"]):
+    entry = summary[name]
+    share = 100 * entry["wire"] / total_wire if total_wire else 0
+    average = entry["wire"] / entry["blocks"] if timed else None
+    gap = entry["gap"] / entry["gaps"] if entry["gaps"] else None
+    lead = entry["lead"] / entry["leads"] if entry["leads"] else None
+    print("%-10s %7d %7d %10s %6.1f%% %10s %10s %10s" % (name, entry["blocks"], entry["bytes"], milliseconds(entry["wire"]) if timed else "-", share,
+                                                        milliseconds(average), milliseconds(gap), milliseconds(lead)))
+
+  incomplete = sum(1 for block in blocks if not block.complete)
+  print("%-10s %7d %7d %10s" % ("total", len(blocks), sum(len(block.data) for block in blocks), milliseconds(total_wire) if timed else "-"))
+  if timed:
+    span = timed[-1].end - timed[0].start
+    print("capture: %.3f ms, bus busy %.1f%%, idle between blocks %.3f ms" % (span * 1000, 100 * total_wire / span if span else 0,
+                                                                           (span - total_wire) * 1000))
+  if incomplete:
+    print("incomplete blocks: %d" % incomplete)
+  print("(gap = idle time before the block, lead = time from the last ENA change to the first bit)")
+
+
+def command_decode(args):
+  blocks = load(args.capture, args)
+  state = {}
+  previous_end = None
+
+  print("%5s %10s %10s %10s  %-9s %s" % ("#", "start ms", "wire ms", "gap ms", "command", "details"))
+  for index, block in enumerate(blocks):
+    gap = block.start - previous_end if block.start is not None and previous_end is not None else None
+    origin = blocks[0].start if blocks[0].start is not None else 0
+    start = block.start - origin if block.start is not None else None
+    flag = "" if block.complete else " [incomplete]"
+    print("%5d %10s %10s %10s  %-9s %s%s%s" % (index, milliseconds(start), milliseconds(block.duration), milliseconds(gap), block.name,
+                                              describe(block, state), checksum_note(block), flag))
+    previous_end = block.end
+
+  print()
+  print_summary(blocks)
+
+
+def command_stats(args):
+  print_summary(load(args.capture, args))
+
+
+def command_compare(args):
+  first = load(args.capture, args)
+  second = load(args.other, args)
+  print_summary(first, args.capture)
+  print()
+  print_summary(second, args.other)
+  print()
+
+  # List the differences between the two block sequences.
+  matcher = difflib.SequenceMatcher(None, [tuple(block.data) for block in first], [tuple(block.data) for block in second], autojunk=False)
+  state_first, state_second = {}, {}
+  shown = 0
+  for tag, first_start, first_end, second_start, second_end in matcher.get_opcodes():
+    if tag == "equal":
+      for block in first[first_start:first_end]:
+        describe(block, state_first)
+      for block in second[second_start:second_end]:
+        describe(block, state_second)
+      continue
+
+    for index in range(first_start, first_end):
+      if shown < args.limit:
+        print("- %5d %-9s %s" % (index, first[index].name, describe(first[index], state_first)))
+      shown += 1
+    for index in range(second_start, second_end):
+      if shown < args.limit:
+        print("+ %5d %-9s %s" % (index, second[index].name, describe(second[index], state_second)))
+      shown += 1
+
+  if shown > args.limit:
+    print("... %d more differences" % (shown - args.limit))
+  print("%d of %d blocks match (similarity %.1f%%)" % (sum(size for _, _, size in matcher.get_matching_blocks()), len(first),
+                                            100 * matcher.ratio()))
+
+
+###SKETCH GENERATION
+
+def c_string(codes):
+  """Writes bytes as a C string literal (octal escapes, so that they can't merge with following characters)."""
+  result = ""
+  for code in codes:
+    if 0x20 <= code < 0x7F and chr(code) not in "\"\\?":
+      result += chr(code)
+    else:
+      result += "\\%03o" % code
+  return "\"%s\"" % result
+
+
+def sketch_calls(blocks):
+  """Converts the blocks to calls of the library's functions; returns the calls and the bitmap arrays."""
+  calls, arrays = [], []
+  workspace = None
+  offset = 27  # setWorkspace() coordinates start on the first row of the screen (HALFSCREEN is assumed until the screen is claimed)
+  settings = {}
+
+  def select(name, value, call):
+    if settings.get(name) != value:
+      settings[name] = value
+      calls.append(call)
+
+  for index, block in enumerate(blocks):
+    data, payload = block.data, block.data[2:]
+    if not block.complete or len(data) < 2:
+      calls.append("//Block %d is incomplete: %s" % (index, " ".join("%02X" % byte for byte in data)))
+      continue
+
+    if block.opcode == 0x53 and len(payload) >= 5:
+      options, X, Y, W, H = payload[:5]
+      if options in (0x82, 0x83):
+        size = "HALFSCREEN" if (X, Y, W, H) == (0, 27, 64, 48) else "FULLSCREEN"
+        if (X, Y, W, H) not in ((0, 27, 64, 48), (0, 0, 64, 88)):
+          calls.append("//The screen was claimed with X=%d Y=%d W=%d H=%d" % (X, Y, W, H))
+        calls.append("FIS.initScreen(TLBFISLib::%s, TLBFISLib::%s);" % (size, "INVERTED" if options & 1 else "NORMAL"))
+        offset = 27 if size == "HALFSCREEN" else 0
+        settings.clear()
+      elif Y < offset:
+        calls.append("//Block %d selects an area above the screen (Y=%d): %s" % (index, Y, " ".join("%02X" % byte for byte in data)))
+      elif options in (0x02, 0x03):
+        calls.append("FIS.setWorkspace(%d, %d, %d, %d, true, TLBFISLib::%s);" % (X, Y - offset, W, H, "INVERTED" if options & 1 else "NORMAL"))
+      else:
+        calls.append("FIS.setWorkspace(%d, %d, %d, %d);" % (X, Y - offset, W, H))
+      workspace = (X, Y, W, H)
+
+    elif block.opcode == 0x56 and len(payload) >= 3:
+      options, X, Y = payload[:3]
+      codes = payload[3:]
+      select("font", options & (TEXT_GRAPHICS | TEXT_COMPACT), "FIS.setFont(TLBFISLib::%s);" % (
+             "GRAPHICS" if options & TEXT_GRAPHICS else ("COMPACT" if options & TEXT_COMPACT else "STANDARD")))
+      select("text_transparency", options & TEXT_TRANSPARENT, "FIS.setTextTransparency(TLBFISLib::%s);" % (
+             "TRANSPARENT" if options & TEXT_TRANSPARENT else "OPAQUE"))
+      select("alignment", options & (TEXT_RIGHT | TEXT_CENTER), "FIS.setTextAlignment(TLBFISLib::%s);" % (
+             "RIGHT" if options & TEXT_RIGHT else ("CENTER" if options & TEXT_CENTER else "LEFT")))
+      select("color", options & TEXT_OR_OUTPUT, "FIS.setDrawColor(TLBFISLib::%s);" % ("NORMAL" if options & TEXT_OR_OUTPUT else "INVERTED"))
+
+      # The library encodes the characters again, so give it the characters which map to the captured ones (GRAPHICS characters are sent as they are).
+      if options & TEXT_GRAPHICS:
+        characters = codes
+      else:
+        characters = [CHARACTERS.get(code, 0x20) for code in codes]
+        if any(code not in CHARACTERS for code in codes):
+          calls.append("//Block %d contains characters which the lookup table doesn't produce; they are replaced with spaces" % index)
+      calls.append("FIS.writeText(%d, %d, %s);" % (X, Y, c_string(characters)))
+
+    elif block.opcode == 0x55 and len(payload) >= 3:
+      options, X, Y = payload[:3]
+      pixels = payload[3:]
+      bytes_per_line = max(1, ((workspace[2] if workspace else 64) - X + 7) // 8)
+      rows = max(1, len(pixels) // bytes_per_line)
+      select("bitmap_transparency", options & BMP_TRANSPARENT, "FIS.setBitmapTransparency(TLBFISLib::%s);" % (
+             "TRANSPARENT" if options & BMP_TRANSPARENT else "OPAQUE"))
+      select("color", options & BMP_OR_OUTPUT, "FIS.setDrawColor(TLBFISLib::%s);" % ("NORMAL" if options & BMP_OR_OUTPUT else "INVERTED"))
+
+      name = "bitmap_%d" % index
+      lines = ["  " + ", ".join("0x%02X" % byte for byte in pixels[offset:offset + 16]) + "," for offset in range(0, len(pixels), 16)]
+      arrays.append("//%dx%d\nconst unsigned char %s[] PROGMEM = {\n%s\n};" % (bytes_per_line * 8, rows, name, "\n".join(lines)))
+      calls.append("FIS.drawBitmap(%d, %d, %d, %d, %s);" % (X, Y, bytes_per_line * 8, rows, name))
+
+    elif block.opcode == 0x63 and len(payload) >= 4:
+      options, X, Y, length = payload[:4]
+      calls.append("FIS.drawThinLine(%d, %d, %d, TLBFISLib::%s);" % (X, Y, length, "VERTICAL" if options == 0x10 else "HORIZONTAL"))
+
+    elif block.opcode == 0x81 and len(payload) >= 17 and payload[0] == 0xF0:
+      # Both lines are sent in every block, so the raw data reproduces it exactly (the header and checksum bytes of the array are ignored).
+      name = "radio_%d" % index
+      arrays.append("//\"%s\" / \"%s\"\nuint8_t %s[18] = {\n  0x00, %s, 0x00\n};" % (text_string(payload[1:9]), text_string(payload[9:17]), name,
+                                                                              ", ".join("0x%02X" % byte for byte in payload[1:17])))
+      calls.append("FIS.writeRadioRawData(%s);" % name)
+
+    else:
+      calls.append("//Block %d can't be sent with the library's functions: %s" % (index, " ".join("%02X" % byte for byte in data)))
+
+  return calls, arrays
+
+
+SKETCH_TEMPLATE = """/*
+  Title:
+    replay.ino
+
+  Description:
+    Sends the commands decoded from %(capture)s (generated by tlb_capture.py).
+
+  Notes:
+    *Capture the bus while this sketch runs and compare it with the original capture ("tlb_capture.py compare"), to see what the library
+    sends differently.
+    *Bitmaps are drawn with the width of the workspace they were sent in, so their blocks match the captured ones.
+*/
+
+//Include the FIS library.
+#include <TLBFISLib.h>
+
+//Include the SPI library.
+#include <SPI.h>
+
+//Hardware configuration
+#define SPI_INSTANCE SPI
+#define ENA_PIN      9
+
+//Define the function to be called when the library needs to send a byte.
+void sendFunction(uint8_t data)
+{
+  SPI_INSTANCE.beginTransaction(SPISettings(125000, MSBFIRST, SPI_MODE3));
+  SPI_INSTANCE.transfer(data);
+  SPI_INSTANCE.endTransaction();
+}
+
+//Define the function to be called when the library is initialized by begin().
+void beginFunction()
+{
+  SPI_INSTANCE.begin();
+}
+
+//Create an instance of the FIS library.
+TLBFISLib FIS(ENA_PIN, sendFunction, beginFunction);
+
+%(arrays)s
+//Send the captured commands.
+void replay()
+{
+%(calls)s
+
+  //Send the text which is still waiting to be merged.
+  FIS.flush();
+}
+
+void setup() {
+  //Start the library and replay the capture once.
+  FIS.begin();
+  replay();
+}
+
+void loop() {
+  //Maintain the connection.
+  FIS.update();
+}
+"""
+
+
+def command_sketch(args):
+  calls, arrays = sketch_calls(load(args.capture, args))
+  sys.stdout.write(SKETCH_TEMPLATE % {
+    "capture": os.path.basename(args.capture),
+    "arrays": "".join(array + "\n\n" for array in arrays),
+    "calls": "\n".join("  " + call for call in calls),
+  })
+
+
+###COMMAND LINE
+
+def main():
+  parser = argparse.ArgumentParser(description="Decode, compare and replay captures of the 3LB bus.")
+  options = argparse.ArgumentParser(add_help=False)
+  options.add_argument("--format", choices=["auto", "lines", "bytes"], default="auto", help="capture format (default: detected from the header)")
+  options.add_argument("--clk", help="name or index of the CLK column")
+  options.add_argument("--data", help="name or index of the DATA column")
+  options.add_argument("--ena", help="name or index of the ENA column")
+  options.add_argument("--edge", choices=["rising", "falling"], default="rising", help="CLK edge on which DATA is sampled (default: rising)")
+  options.add_argument("--invert", action="store_true", help="invert every byte (if DATA is captured inverted)")
+  options.add_argument("--checksum", action="store_true", help="every block is followed by a checksum byte")
+  options.add_argument("--byte-gap", type=float, default=100, help="pause between two bits which starts a new byte (in microseconds, default: 100)")
+  options.add_argument("--block-gap", type=float, default=20000, help="pause which cuts off an incomplete block (in microseconds, default: 20000)")
+
+  commands = parser.add_subparsers(dest="command", required=True)
+
+  decode = commands.add_parser("decode", parents=[options], help="list every block, followed by a summary")
+  decode.add_argument("capture")
+  decode.set_defaults(function=command_decode)
+
+  stats = commands.add_parser("stats", parents=[options], help="show where the wire time goes")
+  stats.add_argument("capture")
+  stats.set_defaults(function=command_stats)
+
+  compare = commands.add_parser("compare", parents=[options], help="compare two captures")
+  compare.add_argument("capture")
+  compare.add_argument("other")
+  compare.add_argument("--limit", type=int, default=50, help="how many differing blocks to list (default: 50)")
+  compare.set_defaults(function=command_compare)
+
+  sketch = commands.add_parser("sketch", parents=[options], help="generate a sketch which replays the capture")
+  sketch.add_argument("capture")
+  sketch.set_defaults(function=command_sketch)
+
+  args = parser.parse_args()
+  args.function(args)
+
+
+if __name__ == "__main__":
+  main()
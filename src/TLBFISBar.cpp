@@ -0,0 +1,343 @@
+#include "TLBFISBar.h"
+
+/**
+  Function:
+    TLBFISBar(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t H, (lineOrientation orientation), (bool frame))
+  
+  Parameters:
+    fis           -> instance of the FIS library to draw with
+    X, Y          -> coordinates of the top-left corner of the bar (relative to the workspace)
+    W, H          -> dimensions of the bar
+    (orientation) -> direction in which the bar grows (HORIZONTAL = from left to right, VERTICAL = from bottom to top)
+    (frame)       -> whether or not to draw a border around the bar (with a 1-pixel gap between the border and the filled part)
+  
+  Default parameters:
+    (orientation = HORIZONTAL)
+    (frame = true)
+  
+  Description:
+    Creates a bar graph/progress bar.
+  
+  Notes:
+    *The bar remembers how many pixels are filled, so when the value changes, only the span between the old and the new level is sent, as a
+    single fill; the border and the tick marks are only drawn by draw().
+    *The workspace must be the same every time the bar is updated.
+*/
+TLBFISBar::TLBFISBar(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t H, TLBFISLib::lineOrientation orientation, bool frame) :
+  FIS(fis),
+  _X(X),
+  _Y(Y),
+  _W(W),
+  _H(H),
+  _orientation(orientation),
+  _inset(frame ? 2 : 0)
+{
+  //The filled part must be at least one pixel in both directions.
+  if (_W < 2 * _inset + 1) {
+    _W = 2 * _inset + 1;
+  }
+  if (_H < 2 * _inset + 1) {
+    _H = 2 * _inset + 1;
+  }
+  
+  _length = ((_orientation == TLBFISLib::HORIZONTAL) ? _W : _H) - 2 * _inset;
+}
+
+/**
+  Function:
+    setRange(int16_t min_value, int16_t max_value)
+  
+  Parameters:
+    min_value -> value displayed as an empty bar
+    max_value -> value displayed as a full bar
+  
+  Description:
+    Sets how values are scaled to the bar's length (values outside of the range are displayed as an empty/full bar).
+  
+  Notes:
+    *The level which is already displayed is not scaled again.
+*/
+void TLBFISBar::setRange(int16_t min_value, int16_t max_value)
+{
+  _min_value = min_value;
+  _max_value = max_value;
+}
+
+/**
+  Function:
+    setTicks(uint8_t divisions, (uint8_t length))
+  
+  Parameters:
+    divisions -> how many parts the tick marks divide the bar into (0 = no tick marks)
+    (length)  -> length of the tick marks (in pixels)
+  
+  Default parameters:
+    (length = 2)
+  
+  Description:
+    Sets the tick marks which are drawn outside of the bar: below it if it's HORIZONTAL, on its right if it's VERTICAL.
+  
+  Notes:
+    *There is a tick mark at each end of the bar, so there are (divisions + 1) tick marks.
+    *The tick marks are drawn by the next call to draw(), and never redrawn by setValue().
+*/
+void TLBFISBar::setTicks(uint8_t divisions, uint8_t length)
+{
+  _tick_divisions = divisions;
+  _tick_length = length ? length : 1;
+}
+
+/**
+  Function:
+    setValue(int16_t value)
+  
+  Parameters:
+    value -> the value to display
+  
+  Returns:
+    status -> SENT if the bar was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Changes the bar's level, turning on or off only the pixels between the old and the new level.
+  
+  Notes:
+    *If the bar is registered with TLBFISLib::addWidget(), the level is only sent by TLBFISLib::update().
+*/
+TLBFISLib::status TLBFISBar::setValue(int16_t value)
+{
+  uint8_t level = value_to_level(value);
+  
+  //If the level doesn't change, there is nothing to do.
+  if (_drawn && level == _target) {
+    return TLBFISLib::SENT;
+  }
+  _target = level;
+  
+  return request_refresh();
+}
+
+/**
+  Function:
+    refresh()
+  
+  Returns:
+    status -> SENT if the bar was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Turns on the span the bar grew by, or turns off the span it shrank by, with a single fill.
+*/
+TLBFISLib::status TLBFISBar::refresh()
+{
+  //If the screen doesn't match the state, draw everything.
+  if (!_drawn) {
+    return draw();
+  }
+  
+  //If the level doesn't change, there is nothing to do.
+  if (_target == _level) {
+    return TLBFISLib::SENT;
+  }
+  
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result;
+  if (_target > _level) {
+    result = fill_span(_level, _target, true);
+  }
+  else {
+    result = fill_span(_target, _level, false);
+  }
+  
+  //If it failed, the bar's content is unknown, so the entire bar will be drawn again (unless nothing was sent, see screen_untouched()).
+  if (result != TLBFISLib::SENT) {
+    _drawn = screen_untouched(FIS, blocks);
+    return result;
+  }
+  
+  _level = _target;
+  return result;
+}
+
+/**
+  Function:
+    draw()
+  
+  Returns:
+    status -> SENT if the bar was drawn, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Clears the bar's area and draws the border, the filled part and the tick marks again (for example after the screen was initialized).
+*/
+TLBFISLib::status TLBFISBar::draw()
+{
+  _drawn = false;
+  
+  //Draw the border (which clears the inside), or clear the entire area.
+  TLBFISLib::status result;
+  if (_inset) {
+    TLBFISLib::drawColor prev_color = FIS.getDrawColor();
+    FIS.setDrawColor(TLBFISLib::NORMAL);
+    result = FIS.drawRect(_X, _Y, _W, _H, TLBFISLib::NOT_FILLED);
+    FIS.setDrawColor(prev_color);
+  }
+  else {
+    result = fill(_X, _Y, _W, _H, false);
+  }
+  
+  //Draw the filled part.
+  _level = _target;
+  if (result == TLBFISLib::SENT && _level) {
+    result = fill_span(0, _level, true);
+  }
+  
+  //Draw the tick marks, spread evenly between the ends of the bar.
+  for (uint8_t i = 0; i <= _tick_divisions && _tick_divisions && result == TLBFISLib::SENT; i++) {
+    uint8_t position = (uint16_t)(_length - 1) * i / _tick_divisions;
+    if (_orientation == TLBFISLib::HORIZONTAL) {
+      result = fill(_X + _inset + position, _Y + _H, 1, _tick_length, true);
+    }
+    else {
+      result = fill(_X + _W, _Y + _H - 1 - _inset - position, _tick_length, 1, true);
+    }
+  }
+  
+  //The screen only matches the state if everything was sent.
+  _drawn = (result == TLBFISLib::SENT);
+  return result;
+}
+
+/**
+  Function:
+    invalidate()
+  
+  Description:
+    Makes the next update redraw the entire bar (for example after the screen was initialized).
+*/
+void TLBFISBar::invalidate()
+{
+  _drawn = false;
+  mark_dirty();
+}
+
+/**
+  Function:
+    getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the bar (output, relative to the workspace)
+    W, H -> dimensions of the bar, including the tick marks (output)
+  
+  Description:
+    Provides the area covered by the bar.
+*/
+void TLBFISBar::getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  X = _X;
+  Y = _Y;
+  W = _W;
+  H = _H;
+  
+  //The tick marks are below horizontal bars and on the right of vertical bars.
+  if (_tick_divisions) {
+    if (_orientation == TLBFISLib::HORIZONTAL) {
+      H += _tick_length;
+    }
+    else {
+      W += _tick_length;
+    }
+  }
+}
+
+/**
+  Function:
+    getLevel()
+  
+  Returns:
+    uint8_t -> how many pixels of the bar are filled
+  
+  Description:
+    Provides the bar's level, as it's displayed.
+*/
+uint8_t TLBFISBar::getLevel()
+{
+  return _level;
+}
+
+/**
+  Function:
+    value_to_level(int16_t value)
+  
+  Parameters:
+    value -> the value to convert
+  
+  Returns:
+    uint8_t -> how many pixels of the bar are filled for the value
+  
+  Description:
+    Scales a value to the bar's length, according to the range set by setRange().
+*/
+uint8_t TLBFISBar::value_to_level(int16_t value)
+{
+  //If the range is empty, display an empty bar.
+  if (_max_value <= _min_value || value <= _min_value) {
+    return 0;
+  }
+  if (value >= _max_value) {
+    return _length;
+  }
+  
+  //Scale the value, rounding to the nearest pixel.
+  int32_t range = (int32_t)_max_value - _min_value;
+  return (((int32_t)value - _min_value) * _length + range / 2) / range;
+}
+
+/**
+  Function:
+    fill_span(uint8_t from, uint8_t to, bool pixels_on)
+  
+  Parameters:
+    from      -> level where the span starts
+    to        -> level where the span ends (not included)
+    pixels_on -> whether to turn the pixels on (true) or off (false)
+  
+  Returns:
+    status -> SENT if the fill was sent, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Fills the part of the bar between two levels with a single rectangle, across the bar's entire width.
+*/
+TLBFISLib::status TLBFISBar::fill_span(uint8_t from, uint8_t to, bool pixels_on)
+{
+  //Horizontal bars grow to the right.
+  if (_orientation == TLBFISLib::HORIZONTAL) {
+    return fill(_X + _inset + from, _Y + _inset, to - from, _H - 2 * _inset, pixels_on);
+  }
+  
+  //Vertical bars grow upwards.
+  return fill(_X + _inset, _Y + _H - _inset - to, _W - 2 * _inset, to - from, pixels_on);
+}
+
+/**
+  Function:
+    fill(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on)
+  
+  Parameters:
+    X, Y      -> coordinates of the rectangle (relative to the workspace)
+    W, H      -> dimensions of the rectangle
+    pixels_on -> whether to turn the pixels on (true) or off (false)
+  
+  Returns:
+    status -> SENT if the fill was sent, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Fills a rectangle with a single command.
+*/
+TLBFISLib::status TLBFISBar::fill(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on)
+{
+  //Draw the rectangle with the required color, keeping the user's color afterwards.
+  TLBFISLib::drawColor prev_color = FIS.getDrawColor();
+  FIS.setDrawColor(pixels_on ? TLBFISLib::NORMAL : TLBFISLib::INVERTED);
+  TLBFISLib::status result = FIS.drawRect(X, Y, W, H, TLBFISLib::FILLED);
+  FIS.setDrawColor(prev_color);
+  
+  return result;
+}
@@ -0,0 +1,67 @@
+#ifndef TLBFISBar_h
+#define TLBFISBar_h
+
+#include "TLBFISWidget.h" //widget base class
+
+class TLBFISBar : public TLBFISWidget
+{
+  public:
+    //Constructor (the bar occupies the rectangle starting at X, Y, relative to the workspace)
+    TLBFISBar(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t H, TLBFISLib::lineOrientation orientation = TLBFISLib::HORIZONTAL, bool frame = true);
+    
+    //Set the values displayed as an empty and as a full bar
+    void setRange(int16_t min_value, int16_t max_value);
+    
+    //Set the tick marks drawn next to the bar
+    void setTicks(uint8_t divisions, uint8_t length = 2);
+    
+    //Set the value, sending only the part of the bar which changes
+    TLBFISLib::status setValue(int16_t value);
+    
+    //Redraw the entire bar
+    TLBFISLib::status draw();
+    
+    //Send the span between the displayed level and the value's level
+    TLBFISLib::status refresh();
+    
+    //Make the next update redraw the entire bar
+    void invalidate();
+    
+    //Get the area covered by the bar and its tick marks
+    void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Get how many pixels of the bar are filled
+    uint8_t getLevel();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Area of the bar (workspace coordinates)
+    uint8_t _X, _Y, _W, _H;
+    
+    //Settings
+    TLBFISLib::lineOrientation _orientation;
+    uint8_t _inset; //distance between the edge of the area and the filled part (2 with a frame, 0 without)
+    uint8_t _length; //how many pixels the bar can fill
+    int16_t _min_value = 0, _max_value = 100;
+    uint8_t _tick_divisions = 0, _tick_length = 2;
+    
+    //State
+    uint8_t _level = 0; //how many pixels are filled on the screen
+    uint8_t _target = 0; //how many pixels should be filled
+    bool _drawn = false; //set when the screen matches the level
+    
+    ///FUNCTIONS
+    
+    //Convert a value to the number of filled pixels
+    uint8_t value_to_level(int16_t value);
+    
+    //Fill the part of the bar between two levels
+    TLBFISLib::status fill_span(uint8_t from, uint8_t to, bool pixels_on);
+    
+    //Fill a rectangle
+    TLBFISLib::status fill(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on);
+};
+
+#endif
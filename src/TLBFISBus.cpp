@@ -0,0 +1,193 @@
+#include "TLBFISBus.h"
+
+/**
+  Function:
+    TLBFISBus((uint16_t slice_ms))
+  
+  Parameters:
+    (slice_ms) -> how long a block may wait for a cluster which isn't ready (in milliseconds, 0 = no limit)
+  
+  Default parameters:
+    (slice_ms = TLBFIS_BUS_SLICE)
+  
+  Description:
+    Creates a scheduler for several clusters connected to the same bus (each with its own ENA pin and TLBFISLib instance).
+  
+  Notes:
+    *The clusters take turns: every call to update() calls each cluster's update() once, starting with a different cluster every time, so the
+    widgets and queued bitmaps (see TLBFISLib::queueBitmap()) of all clusters are sent interleaved, a few blocks per turn.
+    *A cluster which doesn't accept a block within the slice gives up the rest of its turn; its widgets, queued bitmaps and text are sent again
+    in its next turn, so the other clusters don't have to wait for it.
+    *The slice only applies during the turns; drawing functions called directly by the sketch still wait according to TLBFISLib::setRetryPolicy().
+*/
+TLBFISBus::TLBFISBus(uint16_t slice_ms) :
+  _slice(slice_ms)
+{
+}
+
+/**
+  Function:
+    addCluster(TLBFISLib &fis)
+  
+  Parameters:
+    fis -> instance of the FIS library driving the cluster
+  
+  Description:
+    Registers a cluster, so that its connection is maintained by update().
+  
+  Notes:
+    *A cluster can only be registered on one bus, and must not be destroyed while it's registered.
+*/
+void TLBFISBus::addCluster(TLBFISLib &fis)
+{
+  //A cluster can't be on two buses.
+  if (fis._bus) {
+    return;
+  }
+  
+  //Add the cluster to the end of the list, so that clusters take turns in the order they were registered.
+  fis._bus = this;
+  fis._next_cluster = nullptr;
+  if (!_clusters) {
+    _clusters = &fis;
+  }
+  else {
+    TLBFISLib* last = _clusters;
+    while (last->_next_cluster) {
+      last = last->_next_cluster;
+    }
+    last->_next_cluster = &fis;
+  }
+}
+
+/**
+  Function:
+    removeCluster(TLBFISLib &fis)
+  
+  Parameters:
+    fis -> instance of the FIS library driving the cluster
+  
+  Description:
+    Unregisters a cluster; the sketch must call its update() again.
+*/
+void TLBFISBus::removeCluster(TLBFISLib &fis)
+{
+  if (fis._bus != this) {
+    return;
+  }
+  
+  //If the cluster was going to get the next turn, give it to the cluster after it.
+  if (_cursor == &fis) {
+    _cursor = fis._next_cluster;
+  }
+  
+  //Find the pointer to the cluster and make it skip the cluster.
+  TLBFISLib** link = &_clusters;
+  while (*link && *link != &fis) {
+    link = &(*link)->_next_cluster;
+  }
+  if (*link) {
+    *link = fis._next_cluster;
+  }
+  
+  fis._bus = nullptr;
+  fis._next_cluster = nullptr;
+}
+
+/**
+  Function:
+    getClusterCount()
+  
+  Returns:
+    uint8_t -> how many clusters are registered
+  
+  Description:
+    Provides the number of clusters driven by update().
+*/
+uint8_t TLBFISBus::getClusterCount()
+{
+  uint8_t count = 0;
+  for (TLBFISLib* cluster = _clusters; cluster; cluster = cluster->_next_cluster) {
+    count++;
+  }
+  return count;
+}
+
+/**
+  Function:
+    setSlice(uint16_t slice_ms)
+  
+  Parameters:
+    slice_ms -> how long a block may wait for a cluster which isn't ready (in milliseconds, 0 = no limit)
+  
+  Description:
+    Sets how long a cluster may keep the bus waiting before it gives up its turn.
+  
+  Notes:
+    *Blocks which are accepted right away are never interrupted, so a short slice only affects clusters which are busy or not responding.
+    *With no limit, a cluster which isn't ready holds up the entire bus, like when every cluster's update() is called by the sketch.
+    *Widgets which don't get to send anything before the cluster gives up its turn stay dirty, and are refreshed by its next turn without being
+    drawn again from scratch.
+*/
+void TLBFISBus::setSlice(uint16_t slice_ms)
+{
+  _slice = slice_ms;
+}
+
+/**
+  Function:
+    update()
+  
+  Description:
+    Gives every registered cluster a turn, maintaining its connection and sending its pending work.
+  
+  Notes:
+    *This function must be called during periods of inactivity, instead of the update() function of each cluster.
+*/
+void TLBFISBus::update()
+{
+  //Without clusters, there is nothing to do.
+  if (!_clusters) {
+    return;
+  }
+  
+  //Start with the cluster which was second in the previous call, so that no cluster is always served first.
+  TLBFISLib* first = _cursor ? _cursor : _clusters;
+  TLBFISLib* cluster = first;
+  do {
+    //Serve the cluster within the slice.
+    cluster->_bus_slice = _slice;
+    cluster->_bus_yielded = false;
+    cluster->update();
+    cluster->_bus_slice = 0;
+    cluster->_bus_yielded = false;
+    
+    //Move on to the next cluster, wrapping around at the end of the list.
+    cluster = cluster->_next_cluster ? cluster->_next_cluster : _clusters;
+  } while (cluster != first);
+  
+  _cursor = first->_next_cluster;
+}
+
+/**
+  Function:
+    msUntilNextUpdate()
+  
+  Returns:
+    unsigned long -> how long the sketch may wait before calling update() again (in milliseconds, 0 = right away, 0xFFFFFFFF = no clusters)
+  
+  Description:
+    Determines when any of the registered clusters has work to do next (see TLBFISLib::msUntilNextUpdate()).
+*/
+unsigned long TLBFISBus::msUntilNextUpdate()
+{
+  unsigned long remaining = 0xFFFFFFFF;
+  for (TLBFISLib* cluster = _clusters; cluster; cluster = cluster->_next_cluster) {
+    unsigned long cluster_remaining = cluster->msUntilNextUpdate();
+    if (cluster_remaining < remaining) {
+      remaining = cluster_remaining;
+    }
+  }
+  
+  return remaining;
+}
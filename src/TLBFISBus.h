@@ -0,0 +1,37 @@
+#ifndef TLBFISBus_h
+#define TLBFISBus_h
+
+#include "TLBFISLib.h" //FIS library
+
+class TLBFISBus
+{
+  public:
+    //Constructor
+    TLBFISBus(uint16_t slice_ms = TLBFIS_BUS_SLICE);
+    
+    //Register a cluster, to be driven by update()
+    void addCluster(TLBFISLib &fis);
+    //Unregister a cluster (its update() must be called by the sketch again)
+    void removeCluster(TLBFISLib &fis);
+    //Get the number of registered clusters
+    uint8_t getClusterCount();
+    
+    //Set how long a block may wait for a cluster which isn't ready, before the bus moves on to the next cluster (in milliseconds, 0 = no limit)
+    void setSlice(uint16_t slice_ms);
+    
+    //Maintain the connections, giving every cluster a turn
+    void update(); //must be called while not doing anything / waiting
+    
+    //Get how long the sketch may sleep before calling update() again (in milliseconds, 0 = call it right away)
+    unsigned long msUntilNextUpdate();
+  
+  private:
+    //Registry
+    TLBFISLib* _clusters = nullptr; //first registered cluster (each one points to the next)
+    TLBFISLib* _cursor = nullptr; //cluster which gets the first turn in the next call to update() (nullptr = the first one)
+    
+    //Settings
+    uint16_t _slice;
+};
+
+#endif
@@ -0,0 +1,375 @@
+#include "TLBFISChart.h"
+
+/**
+  Function:
+    TLBFISChart(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t H, (chartStyle chart_style))
+  
+  Parameters:
+    fis           -> instance of the FIS library to draw with
+    X, Y          -> coordinates of the top-left corner of the chart (relative to the workspace)
+    W, H          -> dimensions of the chart (at least 1, and the width is limited to TLBFIS_CHART_MAX_WIDTH)
+    (chart_style) -> how samples are displayed (LINE_CHART = connected points, BAR_CHART = bars filled from the bottom)
+  
+  Default parameters:
+    (chart_style = LINE_CHART)
+  
+  Description:
+    Creates a chart which displays one sample per column.
+  
+  Notes:
+    *The chart sweeps from left to right: every sample is drawn in the column after the previous one, wrapping around at the right edge, and the
+    column in front of the newest sample is kept empty to mark where the sweep is.
+    *This way, adding a sample only changes two columns, and only the part of each column which differs from what's displayed is sent, as a
+    single-pixel-wide fill; the rest of the chart is never redrawn.
+    *The workspace must be the same every time the chart is updated.
+    *Samples are always sent right away, since each one needs its own column; if the chart is registered with TLBFISLib::addWidget(),
+    TLBFISLib::update() redraws it after invalidate() (or initScreen()).
+*/
+TLBFISChart::TLBFISChart(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t H, chartStyle chart_style) :
+  FIS(fis),
+  _X(X),
+  _Y(Y),
+  _W(W ? ((W > TLBFIS_CHART_MAX_WIDTH) ? TLBFIS_CHART_MAX_WIDTH : W) : 1),
+  _H(H ? H : 1),
+  _style(chart_style)
+{
+  //All columns start empty.
+  memset(_span_top, 0xFF, sizeof(_span_top));
+  memset(_span_bottom, 0x00, sizeof(_span_bottom));
+}
+
+/**
+  Function:
+    setRange(int16_t min_value, int16_t max_value)
+  
+  Parameters:
+    min_value -> value displayed on the bottom row
+    max_value -> value displayed on the top row
+  
+  Description:
+    Sets how samples are scaled to the chart's height (values outside of the range are displayed on the bottom/top row).
+  
+  Notes:
+    *Samples which are already displayed are not scaled again.
+*/
+void TLBFISChart::setRange(int16_t min_value, int16_t max_value)
+{
+  _min_value = min_value;
+  _max_value = max_value;
+}
+
+/**
+  Function:
+    addSample(int16_t value)
+  
+  Parameters:
+    value -> the sample to add
+  
+  Returns:
+    status -> SENT if the chart was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Draws a sample in the next column, and clears the column after it.
+*/
+TLBFISLib::status TLBFISChart::addSample(int16_t value)
+{
+  //If the screen doesn't match the state, draw everything first.
+  if (!_drawn) {
+    TLBFISLib::status result = draw();
+    if (result != TLBFISLib::SENT) {
+      return result;
+    }
+  }
+  
+  uint8_t level = value_to_row(value);
+  
+  //Determine which rows of the column will be lit.
+  uint8_t top, bottom;
+  if (_style == BAR_CHART) {
+    //Bars are filled down to the bottom row.
+    top = level;
+    bottom = _H - 1;
+  }
+  else {
+    //Lines connect the sample to the previous one with a vertical span.
+    top = level;
+    bottom = level;
+    if (_last_level != 0xFF) {
+      if (_last_level < top) {
+        top = _last_level;
+      }
+      if (_last_level > bottom) {
+        bottom = _last_level;
+      }
+    }
+  }
+  
+  //Update the sample's column, exiting if it fails.
+  TLBFISLib::status result = update_column(_cursor, top, bottom);
+  if (result != TLBFISLib::SENT) {
+    return result;
+  }
+  
+  //Advance the cursor, wrapping around at the right edge.
+  _last_level = level;
+  _cursor = (_cursor + 1) % _W;
+  
+  //Clear the column in front of the newest sample, to mark where the sweep is.
+  if (_W > 1) {
+    result = update_column(_cursor, 0xFF, 0x00);
+  }
+  
+  return result;
+}
+
+/**
+  Function:
+    clear()
+  
+  Returns:
+    status -> SENT if the chart was cleared, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Forgets all samples and clears the chart's area.
+*/
+TLBFISLib::status TLBFISChart::clear()
+{
+  memset(_span_top, 0xFF, sizeof(_span_top));
+  memset(_span_bottom, 0x00, sizeof(_span_bottom));
+  _cursor = 0;
+  _last_level = 0xFF;
+  
+  return draw();
+}
+
+/**
+  Function:
+    draw()
+  
+  Returns:
+    status -> SENT if the chart was drawn, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Clears the chart's area and draws all columns again (for example after the screen was initialized).
+  
+  Notes:
+    *Neighboring columns displaying the same rows are drawn with a single fill.
+*/
+TLBFISLib::status TLBFISChart::draw()
+{
+  _drawn = false;
+  
+  //Clear the entire area, exiting if it fails.
+  TLBFISLib::drawColor prev_color = FIS.getDrawColor();
+  FIS.setDrawColor(TLBFISLib::INVERTED);
+  TLBFISLib::status result = FIS.drawRect(_X, _Y, _W, _H, TLBFISLib::FILLED);
+  FIS.setDrawColor(TLBFISLib::NORMAL);
+  
+  //Draw every column which isn't empty, grouping neighbors with the same span.
+  uint8_t column = 0;
+  while (column < _W && result == TLBFISLib::SENT) {
+    //Skip empty columns.
+    if (_span_top[column] > _span_bottom[column]) {
+      column++;
+      continue;
+    }
+    
+    uint8_t width = 1;
+    while (column + width < _W && _span_top[column + width] == _span_top[column] && _span_bottom[column + width] == _span_bottom[column]) {
+      width++;
+    }
+    
+    result = FIS.drawRect(_X + column, _Y + _span_top[column], width, _span_bottom[column] - _span_top[column] + 1, TLBFISLib::FILLED);
+    column += width;
+  }
+  
+  FIS.setDrawColor(prev_color);
+  
+  //The screen only matches the state if everything was sent.
+  _drawn = (result == TLBFISLib::SENT);
+  return result;
+}
+
+/**
+  Function:
+    invalidate()
+  
+  Description:
+    Makes the next sample redraw the entire chart (for example after the screen was initialized).
+*/
+void TLBFISChart::invalidate()
+{
+  _drawn = false;
+  mark_dirty();
+}
+
+/**
+  Function:
+    refresh()
+  
+  Returns:
+    status -> SENT if the chart is displayed, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Draws the entire chart if the screen doesn't match it; samples are already sent when they are added.
+*/
+TLBFISLib::status TLBFISChart::refresh()
+{
+  return _drawn ? TLBFISLib::SENT : draw();
+}
+
+/**
+  Function:
+    getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the chart (output, relative to the workspace)
+    W, H -> dimensions of the chart (output)
+  
+  Description:
+    Provides the area covered by the chart.
+*/
+void TLBFISChart::getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  X = _X;
+  Y = _Y;
+  W = _W;
+  H = _H;
+}
+
+/**
+  Function:
+    getCursor()
+  
+  Returns:
+    uint8_t -> column where the next sample will be drawn
+  
+  Description:
+    Provides the position of the sweep.
+*/
+uint8_t TLBFISChart::getCursor()
+{
+  return _cursor;
+}
+
+/**
+  Function:
+    value_to_row(int16_t value)
+  
+  Parameters:
+    value -> the value to convert
+  
+  Returns:
+    uint8_t -> the row where the value is displayed (0 = top)
+  
+  Description:
+    Scales a value to the chart's height, according to the range set by setRange().
+*/
+uint8_t TLBFISChart::value_to_row(int16_t value)
+{
+  //If the range is empty, display everything on the bottom row.
+  if (_max_value <= _min_value || value <= _min_value) {
+    return _H - 1;
+  }
+  if (value >= _max_value) {
+    return 0;
+  }
+  
+  //Scale the value, rounding to the nearest row.
+  int32_t range = (int32_t)_max_value - _min_value;
+  int32_t height = (((int32_t)value - _min_value) * (_H - 1) + range / 2) / range;
+  return (_H - 1) - height;
+}
+
+/**
+  Function:
+    update_column(uint8_t column, uint8_t top, uint8_t bottom)
+  
+  Parameters:
+    column -> the column to change
+    top    -> first row which will be lit (0xFF = empty column)
+    bottom -> last row which will be lit
+  
+  Returns:
+    status -> SENT if the column was updated, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Changes the rows lit in a column, turning off only the rows which are no longer lit and turning on only the rows which weren't lit.
+*/
+TLBFISLib::status TLBFISChart::update_column(uint8_t column, uint8_t top, uint8_t bottom)
+{
+  uint8_t old_top = _span_top[column], old_bottom = _span_bottom[column];
+  bool was_empty = (old_top > old_bottom);
+  bool is_empty = (top > bottom);
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result = TLBFISLib::SENT;
+  
+  //If the column doesn't change, there is nothing to do.
+  if ((was_empty && is_empty) || (top == old_top && bottom == old_bottom)) {
+    return TLBFISLib::SENT;
+  }
+  
+  if (was_empty) {
+    //Turn on the new span.
+    result = fill_column(column, top, bottom, true);
+  }
+  else if (is_empty) {
+    //Turn off the old span.
+    result = fill_column(column, old_top, old_bottom, false);
+  }
+  else if (bottom == old_bottom) {
+    //Spans ending on the same row (bars) only differ at the top.
+    if (top < old_top) {
+      result = fill_column(column, top, old_top - 1, true);
+    }
+    else {
+      result = fill_column(column, old_top, top - 1, false);
+    }
+  }
+  else {
+    //Turn off the old span, unless the new one covers it entirely, then turn on the new span.
+    if (old_top < top || old_bottom > bottom) {
+      result = fill_column(column, old_top, old_bottom, false);
+    }
+    if (result == TLBFISLib::SENT) {
+      result = fill_column(column, top, bottom, true);
+    }
+  }
+  
+  //If it failed, the column's content is unknown, so the entire chart will be drawn again (unless nothing was sent, see screen_untouched()).
+  if (result != TLBFISLib::SENT) {
+    _drawn = screen_untouched(FIS, blocks);
+    return result;
+  }
+  
+  _span_top[column] = top;
+  _span_bottom[column] = bottom;
+  return result;
+}
+
+/**
+  Function:
+    fill_column(uint8_t column, uint8_t top, uint8_t bottom, bool pixels_on)
+  
+  Parameters:
+    column    -> the column to fill
+    top       -> first row to fill
+    bottom    -> last row to fill
+    pixels_on -> whether to turn the pixels on (true) or off (false)
+  
+  Returns:
+    status -> SENT if the fill was sent, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Fills a part of a column with a single one-pixel-wide rectangle.
+*/
+TLBFISLib::status TLBFISChart::fill_column(uint8_t column, uint8_t top, uint8_t bottom, bool pixels_on)
+{
+  //Draw the rectangle with the required color, keeping the user's color afterwards.
+  TLBFISLib::drawColor prev_color = FIS.getDrawColor();
+  FIS.setDrawColor(pixels_on ? TLBFISLib::NORMAL : TLBFISLib::INVERTED);
+  TLBFISLib::status result = FIS.drawRect(_X + column, _Y + top, 1, bottom - top + 1, TLBFISLib::FILLED);
+  FIS.setDrawColor(prev_color);
+  
+  return result;
+}
@@ -0,0 +1,74 @@
+#ifndef TLBFISChart_h
+#define TLBFISChart_h
+
+#include "TLBFISWidget.h" //widget base class
+
+#define TLBFIS_CHART_MAX_WIDTH 64 //how many columns (samples) a chart can have
+
+class TLBFISChart : public TLBFISWidget
+{
+  public:
+    //Chart styles
+    enum chartStyle {
+      LINE_CHART,
+      BAR_CHART
+    };
+    
+    //Constructor (the chart occupies the rectangle starting at X, Y, relative to the workspace)
+    TLBFISChart(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t H, chartStyle chart_style = LINE_CHART);
+    
+    //Set the values displayed at the bottom and at the top of the chart
+    void setRange(int16_t min_value, int16_t max_value);
+    
+    //Add a sample, updating only the affected columns
+    TLBFISLib::status addSample(int16_t value);
+    
+    //Clear the chart and forget all samples
+    TLBFISLib::status clear();
+    
+    //Redraw the entire chart
+    TLBFISLib::status draw();
+    
+    //Draw the entire chart, if the screen doesn't match it
+    TLBFISLib::status refresh();
+    
+    //Make the next update redraw the entire chart
+    void invalidate();
+    
+    //Get the area covered by the chart
+    void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Get the column where the next sample will be drawn
+    uint8_t getCursor();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Area of the chart (workspace coordinates)
+    uint8_t _X, _Y, _W, _H;
+    
+    //Settings
+    chartStyle _style;
+    int16_t _min_value = 0, _max_value = 100;
+    
+    //State
+    uint8_t _span_top[TLBFIS_CHART_MAX_WIDTH]; //first lit row of each column (0xFF = empty column)
+    uint8_t _span_bottom[TLBFIS_CHART_MAX_WIDTH]; //last lit row of each column
+    uint8_t _cursor = 0; //column where the next sample will be drawn
+    uint8_t _last_level = 0xFF; //row of the previous sample (0xFF = none)
+    bool _drawn = false; //set when the screen matches the spans above
+    
+    ///FUNCTIONS
+    
+    //Convert a value to the row where it's displayed
+    uint8_t value_to_row(int16_t value);
+    
+    //Change what a column displays, sending only the difference
+    TLBFISLib::status update_column(uint8_t column, uint8_t top, uint8_t bottom);
+    
+    //Fill a part of a column
+    TLBFISLib::status fill_column(uint8_t column, uint8_t top, uint8_t bottom, bool pixels_on);
+};
+
+#endif
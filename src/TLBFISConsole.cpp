@@ -0,0 +1,560 @@
+#include "TLBFISConsole.h"
+
+/**
+  Function:
+    TLBFISConsole(TLBFISLib &fis, (uint8_t X), (uint8_t Y), (uint8_t W), (uint8_t H), (TLBFISLib::font text_font))
+  
+  Parameters:
+    fis         -> instance of the FIS library to draw with
+    (X, Y)      -> coordinates of the top-left corner of the console (on the screen, like for setWorkspace())
+    (W, H)      -> dimensions of the console (in pixels)
+    (text_font) -> font used for the lines (STANDARD/COMPACT/GRAPHICS)
+  
+  Default parameters:
+    (X = 0)
+    (Y = 0)
+    (W = 64)
+    (H = 48)
+    (text_font = COMPACT)
+  
+  Description:
+    Creates a console which displays the last lines of text printed to it, like a terminal.
+  
+  Notes:
+    *Lines are spaced like in writeMultiLineText(), according to setLineSpacing() at the time the console is drawn entirely.
+    *Text is converted to the cluster's character set once, when it's printed; when the console scrolls, every row is compared to the line
+    which moves onto it, and only the characters after the part they have in common are sent again.
+    *The console's area is used as the workspace while drawing; if the workspace is already set to it, no workspace commands are sent.
+    *The text settings and draw color are changed while drawing and restored afterwards.
+*/
+TLBFISConsole::TLBFISConsole(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t H, TLBFISLib::font text_font) :
+  FIS(fis),
+  _X(X),
+  _Y(Y),
+  _W(W ? W : 1),
+  _H(H),
+  _font(text_font)
+{
+  //All lines start empty.
+  memset(_lengths, 0, sizeof(_lengths));
+  memset(_widths, 0, sizeof(_widths));
+  memset(_shown_length, 0, sizeof(_shown_length));
+  memset(_shown_width, 0, sizeof(_shown_width));
+}
+
+/**
+  Function:
+    print(const char message[], (bool fromPGM))
+  
+  Parameters:
+    message[] -> the text to append
+    (fromPGM) -> whether or not the string is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Returns:
+    status -> SENT if the console was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Appends text to the last line, starting a new line for every '\n' and when a line is full.
+  
+  Notes:
+    *The screen is only updated once, after all of the text was added.
+    *If the console is registered with TLBFISLib::addWidget(), the screen is only updated by TLBFISLib::update().
+    *LINE_CLEAR is skipped, since it would clear the rest of the row.
+*/
+TLBFISLib::status TLBFISConsole::print(const char* message, bool fromPGM)
+{
+  append(message, fromPGM);
+  
+  //Send the rows which changed, or everything if the screen doesn't match.
+  return request_refresh();
+}
+
+/**
+  Function:
+    println(const char message[], (bool fromPGM))
+  
+  Parameters:
+    message[] -> the text to append
+    (fromPGM) -> whether or not the string is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Returns:
+    status -> SENT if the console was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Appends text to the last line, then starts a new line.
+*/
+TLBFISLib::status TLBFISConsole::println(const char* message, bool fromPGM)
+{
+  //Add the text and the newline before updating the screen, so that it's only updated once.
+  append(message, fromPGM);
+  append("\n");
+  
+  return request_refresh();
+}
+
+/**
+  Function:
+    clear()
+  
+  Returns:
+    status -> SENT if the console was cleared, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Forgets all lines and clears the console's area.
+*/
+TLBFISLib::status TLBFISConsole::clear()
+{
+  _head = 0;
+  _used = 1;
+  _lengths[_head] = 0;
+  _widths[_head] = 0;
+  
+  //Everything is drawn again.
+  _drawn = false;
+  return request_refresh();
+}
+
+/**
+  Function:
+    draw()
+  
+  Returns:
+    status -> SENT if the console was drawn, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Clears the console's area and draws all lines again (for example after the screen was initialized or the line spacing was changed).
+*/
+TLBFISLib::status TLBFISConsole::draw()
+{
+  _drawn = false;
+  set_metrics();
+  
+  //Enter and clear the console's area; nothing is displayed afterwards.
+  TLBFISLib::status result = enter_area(true);
+  memset(_shown_length, 0, sizeof(_shown_length));
+  memset(_shown_width, 0, sizeof(_shown_width));
+  
+  for (uint8_t row = 0; row < _used && result == TLBFISLib::SENT; row++) {
+    result = draw_row(row);
+  }
+  
+  //Send the last row right away, instead of waiting for following text.
+  if (result == TLBFISLib::SENT) {
+    result = FIS.flush();
+  }
+  
+  //Restore the workspace and the settings, even if something failed.
+  TLBFISLib::status leave_result = leave_area();
+  if (result == TLBFISLib::SENT) {
+    result = leave_result;
+  }
+  
+  _drawn = (result == TLBFISLib::SENT);
+  return result;
+}
+
+/**
+  Function:
+    invalidate()
+  
+  Description:
+    Makes the next update redraw the entire console (for example after the screen was initialized).
+*/
+void TLBFISConsole::invalidate()
+{
+  _drawn = false;
+  mark_dirty();
+}
+
+/**
+  Function:
+    getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the console (output, on the screen)
+    W, H -> dimensions of the console (output)
+  
+  Description:
+    Provides the area covered by the console.
+*/
+void TLBFISConsole::getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  X = _X;
+  Y = _Y;
+  W = _W;
+  H = _H;
+}
+
+/**
+  Function:
+    getRowCount()
+  
+  Returns:
+    uint8_t -> how many lines the console can display
+  
+  Description:
+    Provides the number of rows which fit in the console's area, with the current line spacing.
+*/
+uint8_t TLBFISConsole::getRowCount()
+{
+  if (!_drawn) {
+    set_metrics();
+  }
+  
+  return _rows;
+}
+
+/**
+  Function:
+    slot(uint8_t row)
+  
+  Parameters:
+    row -> the row whose line to find
+  
+  Returns:
+    uint8_t -> index of the line in the buffer
+  
+  Description:
+    Finds where the line displayed on a row is stored.
+*/
+uint8_t TLBFISConsole::slot(uint8_t row)
+{
+  return (_head + row) % TLBFIS_CONSOLE_MAX_ROWS;
+}
+
+/**
+  Function:
+    set_metrics()
+  
+  Description:
+    Calculates the distance between lines and how many of them fit in the console's area, dropping the oldest lines if they no longer fit.
+*/
+void TLBFISConsole::set_metrics()
+{
+  //Lines are spaced the same way as in writeMultiLineText().
+  uint8_t spacing = (_font == TLBFISLib::GRAPHICS) ? 0 : FIS.getLineSpacing();
+  _pitch = 7 + spacing;
+  
+  //The spacing isn't needed after the last row.
+  uint8_t rows = (_H + spacing) / _pitch;
+  if (!rows) {
+    rows = 1;
+  }
+  if (rows > TLBFIS_CONSOLE_MAX_ROWS) {
+    rows = TLBFIS_CONSOLE_MAX_ROWS;
+  }
+  _rows = rows;
+  
+  //Keep the newest lines.
+  if (_used > _rows) {
+    _head = slot(_used - _rows);
+    _used = _rows;
+  }
+}
+
+/**
+  Function:
+    append(const char message[], (bool fromPGM))
+  
+  Parameters:
+    message[] -> the text to add
+    (fromPGM) -> whether or not the string is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Description:
+    Converts and adds text to the lines, without updating the screen.
+*/
+void TLBFISConsole::append(const char* message, bool fromPGM)
+{
+  //The rows must be known before adding lines.
+  if (!_drawn) {
+    set_metrics();
+  }
+  
+  //Characters are converted and measured for the console's font.
+  TLBFISLib::font prev_font = FIS.getFont();
+  FIS.setFont(_font);
+  
+  uint8_t character;
+  while ((character = (fromPGM ? pgm_read_byte_near(message) : *message))) {
+    add_char(character);
+    message++;
+  }
+  
+  FIS.setFont(prev_font);
+}
+
+/**
+  Function:
+    add_char(uint8_t character)
+  
+  Parameters:
+    character -> the character to add
+  
+  Description:
+    Converts a character and adds it to the line being printed, starting a new line first if it doesn't fit.
+*/
+void TLBFISConsole::add_char(uint8_t character)
+{
+  if (character == '\n') {
+    new_line();
+    return;
+  }
+  
+  //Skip characters which aren't drawn, or which clear the rest of the line.
+  uint8_t width = FIS.charWidth(character);
+  if (character == '\r' || !width || width > 6 || width > _W) {
+    return;
+  }
+  
+  //Wrap long lines.
+  uint8_t line = slot(_used - 1);
+  if (_widths[line] + width > _W || _lengths[line] == TLBFIS_CONSOLE_MAX_COLUMNS) {
+    new_line();
+    line = slot(_used - 1);
+  }
+  
+  _lines[line][_lengths[line]] = FIS.encodeChar(character);
+  _char_widths[line][_lengths[line]] = width;
+  _lengths[line]++;
+  _widths[line] += width;
+}
+
+/**
+  Function:
+    new_line()
+  
+  Description:
+    Starts a new line, scrolling the others up if the console is full.
+  
+  Notes:
+    *When scrolling, every row keeps the characters it has in common with the line moving onto it, so that they aren't sent again.
+*/
+void TLBFISConsole::new_line()
+{
+  //If there is an empty row, use it.
+  if (_used < _rows) {
+    uint8_t line = slot(_used);
+    _lengths[line] = 0;
+    _widths[line] = 0;
+    _used++;
+    return;
+  }
+  
+  //Compare the part displayed on each row with the line which will be displayed there.
+  for (uint8_t row = 0; row + 1 < _rows; row++) {
+    uint8_t current = slot(row), next = slot(row + 1);
+    uint8_t common = (_shown_length[row] < _lengths[next]) ? _shown_length[row] : _lengths[next];
+    
+    uint8_t length = 0;
+    while (length < common && _lines[current][length] == _lines[next][length]) {
+      length++;
+    }
+    _shown_length[row] = length;
+  }
+  
+  //The last row will display a new, empty line.
+  _shown_length[_rows - 1] = 0;
+  _head = slot(1);
+  
+  uint8_t line = slot(_rows - 1);
+  _lengths[line] = 0;
+  _widths[line] = 0;
+}
+
+/**
+  Function:
+    refresh()
+  
+  Returns:
+    status -> SENT if the rows were updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Sends the rows which don't match their lines, entering the console's area only if there is anything to send.
+*/
+TLBFISLib::status TLBFISConsole::refresh()
+{
+  //If the screen doesn't match the lines, draw everything.
+  if (!_drawn) {
+    return draw();
+  }
+  
+  //Find out if any row needs to be updated.
+  bool changed = false;
+  for (uint8_t row = 0; row < _rows && !changed; row++) {
+    uint8_t line = slot(row);
+    uint8_t length = (row < _used) ? _lengths[line] : 0;
+    uint8_t width = (row < _used) ? _widths[line] : 0;
+    changed = (_shown_length[row] != length || _shown_width[row] > width);
+  }
+  
+  if (!changed) {
+    return TLBFISLib::SENT;
+  }
+  
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result = enter_area();
+  for (uint8_t row = 0; row < _rows && result == TLBFISLib::SENT; row++) {
+    result = draw_row(row);
+  }
+  
+  //Send the last row right away, instead of waiting for following text.
+  if (result == TLBFISLib::SENT) {
+    result = FIS.flush();
+  }
+  
+  //Restore the workspace and the settings, even if something failed.
+  TLBFISLib::status leave_result = leave_area();
+  if (result == TLBFISLib::SENT) {
+    result = leave_result;
+  }
+  
+  //If nothing was sent (see screen_untouched()), the rows which weren't updated are still known.
+  _drawn = (result == TLBFISLib::SENT || screen_untouched(FIS, blocks));
+  return result;
+}
+
+/**
+  Function:
+    draw_row(uint8_t row)
+  
+  Parameters:
+    row -> the row to update
+  
+  Returns:
+    status -> SENT if the row was updated, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Sends the characters of the row's line which aren't displayed correctly, then clears whatever remains after the end of the line.
+  
+  Notes:
+    *With the COMPACT font, the rest of the row is cleared by adding LINE_CLEAR to the same text command; other fonts need a separate fill.
+*/
+TLBFISLib::status TLBFISConsole::draw_row(uint8_t row)
+{
+  uint8_t line = slot(row);
+  uint8_t length = (row < _used) ? _lengths[line] : 0;
+  uint8_t width = (row < _used) ? _widths[line] : 0;
+  uint8_t shown = _shown_length[row];
+  bool clear_rest = (_shown_width[row] > width);
+  
+  //If the row matches its line, there is nothing to do.
+  if (shown == length && !clear_rest) {
+    return TLBFISLib::SENT;
+  }
+  
+  //The characters which are displayed correctly are skipped.
+  uint8_t startX = 0;
+  for (uint8_t i = 0; i < shown; i++) {
+    startX += _char_widths[line][i];
+  }
+  uint8_t startY = row * _pitch;
+  
+  uint8_t text[TLBFIS_CONSOLE_MAX_COLUMNS + 1];
+  uint8_t text_length = length - shown;
+  memcpy(text, _lines[line] + shown, text_length);
+  
+  //With the COMPACT font, LINE_CLEAR (character 5) clears the rest of the row.
+  bool line_clear = clear_rest && _font == TLBFISLib::COMPACT;
+  if (line_clear) {
+    text[text_length++] = FIS.encodeChar(5);
+  }
+  
+  TLBFISLib::status result = TLBFISLib::SENT;
+  if (text_length) {
+    result = FIS.writeEncodedText(startX, startY, text_length, text, line_clear ? (_W - startX) : (width - startX));
+  }
+  
+  //With the other fonts, clear the rest of the row with a fill.
+  if (result == TLBFISLib::SENT && clear_rest && !line_clear) {
+    FIS.setDrawColor(TLBFISLib::INVERTED);
+    result = FIS.drawRect(width, startY, _shown_width[row] - width, 7, TLBFISLib::FILLED);
+    FIS.setDrawColor(TLBFISLib::NORMAL);
+  }
+  
+  if (result == TLBFISLib::SENT) {
+    _shown_length[row] = length;
+    _shown_width[row] = width;
+  }
+  
+  return result;
+}
+
+/**
+  Function:
+    enter_area((bool clear))
+  
+  Parameters:
+    (clear) -> whether or not to clear the console's area
+  
+  Default parameters:
+    (clear = false)
+  
+  Returns:
+    status -> SENT if the workspace was set, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Saves the workspace, the text settings and the draw color, then sets the workspace to the console's area (unless it already is) and
+    selects the settings used by the console.
+*/
+TLBFISLib::status TLBFISConsole::enter_area(bool clear)
+{
+  //Save and replace the text settings and the draw color.
+  _saved_font = FIS.getFont();
+  _saved_transparency = FIS.getTextTransparency();
+  _saved_alignment = FIS.getTextAlignment();
+  _saved_color = FIS.getDrawColor();
+  FIS.setFont(_font);
+  FIS.setTextTransparency(TLBFISLib::OPAQUE);
+  FIS.setTextAlignment(TLBFISLib::LEFT);
+  FIS.setDrawColor(TLBFISLib::NORMAL);
+  
+  //Save the current workspace.
+  _saved_X = FIS.getWorkspaceX();
+  _saved_Y = FIS.getWorkspaceY();
+  _saved_W = FIS.getWorkspaceWidth();
+  _saved_H = FIS.getWorkspaceHeight();
+  
+  //If it's already the console's area, it only needs to be cleared (if requested).
+  if (_saved_X == _X && _saved_Y == _Y && _saved_W == _W && _saved_H == _H) {
+    _clipped = false;
+    return clear ? FIS.clear() : TLBFISLib::SENT;
+  }
+  
+  _clipped = true;
+  return FIS.setWorkspace(_X, _Y, _W, _H, clear);
+}
+
+/**
+  Function:
+    leave_area()
+  
+  Returns:
+    status -> SENT if the workspace was restored, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Restores the text settings, the draw color and the workspace which were saved by enter_area().
+*/
+TLBFISLib::status TLBFISConsole::leave_area()
+{
+  FIS.setFont(_saved_font);
+  FIS.setTextTransparency(_saved_transparency);
+  FIS.setTextAlignment(_saved_alignment);
+  FIS.setDrawColor(_saved_color);
+  
+  //If the workspace wasn't changed, there is nothing else to do.
+  if (!_clipped) {
+    return TLBFISLib::SENT;
+  }
+  
+  _clipped = false;
+  return FIS.setWorkspace(_saved_X, _saved_Y, _saved_W, _saved_H);
+}
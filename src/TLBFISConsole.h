@@ -0,0 +1,96 @@
+#ifndef TLBFISConsole_h
+#define TLBFISConsole_h
+
+#include "TLBFISWidget.h" //widget base class
+
+#define TLBFIS_CONSOLE_MAX_ROWS    11 //how many lines a console can display (FULLSCREEN, with the default line spacing)
+#define TLBFIS_CONSOLE_MAX_COLUMNS 20 //how many characters a line can have
+
+class TLBFISConsole : public TLBFISWidget
+{
+  public:
+    //Constructor (the console occupies the rectangle starting at X, Y)
+    TLBFISConsole(TLBFISLib &fis, uint8_t X = 0, uint8_t Y = 0, uint8_t W = 64, uint8_t H = 48, TLBFISLib::font text_font = TLBFISLib::COMPACT);
+    
+    //Append text (newlines start a new line, the oldest line scrolls off when the console is full)
+    TLBFISLib::status print(const char* message, bool fromPGM = false);
+    //Append text, then start a new line
+    TLBFISLib::status println(const char* message, bool fromPGM = false);
+    
+    //Forget all lines and clear the console
+    TLBFISLib::status clear();
+    
+    //Redraw the entire console
+    TLBFISLib::status draw();
+    
+    //Send the rows which don't match their lines
+    TLBFISLib::status refresh();
+    
+    //Make the next update redraw the entire console
+    void invalidate();
+    
+    //Get the area covered by the console
+    void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Get the number of lines the console can display
+    uint8_t getRowCount();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Area of the console (screen coordinates)
+    uint8_t _X, _Y, _W, _H;
+    
+    //Settings
+    TLBFISLib::font _font;
+    uint8_t _rows = 1; //how many lines fit in the area
+    uint8_t _pitch = 8; //distance between the tops of two lines
+    
+    //Lines, in the cluster's character set (circular buffer, _head is the line on the first row)
+    uint8_t _lines[TLBFIS_CONSOLE_MAX_ROWS][TLBFIS_CONSOLE_MAX_COLUMNS];
+    uint8_t _char_widths[TLBFIS_CONSOLE_MAX_ROWS][TLBFIS_CONSOLE_MAX_COLUMNS]; //width of each character (in pixels)
+    uint8_t _lengths[TLBFIS_CONSOLE_MAX_ROWS];
+    uint8_t _widths[TLBFIS_CONSOLE_MAX_ROWS]; //width of each line (in pixels)
+    uint8_t _head = 0;
+    uint8_t _used = 1; //how many rows contain a line (the last one is the line being printed)
+    
+    //What each row displays
+    uint8_t _shown_length[TLBFIS_CONSOLE_MAX_ROWS]; //how many characters at the start of the row's line are displayed correctly
+    uint8_t _shown_width[TLBFIS_CONSOLE_MAX_ROWS]; //how far the displayed pixels may reach (in pixels)
+    bool _drawn = false; //set when the arrays above match the screen
+    
+    //Workspace which was set before the console started drawing
+    uint8_t _saved_X, _saved_Y, _saved_W, _saved_H;
+    bool _clipped = false; //set while the workspace is not the one the console was entered with
+    
+    //Text settings which were set before the console started drawing
+    TLBFISLib::font _saved_font;
+    TLBFISLib::transparency _saved_transparency;
+    TLBFISLib::alignment _saved_alignment;
+    TLBFISLib::drawColor _saved_color;
+    
+    ///FUNCTIONS
+    
+    //Get the buffer index of the line on a row
+    uint8_t slot(uint8_t row);
+    
+    //Calculate how many rows fit in the area, according to the line spacing
+    void set_metrics();
+    
+    //Add text to the lines, without updating the screen
+    void append(const char* message, bool fromPGM = false);
+    //Add a character to the line being printed
+    void add_char(uint8_t character);
+    //Start a new line, scrolling if the console is full
+    void new_line();
+    
+    //Send the part of a row which doesn't match its line
+    TLBFISLib::status draw_row(uint8_t row);
+    
+    //Manage the workspace and text settings
+    TLBFISLib::status enter_area(bool clear = false);
+    TLBFISLib::status leave_area();
+};
+
+#endif
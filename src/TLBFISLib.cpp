@@ -1,4 +1,6 @@
 #include "TLBFISLib.h"
+#include "TLBFISWidget.h" //widgets refreshed by update()
+#include "TLBFISQueue.h" //blocks transmitted by another task
 
 /**
   Function:
@@ -26,12 +28,327 @@ TLBFISLib::TLBFISLib(uint8_t ENA_pin, TLBLib::sendFunction_type sendFunction, TL
   
   Description:
     Sets a function to be executed when an error is detected.
+  
+  Notes:
+    *The function is executed by update(); with a submission queue (see submissionQueue()), it must not draw.
 */
 void TLBFISLib::errorFunction(TLBLib::errorFunction_type function)
 {
   TLB.errorFunction(function);
 }
 
+/**
+  Function:
+    blockSendFunction(blockSendFunction_type function, uint8_t buffer[])
+  
+  Parameters:
+    function -> function to be executed for transmitting a block ("void blockSendFunction(const uint8_t* data, uint8_t length)")
+    buffer[] -> a buffer of at least TLB_MAX_BYTES_PER_BLOCK bytes, which will hold the block while it's being transmitted
+  
+  Description:
+    Sets a function which transmits entire blocks at once (for example by DMA), instead of the library calling sendFunction for every byte.
+  
+  Notes:
+    *The function replaces TLBLib::send() for the blocks of the drawing functions, so it must do everything that function does for a block: take the bus
+    with the ENA handshake, transmit the "length" bytes of "data" (command byte, length byte and the rest of the command) with the framing the TLB
+    library adds, and read the cluster's answer.
+    *It may return before the transfer ends; once the cluster has answered, blockSendComplete() must be called (from the function itself, another task or
+    an interrupt) with the answer TLBLib::send() would have returned: SUCCESS if the block was accepted, REPEAT if the cluster wasn't ready, FAIL if it
+    reported an error (blockSendComplete(true/false) can be used if REPEAT and FAIL can't be told apart).
+    *The function must not retry by itself: the library gives it the same block again after REPEAT and FAIL answers, until the cluster accepts it or the
+    retry policy gives up (see setRetryPolicy(); only FAIL answers count as errors).
+    *The drawing function which started the transfer returns as soon as the block is handed over, so the next block is encoded while this one is
+    transmitted; the answer is waited for (calling yield(), so the transfer can be completed by another task) by the next call which uses the bus:
+    the next block, flush(), update(), turnOff() or end(). REPEAT and FAIL answers are also handled there.
+    *So a block which is given up on (see setRetryPolicy()) is reported by that next call, which returns FAILED or TIMED_OUT without sending its own
+    block; call flush() to find out whether the last block of a drawing function was accepted.
+    *"data" points to the buffer given here, which holds the block until the answer arrives, so it must not be used for anything else (on some
+    platforms, like the ESP32, it must also be allocated in DMA-capable memory).
+    *Keepalive messages are still sent byte-by-byte by update() with the TLB library, after the transfer has ended.
+    *Passing nullptr as the function returns to byte-by-byte transmission.
+    *See the 27.Block_send example.
+*/
+void TLBFISLib::blockSendFunction(blockSendFunction_type function, uint8_t* buffer)
+{
+  //Let the current transfer finish before changing the function.
+  wait_block_send();
+  
+  //Both the function and the buffer are needed.
+  if (!function || !buffer) {
+    _block_send_function = nullptr;
+    _block_buffer = nullptr;
+    return;
+  }
+  
+  _block_send_function = function;
+  _block_buffer = buffer;
+}
+
+/**
+  Function:
+    blockSendComplete(bool success)
+  
+  Parameters:
+    success -> whether or not the block was transmitted successfully
+  
+  Default parameters:
+    success = true
+  
+  Description:
+    Notifies the library that the transfer started by the block send function has finished.
+  
+  Notes:
+    *This function can be called from an interrupt (for example a DMA completion interrupt).
+    *A failed transfer is treated like a FAIL answer (see blockSendComplete(TLBLib::sendStatus answer)).
+*/
+void TLBFISLib::blockSendComplete(bool success)
+{
+  blockSendComplete(success ? TLBLib::SUCCESS : TLBLib::FAIL);
+}
+
+/**
+  Function:
+    blockSendComplete(TLBLib::sendStatus answer)
+  
+  Parameters:
+    answer -> the cluster's answer to the block (SUCCESS, REPEAT or FAIL), as returned by TLBLib::send()
+  
+  Description:
+    Notifies the library that the cluster has answered the block given to the block send function.
+  
+  Notes:
+    *This function can be called from an interrupt (for example a DMA completion interrupt).
+    *After REPEAT or FAIL, the block is given to the block send function again, according to the retry policy (see setRetryPolicy()).
+*/
+void TLBFISLib::blockSendComplete(TLBLib::sendStatus answer)
+{
+  _block_answer = answer;
+  _block_busy = false;
+}
+
+/**
+  Function:
+    submissionQueue(TLBFISQueue* queue)
+  
+  Parameters:
+    queue -> the queue which will hold the blocks until they are transmitted (nullptr = transmit them right away again)
+  
+  Description:
+    Separates drawing from transmitting, so that they can run in different tasks (for example under FreeRTOS): the drawing functions only encode
+    the blocks and add them to the queue, and update(), called by the task which owns the bus, transmits them.
+  
+  Notes:
+    *The task which draws must call updateWidgets() instead of update(), and must be the only one using the drawing functions; update() must only be
+    called by the other task.
+    *Drawing functions return SENT as soon as their blocks are queued; they only wait (according to setRetryPolicy()) while the queue is full.
+    *Blocks which the cluster rejects too many times (see setRetryPolicy()) are dropped by update() without the drawing task being notified.
+    *begin(), end() and turnOff() use the bus directly, so they should be called while the other task isn't running update().
+    *The error function (see errorFunction()) is executed by the TLB library from update(), so it runs in the task which transmits: it must not call
+    initScreen() or any drawing function, since the queue only allows a single task to add blocks; it should only signal the drawing task to do it
+    (see the 23.RTOS_tasks example).
+    *The block send function (see blockSendFunction()) is not used while a queue is set.
+    *Passing nullptr returns to transmitting right away; the queue should be empty by then.
+*/
+void TLBFISLib::submissionQueue(TLBFISQueue* queue)
+{
+  //Text waiting to be merged belongs to the previous path.
+  flush();
+  wait_block_send();
+  
+  _submission_queue = queue;
+}
+
+/**
+  Function:
+    setRetryPolicy(uint8_t max_failures, (unsigned long timeout_ms), (uint16_t backoff_us))
+  
+  Parameters:
+    max_failures -> after how many errors reported by the cluster a block is given up on (0 = never)
+    (timeout_ms) -> how long a drawing function may take, in milliseconds (0 = no limit)
+    (backoff_us) -> how long to wait before retrying a block the cluster didn't accept, in microseconds (doubled on every retry, up to 16 times)
+  
+  Default parameters:
+    (timeout_ms = 0)
+    (backoff_us = 0)
+  
+  Description:
+    Bounds how long drawing functions wait for the cluster; by default, they keep retrying until the command is sent.
+  
+  Notes:
+    *The drawing functions return SENT if the command was sent, FAILED if a block was given up on because of errors, or TIMED_OUT if the deadline passed.
+    *The deadline applies to the entire call (for example to all blocks of a bitmap); the remaining blocks are not sent, so the sketch can skip the stale
+    frame and draw the next one instead of blocking.
+    *If a text or workspace command is given up on, the library will restore the workspace before the next command that depends on it.
+*/
+void TLBFISLib::setRetryPolicy(uint8_t max_failures, unsigned long timeout_ms, uint16_t backoff_us)
+{
+  _max_failures = max_failures;
+  _timeout = timeout_ms;
+  _backoff = backoff_us;
+}
+
+/**
+  Function:
+    setAdaptivePacing(bool enabled)
+  
+  Parameters:
+    enabled -> whether or not to adapt the pause between blocks to the cluster
+  
+  Description:
+    Makes the library learn how long the cluster needs between two blocks, from the REPEAT answers it gives and from how long after the previous block
+    it accepts the next one, and wait that long before the first attempt of every block instead of asking it again and again.
+  
+  Notes:
+    *A block which needed retries, although it followed the previous one closely, moves the pause halfway to the time the cluster actually took; a block
+    accepted at once shortens it by 1/32, so the pause follows the cluster when it becomes faster again (it's limited to TLBFIS_PACING_MAX).
+    *Only the part of the pause which hasn't already passed is waited for, so a sketch which draws slowly doesn't wait at all.
+    *Retries are spaced by a sixteenth of the pause (at least TLBFIS_PACING_RETRY), unless a backoff was set with setRetryPolicy().
+    *While there is a pause, update() keeps left-aligned text waiting to be merged for as long as TLBFIS_PACING_WINDOW_BLOCKS blocks would take,
+    so that characters written by the next calls are sent in the same block (see getCoalescingWindow()).
+    *Blocks transmitted by a block send function (see blockSendFunction()) are not paced.
+*/
+void TLBFISLib::setAdaptivePacing(bool enabled)
+{
+  _pacing = enabled;
+  _pace = 0;
+}
+
+/**
+  Function:
+    getPacing()
+  
+  Returns:
+    uint16_t -> the pause kept between two blocks (in microseconds, 0 = blocks are sent back to back)
+  
+  Description:
+    Provides the pause learned by the adaptive pacing (see setAdaptivePacing()).
+*/
+uint16_t TLBFISLib::getPacing()
+{
+  return _pace;
+}
+
+/**
+  Function:
+    getCoalescingWindow()
+  
+  Returns:
+    uint8_t -> how long update() keeps text waiting to be merged (in milliseconds, 0 = it's sent by the next update())
+  
+  Description:
+    Provides the time it would take to send TLBFIS_PACING_WINDOW_BLOCKS blocks with the current pause.
+*/
+uint8_t TLBFISLib::getCoalescingWindow()
+{
+  if (!_pacing) {
+    return 0;
+  }
+  
+  unsigned long window = (unsigned long)_pace * TLBFIS_PACING_WINDOW_BLOCKS / 1000;
+  return (window > 0xFF) ? 0xFF : window;
+}
+
+/**
+  Function:
+    latencyHistograms(latencyStats* stats)
+  
+  Parameters:
+    stats -> histograms to record the latencies into (nullptr = stop recording)
+  
+  Description:
+    Records how long commands take to be acknowledged by the cluster, into histograms allocated by the user.
+  
+  Notes:
+    *stats->opcode[] has a histogram for each command type (OPCODE_*), measured from the moment the command was built (or, for text which was kept to
+    be merged, from the moment its first characters were written) until the cluster accepted it.
+    *stats->call[] has a histogram for each public function (CALL_*), measured from the moment it was called until it returned; text kept to be merged
+    is only counted when it's sent (by flush(), update() or the next command).
+    *Bucket n of a histogram counts latencies shorter than latencyBucketLimit(n); the last bucket counts all longer latencies, and the counters stop at 65535.
+    *Commands which were given up on (see setRetryPolicy()) are not counted.
+    *The histograms can be read at any time and cleared with resetLatencyHistograms(), for example when the ignition is switched on.
+*/
+void TLBFISLib::latencyHistograms(latencyStats* stats)
+{
+  _latency = stats;
+  resetLatencyHistograms();
+}
+
+/**
+  Function:
+    resetLatencyHistograms()
+  
+  Description:
+    Clears the histograms set by latencyHistograms().
+*/
+void TLBFISLib::resetLatencyHistograms()
+{
+  if (_latency) {
+    memset(_latency, 0, sizeof(latencyStats));
+  }
+}
+
+/**
+  Function:
+    transportStatistics(transportStats* stats)
+  
+  Parameters:
+    stats -> structure to count into (nullptr = stop counting)
+  
+  Description:
+    Counts the blocks accepted by the cluster, the retries they needed and how long the cluster took to recover from repeats and errors, into a
+    structure allocated by the user.
+  
+  Notes:
+    *The throughput can be calculated from stats->bytes and the time the statistics were collected for.
+    *stats->worst_block_us is the longest time a single block blocked its drawing function (or update(), with a submission queue), including retries.
+    *A recovery starts with the first repeat or error and ends when the next block is accepted.
+    *Blocks transmitted by a block send function (see blockSendFunction()) are not counted.
+    *The counters can be read at any time and cleared with resetTransportStatistics().
+*/
+void TLBFISLib::transportStatistics(transportStats* stats)
+{
+  _transport = stats;
+  _in_trouble = false;
+}
+
+/**
+  Function:
+    resetTransportStatistics()
+  
+  Description:
+    Clears the counters given to transportStatistics().
+*/
+void TLBFISLib::resetTransportStatistics()
+{
+  if (_transport) {
+    memset(_transport, 0, sizeof(transportStats));
+  }
+  _in_trouble = false;
+}
+
+/**
+  Function:
+    latencyBucketLimit(uint8_t bucket)
+  
+  Parameters:
+    bucket -> index of the bucket
+  
+  Returns:
+    unsigned long -> the upper limit of the bucket (in microseconds)
+  
+  Description:
+    Determines which latencies a histogram bucket counts (the buckets double in size, starting at TLBFIS_LATENCY_BASE_US).
+*/
+unsigned long TLBFISLib::latencyBucketLimit(uint8_t bucket)
+{
+  //The last bucket has no upper limit.
+  if (bucket >= TLBFIS_LATENCY_BUCKETS - 1) {
+    return 0xFFFFFFFF;
+  }
+  
+  return (unsigned long)TLBFIS_LATENCY_BASE_US << bucket;
+}
+
 /**
   Function:
     begin()
@@ -42,6 +359,9 @@ void TLBFISLib::errorFunction(TLBLib::errorFunction_type function)
 void TLBFISLib::begin()
 {
   TLB.begin();
+  
+  //The connection was just established.
+  _last_update = millis();
 }
 
 /**
@@ -53,6 +373,13 @@ void TLBFISLib::begin()
 */
 void TLBFISLib::end()
 {
+  //The deadline is measured from here.
+  deadline_scope scope(*this);
+  
+  //Send any text waiting to be merged before stopping.
+  flush();
+  wait_block_send();
+  
   TLB.end();
 }
 
@@ -68,11 +395,20 @@ void TLBFISLib::end()
     screen_size = HALFSCREEN
     color = NORMAL
   
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
   Description:
     Claims the screen.
 */
-void TLBFISLib::initScreen(screenSize screen_size, drawColor color)
+TLBFISLib::status TLBFISLib::initScreen(screenSize screen_size, drawColor color)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_INIT_SCREEN);
+  
+  //Claiming the screen clears it, so text which is still waiting to be sent is discarded.
+  _text_pending = false;
+  
   //Save the selected screen size and color in global variables to be used later by private functions.
   _screen_size = screen_size;
   _screen_color = color;
@@ -108,7 +444,133 @@ void TLBFISLib::initScreen(screenSize screen_size, drawColor color)
   //7. Height
   add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_H);
   //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
+  status result = send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+  
+  //The cluster's workspace now matches the current one (if the command failed, it will be set again before the next command which depends on it).
+  _workspace_modified = (result != SENT);
+  
+  //The screen was cleared, so the registered widgets must be drawn again.
+  invalidateWidgets();
+  
+  return result;
+}
+
+/**
+  Function:
+    calibrateBlockSize()
+  
+  Returns:
+    uint8_t -> the largest block size the cluster accepted (in bytes), or 0 if it couldn't be determined
+  
+  Description:
+    Finds the largest block the cluster accepts, between TLB_MIN_BYTES_PER_BLOCK and TLB_MAX_BYTES_PER_BLOCK, and uses it from now on.
+  
+  Notes:
+    *It should be called after initScreen(), before drawing; the probes are transparent bitmaps with all pixels off, so they don't change the screen.
+    *The sizes are searched by halving the range, so it takes a few blocks (6 with the default limits); a size is considered rejected if the
+    cluster reports an error for it twice.
+    *A cluster which doesn't accept an oversized block may also report an error through the TLB library, in which case the error function is executed.
+    *If the smallest size isn't accepted, or the deadline set by setRetryPolicy() passes, the block size is not changed and 0 is returned.
+    *The probes need the cluster's answer, so 0 is also returned while a submission queue is attached (queued blocks are answered later, in
+    update()); the block size should be calibrated before attaching it, or set with setBlockSize().
+    *With a block send function (see blockSendFunction()), the probes are judged by the answers given to blockSendComplete().
+    *Clusters accepting larger blocks can only be used if TLB_MAX_BYTES_PER_BLOCK is raised (by defining it before the library is included, for
+    the entire build), since it's the size of the buffers; a cluster which silently cuts long blocks can't be detected, so the size must be set
+    with setBlockSize() instead.
+*/
+uint8_t TLBFISLib::calibrateBlockSize()
+{
+  //Blocks queued for another task are reported as sent before the cluster answers, so they can't be probed.
+  if (_submission_queue) {
+    return 0;
+  }
+  
+  //The deadline is measured from here.
+  deadline_scope scope(*this);
+  
+  //Send the text waiting to be merged first, with the normal retry policy.
+  if (flush() != SENT) {
+    return 0;
+  }
+  
+  //Every size is given two attempts, even if the retry policy doesn't limit errors.
+  uint8_t saved_max_failures = _max_failures;
+  _max_failures = 2;
+  
+  //Make sure the smallest size is accepted, then search the largest one.
+  uint8_t accepted = 0;
+  status result = probe_block(TLB_MIN_BYTES_PER_BLOCK);
+  if (result == SENT) {
+    accepted = TLB_MIN_BYTES_PER_BLOCK;
+    uint8_t rejected = TLB_MAX_BYTES_PER_BLOCK + 1;
+    
+    while (rejected - accepted > 1) {
+      uint8_t size = accepted + (rejected - accepted) / 2;
+      result = probe_block(size);
+      
+      if (result == SENT) {
+        accepted = size;
+      }
+      else if (result == FAILED) {
+        rejected = size;
+      }
+      //If the deadline passed, the search can't be completed.
+      else {
+        accepted = 0;
+        break;
+      }
+    }
+  }
+  
+  _max_failures = saved_max_failures;
+  
+  if (accepted) {
+    _block_size = accepted;
+  }
+  return accepted;
+}
+
+/**
+  Function:
+    setBlockSize(uint8_t size)
+  
+  Parameters:
+    size -> the largest block to send (in bytes)
+  
+  Description:
+    Sets how long the blocks which text and bitmaps are split into may be, for clusters whose limit is already known (see calibrateBlockSize()).
+  
+  Notes:
+    *The size is limited to TLB_MIN_BYTES_PER_BLOCK...TLB_MAX_BYTES_PER_BLOCK; the default is TLB_DEFAULT_BYTES_PER_BLOCK.
+    *Text which is longer than a block can hold (without its 5-byte header) is cut off.
+*/
+void TLBFISLib::setBlockSize(uint8_t size)
+{
+  //Text waiting to be merged may already be longer than the new size.
+  flush();
+  
+  if (size < TLB_MIN_BYTES_PER_BLOCK) {
+    size = TLB_MIN_BYTES_PER_BLOCK;
+  }
+  if (size > TLB_MAX_BYTES_PER_BLOCK) {
+    size = TLB_MAX_BYTES_PER_BLOCK;
+  }
+  _block_size = size;
+}
+
+/**
+  Function:
+    getBlockSize()
+  
+  Returns:
+    uint8_t -> the largest block which is sent (in bytes)
+  
+  Description:
+    Provides the block size set by setBlockSize() or found by calibrateBlockSize().
+*/
+uint8_t TLBFISLib::getBlockSize()
+{
+  return _block_size;
 }
 
 /**
@@ -124,6 +586,9 @@ void TLBFISLib::initScreen(screenSize screen_size, drawColor color)
     clear = false
     color = NORMAL
   
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
   Description:
     Moves the 0,0 origin and the allowed area (clip rectangle) for drawing commands to the zone specified, and optionally clears it as well.
   
@@ -132,8 +597,17 @@ void TLBFISLib::initScreen(screenSize screen_size, drawColor color)
     first pixel, in order to avoid confusion.
     *Clearing in the same command as the setWorkspace() (clear=true) is more efficient than calling clear() after it.
 */
-void TLBFISLib::setWorkspace(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool clear, drawColor color)
+TLBFISLib::status TLBFISLib::setWorkspace(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool clear, drawColor color)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_SET_WORKSPACE);
+  
+  //Text waiting to be merged belongs to the previous workspace, so it must be sent before the workspace changes.
+  status flushed = flush();
+  if (flushed != SENT) {
+    return flushed;
+  }
+  
   //Set some values for easily constraining the parameters.
   uint8_t screen_width = 64; //constant
   uint8_t screen_height = (_screen_size == HALFSCREEN) ? 48 : 88; //dependent on screen size
@@ -181,7 +655,11 @@ void TLBFISLib::setWorkspace(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool cl
   //7. Height
   add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_H);
   //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
+  status result = send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+  
+  //The cluster's workspace now matches the current one (if the command failed, it will be set again before the next command which depends on it).
+  _workspace_modified = (result != SENT);
+  return result;
 }
 
 /**
@@ -191,7 +669,10 @@ void TLBFISLib::setWorkspace(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool cl
   Parameters:
     clear -> whether or not to also clear the workspace at the same time
     color -> what color to use for clearing, if clear=true
-    
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
   Description:
     Resets the 0,0 origin and the allowed area for drawing commands back to the entire screen, and optionally clears it as well.
   
@@ -200,8 +681,17 @@ void TLBFISLib::setWorkspace(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool cl
     first pixel, in order to avoid confusion.
     *Clearing in the same command as the resetWorkspace() (clear=true) is more efficient than calling clear() after it.
 */
-void TLBFISLib::resetWorkspace(bool clear, drawColor color)
+TLBFISLib::status TLBFISLib::resetWorkspace(bool clear, drawColor color)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_RESET_WORKSPACE);
+  
+  //Text waiting to be merged belongs to the previous workspace, so it must be sent before the workspace changes.
+  status flushed = flush();
+  if (flushed != SENT) {
+    return flushed;
+  }
+  
   //Reset the workspace dimensions according to the chosen screen size.
   if (_screen_size == FULLSCREEN) {
     current_X = 0;
@@ -232,54 +722,105 @@ void TLBFISLib::resetWorkspace(bool clear, drawColor color)
   //7. Height
   add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_H);
   //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
+  status result = send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+  
+  //The cluster's workspace now matches the current one (if the command failed, it will be set again before the next command which depends on it).
+  _workspace_modified = (result != SENT);
+  return result;
 }
 
 /**
   Function:
-    getWorkspaceWidth()
+    getWorkspaceX()
   
   Returns:
-    uint8_t -> workspace width
+    uint8_t -> workspace X coordinate
   
   Description:
-    Provides the currently set workspace width.
+    Provides the X coordinate of the currently set workspace (as given to setWorkspace()).
 */
-uint8_t TLBFISLib::getWorkspaceWidth()
+uint8_t TLBFISLib::getWorkspaceX()
 {
-  return current_W;
+  return current_X;
 }
 
 /**
   Function:
-    getWorkspaceHeight()
+    getWorkspaceY()
   
   Returns:
-    uint8_t -> workspace height
+    uint8_t -> workspace Y coordinate
   
   Description:
-    Provides the currently set workspace height.
+    Provides the Y coordinate of the currently set workspace (as given to setWorkspace()).
 */
-uint8_t TLBFISLib::getWorkspaceHeight()
+uint8_t TLBFISLib::getWorkspaceY()
 {
-  return current_H;
+  //In HALFSCREEN, the Y coordinate 0 represents the first pixel of the visible area.
+  if (_screen_size == HALFSCREEN) {
+    return current_Y - 27;
+  }
+  
+  return current_Y;
 }
 
 /**
   Function:
-    clear(drawColor color)
+    getWorkspaceWidth()
   
-  Parameters:
+  Returns:
+    uint8_t -> workspace width
+  
+  Description:
+    Provides the currently set workspace width.
+*/
+uint8_t TLBFISLib::getWorkspaceWidth()
+{
+  return current_W;
+}
+
+/**
+  Function:
+    getWorkspaceHeight()
+  
+  Returns:
+    uint8_t -> workspace height
+  
+  Description:
+    Provides the currently set workspace height.
+*/
+uint8_t TLBFISLib::getWorkspaceHeight()
+{
+  return current_H;
+}
+
+/**
+  Function:
+    clear(drawColor color)
+  
+  Parameters:
     color -> what color will fill the workspace (NORMAL/INVERTED)
   
   Default parameters:
     color = NORMAL
   
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
   Description:
     Clears the currently claimed workspace area (with the selected color).
 */
-void TLBFISLib::clear(drawColor color)
+TLBFISLib::status TLBFISLib::clear(drawColor color)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_CLEAR);
+  
+  //Text waiting to be merged must be drawn before the workspace is cleared.
+  status flushed = flush();
+  if (flushed != SENT) {
+    return flushed;
+  }
+  
   //Add bytes to the transmit buffer for clearing the screen.
   //Command byte (clear/claim area); true = also clear the buffer
   add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
@@ -296,545 +837,849 @@ void TLBFISLib::clear(drawColor color)
   //6. Height
   add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_H);
   //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
+  status result = send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+  
+  //The cluster's workspace now matches the current one (if the command failed, it will be set again before the next command which depends on it).
+  _workspace_modified = (result != SENT);
+  return result;
 }
 
 /**
   Function:
     update()
-
+  
   Description:
     Maintains the connection.
-    
+  
   Notes:
     *This function must be called during periods of inactivity; the sketch should only use non-blocking delays (with millis()), calling update() while waiting.
+    *The changes of the widgets registered with addWidget() are sent here, within the budget set by setWidgetBudget(), followed by a few blocks of
+    the bitmaps queued with queueBitmap().
+    *Instead of calling this function constantly, the sketch can sleep for the time given by msUntilNextUpdate().
+    *With a submission queue (see submissionQueue()), this function only transmits the queued blocks and maintains the connection; the rest is
+    done by updateWidgets().
 */
 void TLBFISLib::update()
 {
+  //With a submission queue, the drawing task does the rest (see updateWidgets()), so only the queued blocks are transmitted here.
+  if (_submission_queue) {
+    transmit_queue();
+    TLB.update();
+    _last_update = millis();
+    return;
+  }
+  
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_UPDATE);
+  
+  updateWidgets();
+  
+  //The bus can't be used while a block is being transmitted.
+  if (wait_block_send() != SENT) {
+    return;
+  }
+  
   TLB.update();
+  _last_update = millis();
 }
 
 /**
   Function:
-    turnOff()
-    
+    updateWidgets()
+  
   Description:
-    Returns the screen to the "trip computer" mode.
-    
+    Sends the text waiting to be merged, refreshes the registered widgets and sends a few blocks of the queued bitmaps.
+  
   Notes:
-    *To draw again after this command, initScreen() must be called first.
+    *This is done by update(), so it only needs to be called separately when a submission queue is set (see submissionQueue()), by the task
+    which draws.
 */
-void TLBFISLib::turnOff()
+void TLBFISLib::updateWidgets()
 {
-  TLB.turnOff();
+  //The deadline is measured from here.
+  deadline_scope scope(*this);
+  
+  //Send any text waiting to be merged, so it doesn't stay off the screen while the sketch is idle (while the cluster is slow, it's kept for the
+  //coalescing window, so that more characters can join it).
+  if (micros() - _text_enqueued >= (unsigned long)getCoalescingWindow() * 1000) {
+    //If the cluster doesn't accept the text, it stays waiting, and the widgets would only fail the same way; they are refreshed by the next call.
+    if (flush() != SENT) {
+      return;
+    }
+  }
+  
+  //Service the lanes in order of priority: urgent widgets, normal widgets, then queued bitmaps and bulk widgets.
+  unsigned long start = millis();
+  refresh_widgets(LANE_URGENT, start);
+  refresh_widgets(LANE_NORMAL, start);
+  send_bulk();
+  refresh_widgets(LANE_BULK, start);
 }
 
 /**
   Function:
-    setDrawColor(drawColor color)
+    flush()
   
-  Parameters:
-    color -> which color palette to use (NORMAL/INVERTED)
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
   
   Description:
-    Sets the palette for subsequent text, bitmap, line and rectangle commands.
+    Sends the text that is waiting to be merged with following characters, if there is any, and waits for the cluster's answer to the last block
+    given to the block send function (see blockSendFunction()).
+  
+  Notes:
+    *Left-aligned text isn't sent right away, so that characters written next to it (on the same line, with the same settings) can be sent in the same
+    block; it is sent automatically before any other command, when a text setting is changed and by update().
+    *The drawing functions return SENT for such text as soon as it's kept; if the cluster then doesn't accept it, it stays waiting, and the function
+    which tried to send it (this one, the next drawing function or a text setting) returns the error. It's only discarded by initScreen().
+    *This only needs to be called to make the text appear while not calling update(), for example before a long blocking operation, or to find out
+    whether the text was accepted.
 */
-void TLBFISLib::setDrawColor(drawColor color)
+TLBFISLib::status TLBFISLib::flush()
 {
-  //Set the color for line/rectangle commands.
-  _draw_color = color;
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_FLUSH);
   
-  if (_draw_color == NORMAL) { //selecting the normal color palette
-    //Set bit1 for text and bitmaps.
-    _font |= _text_or_output;
-    _bmp |= _bmp_or_output;
+  //If there is no text waiting, only the answer to the last block may be missing.
+  if (!_text_pending) {
+    return wait_block_send();
   }
-  else { //selecting the inverted color palette
-    //Unset bit1 for text and bitmaps.
-    _font &= ~_text_or_output;
-    _bmp &= ~_bmp_or_output;
+  
+  //The text isn't waiting while it's sent, so that the commands sent before it (restoring the workspace) don't try to send it again.
+  _text_pending = false;
+  
+  //Send
+  status result = send_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length);
+  
+  //With a block send function, wait for the answer, so that the result covers the text.
+  if (result == SENT) {
+    result = wait_block_send();
+  }
+  
+  //If the text wasn't accepted (or the cluster gave up its turn on a shared bus), keep it, so that the next call which uses the bus sends it again
+  //and reports the error if it still isn't accepted.
+  if (result != SENT) {
+    _text_pending = true;
   }
+  
+  return result;
 }
 
 /**
   Function:
-    setFont(font text_font)
-  
-  Parameters:
-    text_font -> what character set to use (STANDARD/COMPACT/GRAPHICS)
+    turnOff()
   
   Description:
-    Selects the font used for subsequent text commands.
+    Returns the screen to the "trip computer" mode.
+  
+  Notes:
+    *To draw again after this command, initScreen() must be called first.
 */
-void TLBFISLib::setFont(font text_font)
+void TLBFISLib::turnOff()
 {
-  if (text_font == GRAPHICS) { //selecting the graphical font
-    //Set bit3 and unset bit2.
-    _font |= _text_graphics;
-    _font &= ~_text_compact;
-  }
-  else { //not selecting the graphical font
-    //Unset bit3.
-    _font &= ~_text_graphics;
-    
-    if (text_font == COMPACT) { //selecting the compact font
-      //Set bit2.
-      _font |= _text_compact;
-    }
-    else { //selecting the standard font
-      //Unset bit 2.
-      _font &= ~_text_compact;
-    }
-  }
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_TURN_OFF);
+  
+  //Send any text waiting to be merged before giving up the screen.
+  flush();
+  wait_block_send();
+  
+  TLB.turnOff();
 }
 
 /**
   Function:
-    setTextTransparency(transparency text_transparency)
+    addWidget(TLBFISWidget &widget, (lane widget_lane))
   
   Parameters:
-    text_transparency -> which transparency to use (OPAQUE/TRANSPARENT)
+    widget        -> the widget to register
+    (widget_lane) -> priority of the widget's refreshes (LANE_URGENT/LANE_NORMAL/LANE_BULK)
+  
+  Default parameters:
+    (widget_lane = LANE_NORMAL)
   
   Description:
-    Sets the transparency for subsequent text commands.
+    Registers a widget, so that its changes are sent by update() instead of right away.
+  
+  Notes:
+    *Changes are only recorded when they are made, so the sketch can update values as often as it wants: update() only refreshes the widgets which
+    changed and whose refresh interval (see TLBFISWidget::setRefreshInterval()) has passed, and only sends their latest state.
+    *Widgets are checked in turns, starting after the last one which was refreshed, so that all of them get a chance when the budget (see
+    setWidgetBudget()) runs out.
+    *Registered widgets are redrawn entirely after initScreen().
+    *Widgets in LANE_URGENT (for example warnings) are refreshed first and regardless of the budget; widgets in LANE_BULK are only refreshed
+    after the blocks of the queued bitmaps (see queueBitmap()), while the budget lasts.
+    *A widget can only be registered once, and must not be destroyed while it's registered.
 */
-void TLBFISLib::setTextTransparency(transparency text_transparency)
+void TLBFISLib::addWidget(TLBFISWidget &widget, lane widget_lane)
 {
-  if (text_transparency == TRANSPARENT) { //selecting transparent text
-    //Set bit0.
-    _font |= _text_transparent;
+  //A widget can't be in two registries.
+  if (widget._scheduler) {
+    return;
   }
-  else { //selecting opaque text
-    //Unset bit0.
-    _font &= ~_text_transparent;
+  
+  //The widget can be refreshed right away, whatever its interval is.
+  widget._last_refresh = millis() - 0xFFFF;
+  
+  //Add the widget to the end of the list, so that widgets are checked in the order they were registered.
+  widget._scheduler = this;
+  widget._next_widget = nullptr;
+  widget._lane = (widget_lane < LANE_COUNT) ? widget_lane : LANE_NORMAL;
+  if (!_widgets) {
+    _widgets = &widget;
+  }
+  else {
+    TLBFISWidget* last = _widgets;
+    while (last->_next_widget) {
+      last = last->_next_widget;
+    }
+    last->_next_widget = &widget;
   }
 }
 
 /**
   Function:
-    setTextAlignment(alignment text_alignment)
+    removeWidget(TLBFISWidget &widget)
   
   Parameters:
-    text_alignment -> where to align the text (LEFT/CENTER/RIGHT)
+    widget -> the widget to unregister
   
   Description:
-    Sets the alignment for subsequent text commands.
+    Unregisters a widget, so that its changes are sent right away again.
+  
+  Notes:
+    *Changes which weren't sent yet are sent by the widget's next update.
 */
-void TLBFISLib::setTextAlignment(alignment text_alignment)
+void TLBFISLib::removeWidget(TLBFISWidget &widget)
 {
-  //Unset bit4 and bit5.
-  _font &= ~(_text_right | _text_center);
+  if (widget._scheduler != this) {
+    return;
+  }
   
-  if (text_alignment == CENTER) { //selecting central alignment
-    //Set bit5 and unset bit4.
-    _font |= _text_center;
-    _font &= ~_text_right;
+  //Find the pointer to the widget and make it skip the widget.
+  TLBFISWidget** link = &_widgets;
+  while (*link && *link != &widget) {
+    link = &(*link)->_next_widget;
   }
-  else { //not selecting central alignment
-    if (text_alignment == LEFT) { //selecting left alignment
-      //Unset bit5.
-      _font &= ~_text_center;
-    }
-    else { //selecting right alignment
-      //Set bit4 and unset bit5.
-      _font |= _text_right;
-      _font &= ~_text_center;
+  if (*link) {
+    *link = widget._next_widget;
+  }
+  
+  //The next turn goes to the widget which followed it.
+  for (uint8_t i = 0; i < LANE_COUNT; i++) {
+    if (_widget_cursor[i] == &widget) {
+      _widget_cursor[i] = widget._next_widget;
     }
   }
+  
+  widget._scheduler = nullptr;
+  widget._next_widget = nullptr;
 }
 
 /**
   Function:
-    setLineSpacing(uint8_t spacing)
+    setWidgetBudget(uint16_t budget_ms)
   
   Parameters:
-    spacing -> height (in pixels) to leave between lines
+    budget_ms -> how long update() may spend refreshing widgets (in milliseconds, 0 = no limit)
   
   Description:
-    Sets the amount of vertical space (in pixels) to be left by the writeMultiLineText() function when advancing a row.
+    Limits how long a call to update() may take, so that refreshing many widgets doesn't delay the rest of the sketch.
+  
+  Notes:
+    *The budget applies to the widgets in LANE_NORMAL and LANE_BULK; it's checked before each widget, but at least one widget of LANE_NORMAL is
+    refreshed by each call, and the remaining ones are refreshed by the following calls.
 */
-void TLBFISLib::setLineSpacing(uint8_t spacing)
+void TLBFISLib::setWidgetBudget(uint16_t budget_ms)
 {
-  _spacing = spacing;
+  _widget_budget = budget_ms;
 }
 
 /**
   Function:
-    writeChar(uint8_t startX, uint8_t startY, char/uint8_t character)
-  
-  Parameters:
-    startX, startY -> coordinates of the character (top-left pixel)
-    character      -> the character to write
+    invalidateWidgets()
   
   Description:
-    Writes a single character at the given coordinates.
+    Makes all registered widgets redraw entirely when update() refreshes them (for example after drawing over them).
 */
-void TLBFISLib::writeChar(uint8_t startX, uint8_t startY, char character)
+void TLBFISLib::invalidateWidgets()
 {
-  //Call the private function, which takes a byte (uint8_t).
-  _writeChar(startX, startY, (uint8_t)character);
+  for (TLBFISWidget* widget = _widgets; widget; widget = widget->_next_widget) {
+    widget->invalidate();
+  }
 }
 
-void TLBFISLib::writeChar(uint8_t startX, uint8_t startY, uint8_t character)
+/**
+  Function:
+    invalidateWidgets(uint8_t X, uint8_t Y, uint8_t W, uint8_t H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the area
+    W, H -> dimensions of the area
+  
+  Description:
+    Makes the registered widgets which overlap an area redraw entirely when update() refreshes them (for example after a popup covering them
+    was closed).
+  
+  Notes:
+    *The area must be given in the same coordinates as the widgets' bounds (see TLBFISWidget::getBounds()).
+*/
+void TLBFISLib::invalidateWidgets(uint8_t X, uint8_t Y, uint8_t W, uint8_t H)
 {
-  //Call the private function.
-  _writeChar(startX, startY, character);
+  for (TLBFISWidget* widget = _widgets; widget; widget = widget->_next_widget) {
+    uint8_t widget_X, widget_Y, widget_W, widget_H;
+    widget->getBounds(widget_X, widget_Y, widget_W, widget_H);
+    
+    //Rectangles overlap if each one starts before the other one ends, in both directions.
+    if (X < widget_X + widget_W && widget_X < X + W && Y < widget_Y + widget_H && widget_Y < Y + H) {
+      widget->invalidate();
+    }
+  }
 }
 
 /**
   Function:
-    writeText(uint8_t startX, uint8_t startY, (size_t length), (const)char/uint8_t message[], (bool fromPGM))
+    queueBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t bitmap[], (bool fromPGM))
   
   Parameters:
-    startX, startY -> coordinates of the string (top-left pixel)
-    (length)       -> provide this parameter if printing less characters than the entire string or using an unterminated character array
-    message[]      -> the string to write
-    (fromPGM)      -> whether or not the string is stored in PROGMEM
+    startX, startY -> the coordinates of the the bitmap's top-left pixel
+    width, height  -> width and height of the bitmap, in pixels
+    bitmap[]       -> the bitmap that will be printed
+    (fromPGM)      -> whether or not the bitmap is stored in PROGMEM
   
   Default parameters:
-    (fromPGM = false)
+    (fromPGM = true)
+  
+  Returns:
+    status -> SENT if the bitmap was queued, FAILED if the queue is full (TLBFIS_BULK_QUEUE_LENGTH bitmaps)
   
   Description:
-    Writes a string at the given coordinates.
+    Draws a bitmap like drawBitmap(), but in the bulk lane: nothing is sent right away, and update() sends a few blocks of it in every call
+    (see setBulkBlocksPerUpdate()), after the registered widgets.
+  
+  Notes:
+    *This way, a large image doesn't hold up more urgent commands (like radio text or warnings): anything else drawn while the bitmap is waiting
+    is sent right away, and only has to wait for the bulk block being transmitted, if there is one.
+    *The workspace and the bitmap settings (transparency and color) are recorded when the bitmap is queued; if the workspace is changed
+    afterwards, every call to update() which sends blocks takes two more commands to switch the workspace and back.
+    *The bitmap is not copied, so it must remain valid until it was sent (see getQueuedBitmaps()).
 */
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, const char* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::queueBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM)
 {
-  //The length is provided by the user, call the private function, which takes a byte array (uint8_t[]).
-  _writeText(startX, startY, length, (uint8_t*)message, fromPGM);
+  //Constrain the bitmap like drawBitmap() does.
+  if (startY >= current_H) {
+    return SENT;
+  }
+  if (height > current_H - startY) {
+    height = current_H - startY;
+  }
+  startX %= current_W;
+  uint8_t total_bytes_per_line = ((current_W - startX + 7) / 8);
+  
+  //If there is nothing to draw, exit.
+  if (!bitmap || !height || !width || !total_bytes_per_line) {
+    return SENT;
+  }
+  
+  //If the queue is full, the bitmap can't be drawn.
+  if (_bulk_count >= TLBFIS_BULK_QUEUE_LENGTH) {
+    return FAILED;
+  }
+  
+  //Record the bitmap and the settings which will be used to send it.
+  bulk_bitmap &job = _bulk_queue[(_bulk_head + _bulk_count) % TLBFIS_BULK_QUEUE_LENGTH];
+  job.bitmap = bitmap;
+  job.fromPGM = fromPGM;
+  job.startX = startX;
+  job.startY = startY;
+  job.bytes_per_line = total_bytes_per_line;
+  job.width_in_bytes = (width + 7) / 8;
+  job.rows = height;
+  job.rows_sent = 0;
+  job.options = _bmp;
+  job.X = current_X;
+  job.Y = current_Y;
+  job.W = current_W;
+  job.H = current_H;
+  _bulk_count++;
+  
+  return SENT;
 }
 
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM)
+/**
+  Function:
+    setBulkBlocksPerUpdate(uint8_t blocks)
+  
+  Parameters:
+    blocks -> how many blocks of queued bitmaps update() may send in a single call (at least 1)
+  
+  Description:
+    Sets how fast queued bitmaps are sent, which is also how long other commands may have to wait for the bulk lane in the worst case.
+*/
+void TLBFISLib::setBulkBlocksPerUpdate(uint8_t blocks)
 {
-  //The length must be calculated, call the function which takes a constant byte array (const uint8_t[]).
-  writeText(startX, startY, (const uint8_t*)message, fromPGM);
+  _bulk_blocks = blocks ? blocks : 1;
 }
 
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, char* message)
+/**
+  Function:
+    getQueuedBitmaps()
+  
+  Returns:
+    uint8_t -> how many bitmaps are waiting in the bulk lane (including the one being sent)
+  
+  Description:
+    Provides the number of bitmaps which weren't sent entirely yet.
+*/
+uint8_t TLBFISLib::getQueuedBitmaps()
 {
-  //The length must be calculated, call the function which takes a byte array (uint8_t[]).
-  writeText(startX, startY, (uint8_t*)message);
+  return _bulk_count;
 }
 
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, char* message)
+/**
+  Function:
+    clearBitmapQueue()
+  
+  Description:
+    Discards the bitmaps waiting in the bulk lane (for example when leaving the screen they were meant for).
+  
+  Notes:
+    *The part of a bitmap which was already sent remains on the screen.
+*/
+void TLBFISLib::clearBitmapQueue()
 {
-  //The length is provided by the user, call the private function, which takes a byte array (uint8_t[]).
-  _writeText(startX, startY, length, (uint8_t*)message);
+  _bulk_head = 0;
+  _bulk_count = 0;
 }
 
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, const uint8_t* message, bool fromPGM)
+/**
+  Function:
+    setKeepaliveInterval(uint16_t interval_ms)
+  
+  Parameters:
+    interval_ms -> longest time between two calls to update() (in milliseconds)
+  
+  Description:
+    Sets how often update() must be called to keep the connection alive, which is the longest time msUntilNextUpdate() reports.
+  
+  Notes:
+    *The default is TLBFIS_KEEPALIVE_INTERVAL; it should leave some margin for how late the sketch can wake up, since the cluster drops the
+    connection if the keepalive messages stop for too long.
+*/
+void TLBFISLib::setKeepaliveInterval(uint16_t interval_ms)
 {
-  //The length is provided by the user, call the private function, which takes a byte array (uint8_t[]).
-  _writeText(startX, startY, length, (uint8_t*)message, fromPGM);
+  _keepalive_interval = interval_ms;
 }
 
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM)
-{
-  //Will contain the calculated string length.
-  size_t length;
-  
-  //Calculate the string length.
-  if (fromPGM) {
-    length = strlen_P((const char*)message);
+/**
+  Function:
+    msUntilNextUpdate()
+  
+  Returns:
+    unsigned long -> how long the sketch may wait before calling update() again (in milliseconds, 0 = right away)
+  
+  Description:
+    Determines when update() has work to do next: maintaining the connection, refreshing a widget whose interval ends, or sending queued data.
+  
+  Notes:
+    *Text waiting to be merged (unless the coalescing window of the adaptive pacing hasn't ended, see setAdaptivePacing()), bitmaps waiting in the
+    bulk lane and widgets which are due (including ones left over by the budget, or whose refresh failed) all require update() to be called right away.
+    *Widgets which aren't dirty don't shorten the time, since they only become dirty when the sketch changes them (and the sketch is awake then).
+    *The time is rounded down, so calling update() exactly when it ends (or earlier) is always safe: everything which was due is handled by that
+    call, and the next time is measured from it.
+    *For example, the sketch can enter a sleep mode which is woken by a timer set to this time, or by the sketch's own events, whichever comes first.
+*/
+unsigned long TLBFISLib::msUntilNextUpdate()
+{
+  //Data waiting to be sent must be handled right away.
+  if (_bulk_count || (_submission_queue && _submission_queue->getCount())) {
+    return 0;
   }
-  else {
-    length = strlen((const char*)message);
+  
+  //Start with the time left until the connection must be maintained.
+  unsigned long now = millis();
+  unsigned long elapsed = now - _last_update;
+  if (elapsed >= _keepalive_interval) {
+    return 0;
+  }
+  unsigned long remaining = _keepalive_interval - elapsed;
+  
+  //Text waiting to be merged is sent when the coalescing window ends.
+  if (_text_pending) {
+    unsigned long window = (unsigned long)getCoalescingWindow() * 1000;
+    elapsed = micros() - _text_enqueued;
+    if (elapsed >= window) {
+      return 0;
+    }
+    if ((window - elapsed) / 1000 < remaining) {
+      remaining = (window - elapsed) / 1000;
+    }
   }
   
-  //Call the private function, which takes a byte array (uint8_t[]), providing the calculated length.
-  _writeText(startX, startY, length, (uint8_t*)message, fromPGM);
-}
-
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, uint8_t* message)
-{
-  //Calculate the string length.
-  size_t length = strlen((char*)message);
+  //Shorten it to the end of the interval of every dirty widget.
+  for (TLBFISWidget* widget = _widgets; widget; widget = widget->_next_widget) {
+    if (!widget->_dirty) {
+      continue;
+    }
+    
+    elapsed = now - widget->_last_refresh;
+    if (elapsed >= widget->_interval) {
+      return 0;
+    }
+    if (widget->_interval - elapsed < remaining) {
+      remaining = widget->_interval - elapsed;
+    }
+  }
   
-  //Call the private function, providing the calculated length.
-  _writeText(startX, startY, length, message);
-}
-
-void TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message)
-{
-  //Call the private function.
-  _writeText(startX, startY, length, message);
+  return remaining;
 }
 
 /**
   Function:
-    writeMultiLineText(uint8_t startX, uint8_t startY, (const)char/uint8_t message[], (bool fromPGM))
+    setDrawColor(drawColor color)
   
   Parameters:
-    startX, startY -> coordinates of the string (top-left pixel)
-    (length)       -> provide this parameter if printing less characters than the entire string or using an unterminated character array
-    message[]      -> the string to write
-    (fromPGM)      -> whether or not the string is stored in PROGMEM
+    color -> which color palette to use (NORMAL/INVERTED)
   
-  Default parameters:
-    (fromPGM = false)
+  Returns:
+    status -> SENT if the text waiting to be merged was sent (or there was none), FAILED or TIMED_OUT otherwise (see flush())
   
   Description:
-    Splits a string containing newline characters and prints the substrings at incrementing Y coordinates.
-  
-  Notes:
-    *The spacing between rows can be changed with setLineSpacing().
-    *For the GRAPHICS font, use the special character GRAPHICS_NEWLINE to separate lines instead of '\n'.
+    Sets the palette for subsequent text, bitmap, line and rectangle commands.
 */
-void TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM)
-{
-  //Call the private function, which takes a character array (char[]).
-  _writeMultiLineText(startX, startY, (char*)message, fromPGM);
-}
-
-void TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, char* message)
-{
-  //Call the private function.
-  _writeMultiLineText(startX, startY, message);
-}
-
-void TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::setDrawColor(drawColor color)
 {
-  //Call the private function, which takes a character array (char[]).
-  _writeMultiLineText(startX, startY, (char*)message, fromPGM);
+  //Text waiting to be merged must be sent with the previous settings (if it isn't accepted, it stays waiting with them).
+  status result = flush();
+  
+  //Set the color for line/rectangle commands.
+  _draw_color = color;
+  
+  if (_draw_color == NORMAL) { //selecting the normal color palette
+    //Set bit1 for text and bitmaps.
+    _font |= _text_or_output;
+    _bmp |= _bmp_or_output;
+  }
+  else { //selecting the inverted color palette
+    //Unset bit1 for text and bitmaps.
+    _font &= ~_text_or_output;
+    _bmp &= ~_bmp_or_output;
+  }
+  
+  return result;
 }
 
-void TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, uint8_t* message)
+/**
+  Function:
+    getDrawColor()
+  
+  Returns:
+    drawColor -> the palette currently in use (NORMAL/INVERTED)
+  
+  Description:
+    Provides the palette set by setDrawColor().
+*/
+TLBFISLib::drawColor TLBFISLib::getDrawColor()
 {
-  //Call the private function, which takes a character array (char[]).
-  _writeMultiLineText(startX, startY, (char*)message);
+  return _draw_color ? INVERTED : NORMAL;
 }
 
 /**
   Function:
-    writeRadioText(bool line, (size_t length), (const)char/uint8_t message[], (bool fromPGM))
+    setFont(font text_font)
   
   Parameters:
-    line      -> which line to write the string to (0/1)
-    (length)  -> provide this parameter if printing less characters than the entire string or using an unterminated character array
-    message[] -> the string to write
-    (fromPGM) -> whether or not the string is stored in PROGMEM
+    text_font -> what character set to use (STANDARD/COMPACT/GRAPHICS)
   
-  Default parameters:
-    (fromPGM = false)
+  Returns:
+    status -> SENT if the text waiting to be merged was sent (or there was none), FAILED or TIMED_OUT otherwise (see flush())
   
   Description:
-    Writes a string in radio mode.
+    Selects the font used for subsequent text commands.
 */
-void TLBFISLib::writeRadioText(bool line, size_t length, const char* message, bool raw, bool fromPGM)
-{
-  _writeRadioText(line, length, (uint8_t*)message, raw, fromPGM);
-}
-
-void TLBFISLib::writeRadioText(bool line, const char* message, bool raw, bool fromPGM)
-{
-  writeRadioText(line, (const uint8_t*)message, raw, fromPGM);
-}
-
-void TLBFISLib::writeRadioText(bool line, char* message, bool raw)
-{
-  writeRadioText(line, (uint8_t*)message, raw);
-}
-
-void TLBFISLib::writeRadioText(bool line, size_t length, char* message, bool raw)
+TLBFISLib::status TLBFISLib::setFont(font text_font)
 {
-  _writeRadioText(line, length, (uint8_t*)message, raw);
-}
-
-void TLBFISLib::writeRadioText(bool line, size_t length, const uint8_t* message, bool raw, bool fromPGM)
-{
-  _writeRadioText(line, length, (uint8_t*)message, raw, fromPGM);
-}
-
-void TLBFISLib::writeRadioText(bool line, const uint8_t* message, bool raw, bool fromPGM)
-{
-  size_t length;
+  //Text waiting to be merged must be sent with the previous settings (if it isn't accepted, it stays waiting with them).
+  status result = flush();
   
-  if (fromPGM)
-  {
-    length = strlen_P((const char*)message);
+  if (text_font == GRAPHICS) { //selecting the graphical font
+    //Set bit3 and unset bit2.
+    _font |= _text_graphics;
+    _font &= ~_text_compact;
   }
-  else
-  {
-    length = strlen((const char*)message);
+  else { //not selecting the graphical font
+    //Unset bit3.
+    _font &= ~_text_graphics;
+    
+    if (text_font == COMPACT) { //selecting the compact font
+      //Set bit2.
+      _font |= _text_compact;
+    }
+    else { //selecting the standard font
+      //Unset bit 2.
+      _font &= ~_text_compact;
+    }
   }
   
-  _writeRadioText(line, length, (uint8_t*)message, raw, fromPGM);
+  return result;
 }
 
-void TLBFISLib::writeRadioText(bool line, uint8_t* message, bool raw)
-{
-  size_t length = strlen((char*)message);
+/**
+  Function:
+    getFont()
   
-  _writeRadioText(line, length, message, raw);
-}
-
-void TLBFISLib::writeRadioText(bool line, size_t length, uint8_t* message, bool raw)
+  Returns:
+    font -> the font currently in use (STANDARD/COMPACT/GRAPHICS)
+  
+  Description:
+    Provides the font set by setFont().
+*/
+TLBFISLib::font TLBFISLib::getFont()
 {
-  _writeRadioText(line, length, message, raw);
+  if (_font & _text_graphics) {
+    return GRAPHICS;
+  }
+  
+  return (_font & _text_compact) ? COMPACT : STANDARD;
 }
 
 /**
   Function:
-    writeRadioRawData(uint8_t data[])
+    setTextTransparency(transparency text_transparency)
   
   Parameters:
-    data[] -> array of bytes to send
+    text_transparency -> which transparency to use (OPAQUE/TRANSPARENT)
+  
+  Returns:
+    status -> SENT if the text waiting to be merged was sent (or there was none), FAILED or TIMED_OUT otherwise (see flush())
   
   Description:
-    Sends raw data in radio mode.
-    
-  Notes:
-    *The "data" array must contain 18 bytes.
-    *This function is useful when fetching data from the original radio in order to display it without text processing.
+    Sets the transparency for subsequent text commands.
 */
-void TLBFISLib::writeRadioRawData(uint8_t* data)
+TLBFISLib::status TLBFISLib::setTextTransparency(transparency text_transparency)
 {
-  //If an invalid array was provided, exit.
-  if (!data)
-  {
-    return;
-  }
-  
-  //Add the radio message header to the buffer.
-  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, radio_byte, true);
-  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0x11);
-  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0xF0);
+  //Text waiting to be merged must be sent with the previous settings (if it isn't accepted, it stays waiting with them).
+  status result = flush();
   
-  //Add the raw data without the header and original checksum.
-  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, data + 1, 16);
+  if (text_transparency == TRANSPARENT) { //selecting transparent text
+    //Set bit0.
+    _font |= _text_transparent;
+  }
+  else { //selecting opaque text
+    //Unset bit0.
+    _font &= ~_text_transparent;
+  }
   
-  //Send the buffer.
-  while (!send_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length));
+  return result;
 }
 
 /**
   Function:
-    clearRadioText()
+    getTextTransparency()
+  
+  Returns:
+    transparency -> the text transparency currently in use (OPAQUE/TRANSPARENT)
   
   Description:
-    Clears the radio mode section of the screen.
+    Provides the transparency set by setTextTransparency().
 */
-void TLBFISLib::clearRadioText()
+TLBFISLib::transparency TLBFISLib::getTextTransparency()
 {
-  wipe_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length);
-  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, radio_byte);
-  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0x11);
-  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0xF0);
-  while (!send_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length));
+  return (_font & _text_transparent) ? TRANSPARENT : OPAQUE;
 }
 
 /**
   Function:
-    fixNumberPadding(char/uint8_t message[])
+    setTextAlignment(alignment text_alignment)
   
   Parameters:
-    message[] -> the string to modify
+    text_alignment -> where to align the text (LEFT/CENTER/RIGHT)
   
-  Description:
-    Replaces regular space characters with spaces as wide as the digit characters in the selected font.
+  Returns:
+    status -> SENT if the text waiting to be merged was sent (or there was none), FAILED or TIMED_OUT otherwise (see flush())
   
-  Notes:
-    *This should be called after formatting number strings with something like sprintf(), before writing them to the screen.
+  Description:
+    Sets the alignment for subsequent text commands.
 */
-void TLBFISLib::fixNumberPadding(uint8_t* message)
-{
-  //Call the function which takes a character array (char[]).
-  fixNumberPadding((char*)message);
-}
-
-void TLBFISLib::fixNumberPadding(char* message)
+TLBFISLib::status TLBFISLib::setTextAlignment(alignment text_alignment)
 {
-  //For the STANDARD font (and technically for the GRAPHICS font as well), the default space character is already the same size as the digit characters.
-  if (!(_font & _text_compact)) {
-    return;
-  }
+  //Text waiting to be merged must be sent with the previous settings (if it isn't accepted, it stays waiting with them).
+  status result = flush();
   
-  //Calculate the character count of the input string.
-  uint8_t length = strlen(message);
+  //Unset bit4 and bit5.
+  _font &= ~(_text_right | _text_center);
   
-  //Navigate each character of the string.
-  for (uint8_t i = 0; i < length; i++) {
-    //If the current character is a space, replace it.
-    if (message[i] == ' ') {
-      //SPACE_5PX is as wide as a digit character.
-      message[i] = SPACE_5PX[0];
+  if (text_alignment == CENTER) { //selecting central alignment
+    //Set bit5 and unset bit4.
+    _font |= _text_center;
+    _font &= ~_text_right;
+  }
+  else { //not selecting central alignment
+    if (text_alignment == LEFT) { //selecting left alignment
+      //Unset bit5.
+      _font &= ~_text_center;
+    }
+    else { //selecting right alignment
+      //Set bit4 and unset bit5.
+      _font |= _text_right;
+      _font &= ~_text_center;
     }
   }
+  
+  return result;
 }
 
 /**
   Function:
-    charWidth(char/uint8_t message)
-  
-  Parameters:
-    message -> character whose width to calculate
+    getTextAlignment()
   
   Returns:
-    uint8_t -> width of the given character (in pixels)
+    alignment -> the text alignment currently in use (LEFT/CENTER/RIGHT)
   
   Description:
-    Calculates the pixel width of a given character, according to the currently selected font.
+    Provides the alignment set by setTextAlignment().
 */
-uint8_t TLBFISLib::charWidth(char message)
+TLBFISLib::alignment TLBFISLib::getTextAlignment()
 {
-  //Call the private function, which takes a byte (uint8_t).
-  return _charWidth((uint8_t)message);
-}
-
-uint8_t TLBFISLib::charWidth(uint8_t message)
-{
-  //Call the private function.
-  return _charWidth(message);
+  if (_font & _text_center) {
+    return CENTER;
+  }
+  
+  return (_font & _text_right) ? RIGHT : LEFT;
 }
 
 /**
   Function:
-    stringWidth((const)char/uint8_t message[], (size_t length), (bool fromPGM))
+    setLineSpacing(uint8_t spacing)
   
   Parameters:
-    message[] -> string whose width to calculate
-    (length)  -> provide this parameter if calculating the width of less than the entire string or using an unterminated character array
-    (fromPGM) -> whether or not the string is stored in PROGMEM
+    spacing -> height (in pixels) to leave between lines
+  
+  Description:
+    Sets the amount of vertical space (in pixels) to be left by the writeMultiLineText() function when advancing a row.
+*/
+void TLBFISLib::setLineSpacing(uint8_t spacing)
+{
+  _spacing = spacing;
+}
+
+/**
+  Function:
+    getLineSpacing()
+  
+  Returns:
+    uint8_t -> height (in pixels) left between lines
+  
+  Description:
+    Provides the spacing set by setLineSpacing().
+*/
+uint8_t TLBFISLib::getLineSpacing()
+{
+  return _spacing;
+}
+
+/**
+  Function:
+    setTextMerging(bool enabled)
+  
+  Parameters:
+    enabled -> whether or not to merge consecutive text
+  
+  Description:
+    Enables or disables merging consecutive left-aligned text written on the same line (with the same settings, each starting where the previous one ended)
+    into a single block, which is much faster than sending every character separately.
+  
+  Notes:
+    *Merging is enabled by default.
+    *While merging, left-aligned text is only sent before the next command, by flush() or by update(), so it doesn't appear until one of them runs;
+    the drawing function returns SENT once the text is kept, and errors are returned by the function which sends it (see flush()).
+*/
+void TLBFISLib::setTextMerging(bool enabled)
+{
+  //Send any text which is currently waiting.
+  if (!enabled) {
+    flush();
+  }
+  
+  _text_merging = enabled;
+}
+
+/**
+  Function:
+    writeChar(uint8_t startX, uint8_t startY, char/uint8_t character)
+  
+  Parameters:
+    startX, startY -> coordinates of the character (top-left pixel)
+    character      -> the character to write
+  
+  Returns:
+    status -> SENT if the command was sent (or kept to be merged, see flush()), FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Writes a single character at the given coordinates.
+*/
+TLBFISLib::status TLBFISLib::writeChar(uint8_t startX, uint8_t startY, char character)
+{
+  //Call the private function, which takes a byte (uint8_t).
+  return _writeChar(startX, startY, (uint8_t)character);
+}
+
+TLBFISLib::status TLBFISLib::writeChar(uint8_t startX, uint8_t startY, uint8_t character)
+{
+  //Call the private function.
+  return _writeChar(startX, startY, character);
+}
+
+/**
+  Function:
+    writeText(uint8_t startX, uint8_t startY, (size_t length), (const)char/uint8_t message[], (bool fromPGM))
+  
+  Parameters:
+    startX, startY -> coordinates of the string (top-left pixel)
+    (length)       -> provide this parameter if printing less characters than the entire string or using an unterminated character array
+    message[]      -> the string to write
+    (fromPGM)      -> whether or not the string is stored in PROGMEM
   
   Default parameters:
     (fromPGM = false)
   
   Returns:
-    uint16_t -> width of the given string (in pixels)
+    status -> SENT if the command was sent (or kept to be merged, see flush()), FAILED or TIMED_OUT otherwise (see setRetryPolicy())
   
   Description:
-    Calculates the pixel width of a given string, according to the currently selected font.
+    Writes a string at the given coordinates.
 */
-uint16_t TLBFISLib::stringWidth(size_t length, const char* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, const char* message, bool fromPGM)
 {
-  //Call the private function, which takes a byte array (uint8_t[]).
-  return _stringWidth((uint8_t*)message, length, fromPGM);
+  //The length is provided by the user, call the private function, which takes a byte array (uint8_t[]).
+  return _writeText(startX, startY, length, (uint8_t*)message, fromPGM);
 }
 
-uint16_t TLBFISLib::stringWidth(const char* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM)
 {
-  //Call the function which takes a constant byte array (const uint8_t[]).
-  return stringWidth((const uint8_t*)message, fromPGM);
+  //The length must be calculated, call the function which takes a constant byte array (const uint8_t[]).
+  return writeText(startX, startY, (const uint8_t*)message, fromPGM);
 }
 
-uint16_t TLBFISLib::stringWidth(char* message)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, char* message)
 {
-  //Call the function which takes a byte array (uint8_t[]).
-  return stringWidth((uint8_t*)message);
+  //The length must be calculated, call the function which takes a byte array (uint8_t[]).
+  return writeText(startX, startY, (uint8_t*)message);
 }
 
-uint16_t TLBFISLib::stringWidth(size_t length, char* message)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, char* message)
 {
-  //Call the private function, which takes a byte array (uint8_t[]).
-  return _stringWidth((uint8_t*)message, length);
+  //The length is provided by the user, call the private function, which takes a byte array (uint8_t[]).
+  return _writeText(startX, startY, length, (uint8_t*)message);
 }
 
-uint16_t TLBFISLib::stringWidth(size_t length, const uint8_t* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, const uint8_t* message, bool fromPGM)
 {
-  //Call the private function, which takes a byte array (uint8_t[]).
-  return _stringWidth((uint8_t*)message, length, fromPGM);
+  //The length is provided by the user, call the private function, which takes a byte array (uint8_t[]).
+  return _writeText(startX, startY, length, (uint8_t*)message, fromPGM);
 }
 
-uint16_t TLBFISLib::stringWidth(const uint8_t* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM)
 {
   //Will contain the calculated string length.
   size_t length;
@@ -848,124 +1693,2563 @@ uint16_t TLBFISLib::stringWidth(const uint8_t* message, bool fromPGM)
   }
   
   //Call the private function, which takes a byte array (uint8_t[]), providing the calculated length.
-  return _stringWidth((uint8_t*)message, length, fromPGM);
+  return _writeText(startX, startY, length, (uint8_t*)message, fromPGM);
 }
 
-uint16_t TLBFISLib::stringWidth(uint8_t* message)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, uint8_t* message)
 {
   //Calculate the string length.
-  size_t length = strlen((const char*)message);
+  size_t length = strlen((char*)message);
   
   //Call the private function, providing the calculated length.
-  return _stringWidth(message, length);
+  return _writeText(startX, startY, length, message);
 }
 
-uint16_t TLBFISLib::stringWidth(size_t length, uint8_t* message)
+TLBFISLib::status TLBFISLib::writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message)
 {
   //Call the private function.
-  return _stringWidth(message, length);
+  return _writeText(startX, startY, length, message);
 }
 
 /**
   Function:
-    toggleHighlight(uint8_t startY)
+    writeEncodedText(uint8_t startX, uint8_t startY, size_t length, const uint8_t message[], uint16_t width)
   
   Parameters:
-    startY -> the vertical coordinate of the line to be (un)highlighted
+    startX, startY -> coordinates of the string (top-left pixel)
+    length         -> how many characters to write
+    message[]      -> the characters to write, already converted with encodeChar()
+    width          -> width of the string (in pixels), as returned by stringWidth() for the original characters
+  
+  Returns:
+    status -> SENT if the command was sent (or kept to be merged, see flush()), FAILED or TIMED_OUT otherwise (see setRetryPolicy())
   
   Description:
-    Toggles the highlighting of an entire line of text.
+    Writes a string which is already in the cluster's character set, skipping the conversion done by writeText().
+  
+  Notes:
+    *Useful for text which is displayed many times, like scrolling text: it can be converted once and sent as is afterwards.
+    *The width is only used for right alignment and for merging with following text, since it can't be determined from the converted characters.
 */
-void TLBFISLib::toggleHighlight(uint8_t startY)
+TLBFISLib::status TLBFISLib::writeEncodedText(uint8_t startX, uint8_t startY, size_t length, const uint8_t* message, uint16_t width)
 {
-  //Save the current font settings to reapply afterwards.
-  uint8_t prev_font = _font;
+  //Call the private function, indicating that no conversion is needed.
+  return _writeText(startX, startY, length, (uint8_t*)message, false, true, width);
+}
+
+/**
+  Function:
+    encodeChar(uint8_t character)
   
-  //Set the drawing options.
-  setFont(GRAPHICS);
-  setTextAlignment(LEFT);
-  setDrawColor(INVERTED);
-  setTextTransparency(TRANSPARENT);
+  Parameters:
+    character -> the character to convert
   
-  //Send the highlight message (11 solid rectangles to fill the line).
-  writeText(0, startY, TLBFIS_HIGHLIGHT, true);
+  Returns:
+    uint8_t -> the character in the cluster's character set
   
-  //Reapply previous font settings.
-  _font = prev_font;
+  Description:
+    Converts a character the same way writeText() does, according to the currently selected font (the GRAPHICS font is not converted).
+*/
+uint8_t TLBFISLib::encodeChar(uint8_t character)
+{
+  if (_font & _text_graphics) {
+    return character;
+  }
+  
+  return pgm_read_byte_near(TLBFIS_ISO_IEC_8859_1 + character);
 }
 
 /**
   Function:
-    setBitmapTransparency(transparency bitmap_transparency)
+    printAt(uint8_t startX, uint8_t startY, const char format[], ...)
+    printAt_P(uint8_t startX, uint8_t startY, const char format[], ...)
   
   Parameters:
-    bitmap_transparency -> which transparency to use (OPAQUE/TRANSPARENT)
+    startX, startY -> coordinates of the string (top-left pixel)
+    format[]       -> printf-style format string (stored in PROGMEM for printAt_P())
+    ...            -> values for the conversions in the format string
+  
+  Returns:
+    status -> SENT if the command was sent (or kept to be merged, see flush()), FAILED or TIMED_OUT otherwise (see setRetryPolicy())
   
   Description:
-    *Sets the transparency for subsequent bitmap commands.
+    Formats values and writes them at the given coordinates, without needing a separate buffer: every character is converted to the cluster's
+    character set and added to the text command as soon as it's produced.
+  
+  Notes:
+    *Supported conversions: %d/%i (signed), %u (unsigned), %x/%X (hexadecimal), %c (character), %s (string), %S (string stored in PROGMEM),
+    %f (floating point, 2 decimals by default), %q (fixed point: an integer with the given number of decimals, %.1q prints 1234 as "123.4") and %%.
+    *Flags ('-', '0', '+', ' '), width and precision can be given like for printf(), also as '*'; 'l' selects long arguments.
+    *The width is limited to 64 characters (wider than the screen) and the precision to 9 decimals.
+    *With the COMPACT font, numbers are padded with spaces as wide as a digit, so values of a constant width always cover the previous ones
+    (like fixNumberPadding()).
+    *Left-aligned text continues the text waiting in the buffer if it starts where it ends, and is split into multiple blocks if it doesn't fit
+    in one; right-aligned or centered text is limited to a single block.
 */
-void TLBFISLib::setBitmapTransparency(transparency bitmap_transparency)
+TLBFISLib::status TLBFISLib::printAt(uint8_t startX, uint8_t startY, const char* format, ...)
 {
-  if (bitmap_transparency == TRANSPARENT) { //selecting the transparent bitmap option
-    //Set bit0.
-    _bmp |= _bmp_transparent;
-  }
-  else { //selecting the opaque bitmap option
-    //Unset bit0.
-    _bmp &= ~_bmp_transparent;
-  }
+  va_list args;
+  va_start(args, format);
+  status result = vprint_at(startX, startY, format, args, false);
+  va_end(args);
+  
+  return result;
+}
+
+TLBFISLib::status TLBFISLib::printAt_P(uint8_t startX, uint8_t startY, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  status result = vprint_at(startX, startY, format, args, true);
+  va_end(args);
+  
+  return result;
 }
 
 /**
   Function:
-    drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t bitmap[], (bool fromPGM))
+    writeMultiLineText(uint8_t startX, uint8_t startY, (const)char/uint8_t message[], (bool fromPGM))
   
   Parameters:
-    startX, startY -> the coordinates of the the bitmap's top-left pixel
-    width, height  -> width and height of the bitmap, in pixels
-    bitmap[]       -> the bitmap that will be printed
-    (fromPGM)      -> whether or not the bitmap is stored in PROGMEM
+    startX, startY -> coordinates of the string (top-left pixel)
+    (length)       -> provide this parameter if printing less characters than the entire string or using an unterminated character array
+    message[]      -> the string to write
+    (fromPGM)      -> whether or not the string is stored in PROGMEM
   
   Default parameters:
     (fromPGM = false)
   
   Returns:
-    bool -> whether or not the bitmap was transmitted entirely
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
   
   Description:
-    *Draws a bitmap.
+    Splits a string containing newline characters and prints the substrings at incrementing Y coordinates.
   
   Notes:
-    *The width parameter must be the actual width of the given bitmap.
-    *The height parameter must be less than or equal to the actual height.
-    *To only draw part of a bitmap, set a workspace smaller than it before drawing.
-    *If drawing a bitmap smaller than the entire screen, it's more efficient to set a workspace the size of the bitmap first.
+    *The spacing between rows can be changed with setLineSpacing().
+    *For the GRAPHICS font, use the special character GRAPHICS_NEWLINE to separate lines instead of '\n'.
 */
-void TLBFISLib::drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM)
+TLBFISLib::status TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM)
 {
-  //Constrain the bitmap's height, so no more lines than fit on the screen are sent.
-  if (height > current_H - startY) {
-    height = current_H - startY;
-  }
+  //Call the private function, which takes a character array (char[]).
+  return _writeMultiLineText(startX, startY, (char*)message, fromPGM);
+}
+
+TLBFISLib::status TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, char* message)
+{
+  //Call the private function.
+  return _writeMultiLineText(startX, startY, message);
+}
+
+TLBFISLib::status TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM)
+{
+  //Call the private function, which takes a character array (char[]).
+  return _writeMultiLineText(startX, startY, (char*)message, fromPGM);
+}
+
+TLBFISLib::status TLBFISLib::writeMultiLineText(uint8_t startX, uint8_t startY, uint8_t* message)
+{
+  //Call the private function, which takes a character array (char[]).
+  return _writeMultiLineText(startX, startY, (char*)message);
+}
+
+/**
+  Function:
+    writeRadioText(bool line, (size_t length), (const)char/uint8_t message[], (bool fromPGM))
   
-  //Constrain the X coordinate to the screen/workspace width.
-  startX %= current_W;
+  Parameters:
+    line      -> which line to write the string to (0/1)
+    (length)  -> provide this parameter if printing less characters than the entire string or using an unterminated character array
+    message[] -> the string to write
+    (fromPGM) -> whether or not the string is stored in PROGMEM
   
-  //Calculate how many bytes of data a single line needs.
-  uint8_t total_bytes_per_line = ((current_W - startX + 7) / 8);
+  Default parameters:
+    (fromPGM = false)
   
-  //If there is nothing to draw, exit.
-  if (!bitmap || !height || !width || !total_bytes_per_line) {
-    return;
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Writes a string in radio mode.
+*/
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, size_t length, const char* message, bool raw, bool fromPGM)
+{
+  return _writeRadioText(line, length, (uint8_t*)message, raw, fromPGM);
+}
+
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, const char* message, bool raw, bool fromPGM)
+{
+  return writeRadioText(line, (const uint8_t*)message, raw, fromPGM);
+}
+
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, char* message, bool raw)
+{
+  return writeRadioText(line, (uint8_t*)message, raw);
+}
+
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, size_t length, char* message, bool raw)
+{
+  return _writeRadioText(line, length, (uint8_t*)message, raw);
+}
+
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, size_t length, const uint8_t* message, bool raw, bool fromPGM)
+{
+  return _writeRadioText(line, length, (uint8_t*)message, raw, fromPGM);
+}
+
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, const uint8_t* message, bool raw, bool fromPGM)
+{
+  size_t length;
+  
+  if (fromPGM)
+  {
+    length = strlen_P((const char*)message);
+  }
+  else
+  {
+    length = strlen((const char*)message);
   }
   
+  return _writeRadioText(line, length, (uint8_t*)message, raw, fromPGM);
+}
+
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, uint8_t* message, bool raw)
+{
+  size_t length = strlen((char*)message);
+  
+  return _writeRadioText(line, length, message, raw);
+}
+
+TLBFISLib::status TLBFISLib::writeRadioText(bool line, size_t length, uint8_t* message, bool raw)
+{
+  return _writeRadioText(line, length, message, raw);
+}
+
+/**
+  Function:
+    writeRadioRawData(uint8_t data[])
+  
+  Parameters:
+    data[] -> array of bytes to send
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Sends raw data in radio mode.
+  
+  Notes:
+    *The "data" array must contain 18 bytes.
+    *This function is useful when fetching data from the original radio in order to display it without text processing.
+*/
+TLBFISLib::status TLBFISLib::writeRadioRawData(uint8_t* data)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_WRITE_RADIO_RAW_DATA);
+  
+  //If an invalid array was provided, exit.
+  if (!data)
+  {
+    return SENT;
+  }
+  
+  //Add the radio message header to the buffer.
+  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, radio_byte, true);
+  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0x11);
+  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0xF0);
+  
+  //Add the raw data without the header and original checksum.
+  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, data + 1, 16);
+  
+  //Send the buffer.
+  return send_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length);
+}
+
+/**
+  Function:
+    clearRadioText()
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Clears the radio mode section of the screen.
+*/
+TLBFISLib::status TLBFISLib::clearRadioText()
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_CLEAR_RADIO_TEXT);
+  
+  wipe_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length);
+  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, radio_byte);
+  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0x11);
+  add_to_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length, 0xF0);
+  return send_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length);
+}
+
+/**
+  Function:
+    fixNumberPadding(char/uint8_t message[])
+  
+  Parameters:
+    message[] -> the string to modify
+  
+  Description:
+    Replaces regular space characters with spaces as wide as the digit characters in the selected font.
+  
+  Notes:
+    *This should be called after formatting number strings with something like sprintf(), before writing them to the screen.
+*/
+void TLBFISLib::fixNumberPadding(uint8_t* message)
+{
+  //Call the function which takes a character array (char[]).
+  fixNumberPadding((char*)message);
+}
+
+void TLBFISLib::fixNumberPadding(char* message)
+{
+  //For the STANDARD font (and technically for the GRAPHICS font as well), the default space character is already the same size as the digit characters.
+  if (!(_font & _text_compact)) {
+    return;
+  }
+  
+  //Calculate the character count of the input string.
+  uint8_t length = strlen(message);
+  
+  //Navigate each character of the string.
+  for (uint8_t i = 0; i < length; i++) {
+    //If the current character is a space, replace it.
+    if (message[i] == ' ') {
+      //SPACE_5PX is as wide as a digit character.
+      message[i] = SPACE_5PX[0];
+    }
+  }
+}
+
+/**
+  Function:
+    charWidth(char/uint8_t message)
+  
+  Parameters:
+    message -> character whose width to calculate
+  
+  Returns:
+    uint8_t -> width of the given character (in pixels)
+  
+  Description:
+    Calculates the pixel width of a given character, according to the currently selected font.
+*/
+uint8_t TLBFISLib::charWidth(char message)
+{
+  //Call the private function, which takes a byte (uint8_t).
+  return _charWidth((uint8_t)message);
+}
+
+uint8_t TLBFISLib::charWidth(uint8_t message)
+{
+  //Call the private function.
+  return _charWidth(message);
+}
+
+/**
+  Function:
+    stringWidth((const)char/uint8_t message[], (size_t length), (bool fromPGM))
+  
+  Parameters:
+    message[] -> string whose width to calculate
+    (length)  -> provide this parameter if calculating the width of less than the entire string or using an unterminated character array
+    (fromPGM) -> whether or not the string is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Returns:
+    uint16_t -> width of the given string (in pixels)
+  
+  Description:
+    Calculates the pixel width of a given string, according to the currently selected font.
+*/
+uint16_t TLBFISLib::stringWidth(size_t length, const char* message, bool fromPGM)
+{
+  //Call the private function, which takes a byte array (uint8_t[]).
+  return _stringWidth((uint8_t*)message, length, fromPGM);
+}
+
+uint16_t TLBFISLib::stringWidth(const char* message, bool fromPGM)
+{
+  //Call the function which takes a constant byte array (const uint8_t[]).
+  return stringWidth((const uint8_t*)message, fromPGM);
+}
+
+uint16_t TLBFISLib::stringWidth(char* message)
+{
+  //Call the function which takes a byte array (uint8_t[]).
+  return stringWidth((uint8_t*)message);
+}
+
+uint16_t TLBFISLib::stringWidth(size_t length, char* message)
+{
+  //Call the private function, which takes a byte array (uint8_t[]).
+  return _stringWidth((uint8_t*)message, length);
+}
+
+uint16_t TLBFISLib::stringWidth(size_t length, const uint8_t* message, bool fromPGM)
+{
+  //Call the private function, which takes a byte array (uint8_t[]).
+  return _stringWidth((uint8_t*)message, length, fromPGM);
+}
+
+uint16_t TLBFISLib::stringWidth(const uint8_t* message, bool fromPGM)
+{
+  //Will contain the calculated string length.
+  size_t length;
+  
+  //Calculate the string length.
+  if (fromPGM) {
+    length = strlen_P((const char*)message);
+  }
+  else {
+    length = strlen((const char*)message);
+  }
+  
+  //Call the private function, which takes a byte array (uint8_t[]), providing the calculated length.
+  return _stringWidth((uint8_t*)message, length, fromPGM);
+}
+
+uint16_t TLBFISLib::stringWidth(uint8_t* message)
+{
+  //Calculate the string length.
+  size_t length = strlen((const char*)message);
+  
+  //Call the private function, providing the calculated length.
+  return _stringWidth(message, length);
+}
+
+uint16_t TLBFISLib::stringWidth(size_t length, uint8_t* message)
+{
+  //Call the private function.
+  return _stringWidth(message, length);
+}
+
+/**
+  Function:
+    toggleHighlight(uint8_t startY)
+  
+  Parameters:
+    startY -> the vertical coordinate of the line to be (un)highlighted
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Toggles the highlighting of an entire line of text.
+*/
+TLBFISLib::status TLBFISLib::toggleHighlight(uint8_t startY)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_TOGGLE_HIGHLIGHT);
+  
+  //Save the current font and color settings to reapply afterwards.
+  uint8_t prev_font = _font;
+  uint8_t prev_bmp = _bmp;
+  bool prev_draw_color = _draw_color;
+  
+  //Set the drawing options.
+  setFont(GRAPHICS);
+  setTextAlignment(LEFT);
+  setDrawColor(INVERTED);
+  setTextTransparency(TRANSPARENT);
+  
+  //Send the highlight message (11 solid rectangles to fill the line).
+  status result = writeText(0, startY, TLBFIS_HIGHLIGHT, true);
+  
+  //Reapply previous font and color settings.
+  _font = prev_font;
+  _bmp = prev_bmp;
+  _draw_color = prev_draw_color;
+  return result;
+}
+
+/**
+  Function:
+    setBitmapTransparency(transparency bitmap_transparency)
+  
+  Parameters:
+    bitmap_transparency -> which transparency to use (OPAQUE/TRANSPARENT)
+  
+  Description:
+    *Sets the transparency for subsequent bitmap commands.
+*/
+void TLBFISLib::setBitmapTransparency(transparency bitmap_transparency)
+{
+  if (bitmap_transparency == TRANSPARENT) { //selecting the transparent bitmap option
+    //Set bit0.
+    _bmp |= _bmp_transparent;
+  }
+  else { //selecting the opaque bitmap option
+    //Unset bit0.
+    _bmp &= ~_bmp_transparent;
+  }
+}
+
+/**
+  Function:
+    drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t bitmap[], (bool fromPGM))
+  
+  Parameters:
+    startX, startY -> the coordinates of the the bitmap's top-left pixel
+    width, height  -> width and height of the bitmap, in pixels
+    bitmap[]       -> the bitmap that will be printed
+    (fromPGM)      -> whether or not the bitmap is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    *Draws a bitmap.
+  
+  Notes:
+    *The width parameter must be the actual width of the given bitmap.
+    *The height parameter must be less than or equal to the actual height.
+    *To only draw part of a bitmap, set a workspace smaller than it before drawing.
+    *If drawing a bitmap smaller than the entire screen, it's more efficient to set a workspace the size of the bitmap first.
+*/
+TLBFISLib::status TLBFISLib::drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_BITMAP);
+  
+  //Constrain the bitmap's height, so no more lines than fit on the screen are sent.
+  if (height > current_H - startY) {
+    height = current_H - startY;
+  }
+  
+  //Constrain the X coordinate to the screen/workspace width.
+  startX %= current_W;
+  
+  //Calculate how many bytes of data a single line needs.
+  uint8_t total_bytes_per_line = ((current_W - startX + 7) / 8);
+  
+  //If there is nothing to draw, exit.
+  if (!bitmap || !height || !width || !total_bytes_per_line) {
+    return SENT;
+  }
+  
+  //Send every line of the bitmap, padded up to the right edge of the workspace.
+  return send_bitmap_rows(startX, startY, total_bytes_per_line, bitmap, (width + 7) / 8, height, fromPGM);
+}
+
+/**
+  Function:
+    drawBitmapOptimized(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t bitmap[], (bool fromPGM))
+  
+  Parameters:
+    startX, startY -> the coordinates of the the bitmap's top-left pixel
+    width, height  -> width and height of the bitmap, in pixels
+    bitmap[]       -> the bitmap that will be printed
+    (fromPGM)      -> whether or not the bitmap is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = true)
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    *Draws a bitmap, like drawBitmap(), but estimates the cost of every way of encoding it and sends the cheapest combination of commands.
+  
+  Notes:
+    *Rows of a single color are sent as fills (or skipped entirely, if they would not change anything), and the remaining rows as bitmap blocks.
+    *In transparent mode, if the bitmap is narrower than the workspace, the workspace may be temporarily shrunk around it, so fewer bytes are sent
+    for every line; in opaque mode, drawBitmap() clears the area between the bitmap and the right edge of the workspace, so every row is drawn (or
+    filled) up to that edge as well.
+    *The estimate counts the bytes of every command, plus TLB_BLOCK_OVERHEAD for every block; scanning the bitmap takes some time, so for small bitmaps
+    which are drawn very often, drawBitmap() may still be the better choice.
+    *The result on the screen is the same as with drawBitmap(), including the unused bits of the last byte of every line.
+*/
+TLBFISLib::status TLBFISLib::drawBitmapOptimized(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_BITMAP_OPTIMIZED);
+  
+  //If the bitmap starts outside the workspace, exit.
+  if (startY >= current_H) {
+    return SENT;
+  }
+  
+  //Constrain the bitmap's height, so no more lines than fit on the screen are sent.
+  if (height > current_H - startY) {
+    height = current_H - startY;
+  }
+  
+  //Constrain the X coordinate to the screen/workspace width.
+  startX %= current_W;
+  
+  //If there is nothing to draw, exit.
+  if (!bitmap || !height || !width) {
+    return SENT;
+  }
+  
+  //Determine how rows of a single color can be drawn with the current bitmap options.
+  bool transparent = (_bmp & _bmp_transparent);
+  bool inverted = !(_bmp & _bmp_or_output);
+  
+  //drawBitmap() sends whole bytes of the bitmap, padded with zeroes up to the right edge of the workspace.
+  //In opaque mode, the padding is drawn as well, so the lines always reach the edge; in transparent mode, it doesn't change anything.
+  uint8_t width_in_bytes = (width + 7) / 8; //convert the width from pixels into bytes (1 byte = 8 pixels)
+  uint8_t line_width = current_W - startX; //how many pixels of each line are drawn
+  if (transparent && width_in_bytes * 8 < line_width) {
+    line_width = width_in_bytes * 8;
+  }
+  uint8_t line_bytes = (line_width + 7) / 8; //how many bytes of each line contain drawn pixels
+  uint8_t last_byte_mask = 0xFF << ((8 - (line_width % 8)) % 8); //which bits of the last byte are inside the workspace
+  
+  //Classify every row of the bitmap (the screen is at most 88 pixels tall).
+  uint8_t actions[88];
+  for (uint8_t row = 0; row < height; row++) {
+    //Check if every drawn pixel of the row has the same value (the padding is made of zeroes).
+    bool all_clear = true, all_set = true;
+    for (uint8_t i = 0; i < line_bytes; i++) {
+      uint8_t mask = (i == line_bytes - 1) ? last_byte_mask : 0xFF;
+      uint8_t data = (i >= width_in_bytes) ? 0 : (fromPGM ? pgm_read_byte_near(bitmap + row * width_in_bytes + i) : bitmap[row * width_in_bytes + i]);
+      data &= mask;
+      
+      if (data) {
+        all_clear = false;
+      }
+      if (data != mask) {
+        all_set = false;
+      }
+    }
+    
+    //Rows containing both colors can only be sent as a bitmap.
+    if (!all_clear && !all_set) {
+      actions[row] = ROW_BITMAP;
+    }
+    //In transparent mode, empty rows don't change the screen, and full rows can be filled unless they are XOR-ed.
+    else if (transparent) {
+      actions[row] = all_clear ? ROW_SKIP : (inverted ? ROW_BITMAP : ROW_FILL_ON);
+    }
+    //In opaque mode, every row of a single color can be filled (with the opposite color if inverted).
+    else {
+      actions[row] = (all_set != inverted) ? ROW_FILL_ON : ROW_FILL_OFF;
+    }
+  }
+  
+  //Estimate the cost of sending lines padded up to the right edge of the workspace, like drawBitmap() does.
+  uint8_t full_bytes_per_line = (current_W - startX + 7) / 8;
+  uint16_t full_cost = plan_bitmap_rows(actions, height, full_bytes_per_line, false, false);
+  
+  //Estimate the cost of shrinking the workspace around the drawn pixels, so only their bytes are sent for every line.
+  uint16_t narrow_cost = plan_bitmap_rows(actions, height, line_bytes, true, false);
+  
+  //Choose the cheapest option, and decide for every row how it will be sent.
+  bool narrow = (narrow_cost < full_cost);
+  uint8_t bytes_per_line = narrow ? line_bytes : full_bytes_per_line;
+  plan_bitmap_rows(actions, height, bytes_per_line, narrow, true);
+  
+  //If the workspace is shrunk, the bitmap's rows are sent relative to it.
+  uint8_t bitmap_X = narrow ? 0 : startX;
+  uint8_t bitmap_Y = narrow ? 0 : startY;
+  
+  //Send the rows which were kept as a bitmap.
+  bool workspace_shrunk = false;
+  for (uint8_t row = 0; row < height;) {
+    //Find the end of the current run of rows with the same action.
+    uint8_t end = row + 1;
+    while (end < height && actions[end] == actions[row]) {
+      end++;
+    }
+    
+    if (actions[row] == ROW_BITMAP) {
+      //Shrink the workspace before sending the first bitmap block.
+      if (narrow && !workspace_shrunk) {
+        //1. Command byte (clear/claim area); true = also clear the buffer
+        add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
+        //2. Command length (always 5)
+        add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
+        //3. Command options (0x00 = change workspace without clearing)
+        add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x00);
+        //4. X coordinate
+        add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_X + startX);
+        //5. Y coordinate
+        add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_Y + startY);
+        //6. Width
+        add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, line_width);
+        //7. Height
+        add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, height);
+        //Send, exiting if it fails.
+        status result = send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+        if (result != SENT) {
+          _workspace_modified = true;
+          return result;
+        }
+        
+        //The bitmap blocks must be sent relative to the shrunk workspace, so it's only marked as modified after all of them.
+        _workspace_modified = false;
+        workspace_shrunk = true;
+      }
+      
+      //Send the rows, exiting if it fails.
+      status result = send_bitmap_rows(bitmap_X, bitmap_Y + row, bytes_per_line, bitmap + row * width_in_bytes, width_in_bytes, end - row, fromPGM);
+      if (result != SENT) {
+        _workspace_modified = workspace_shrunk;
+        return result;
+      }
+    }
+    
+    row = end;
+  }
+  
+  //The shrunk workspace will be restored before the next command which depends on it.
+  if (workspace_shrunk) {
+    _workspace_modified = true;
+  }
+  
+  //Send the rows which were chosen to be filled; fills use absolute coordinates, so they don't depend on the workspace.
+  for (uint8_t row = 0; row < height;) {
+    //Find the end of the current run of rows with the same action.
+    uint8_t end = row + 1;
+    while (end < height && actions[end] == actions[row]) {
+      end++;
+    }
+    
+    if (actions[row] == ROW_FILL_ON || actions[row] == ROW_FILL_OFF) {
+      //Fill the rows, exiting if it fails.
+      status result = fill_area(current_X + startX, current_Y + startY + row, line_width, end - row, actions[row] == ROW_FILL_ON);
+      if (result != SENT) {
+        return result;
+      }
+    }
+    
+    row = end;
+  }
+  
+  return SENT;
+}
+
+/**
+  Function:
+    drawBitmapStream(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, bitmapRowFunction_type function, (bool grayscale))
+  
+  Parameters:
+    startX, startY -> the coordinates of the bitmap's top-left pixel
+    width, height  -> width and height of the bitmap, in pixels
+    function       -> function which provides the rows ("bool bitmapRowFunction(uint8_t row, uint8_t* data, uint8_t length)")
+    (grayscale)    -> whether the function provides one byte per pixel (0 = off, 255 = on), which the library dithers, instead of packed rows
+  
+  Default parameters:
+    (grayscale = false)
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED if a block was given up on or the function returned false, TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    *Draws a bitmap without keeping it in memory: the function is asked for every row, from top to bottom, right when it's added to a block.
+  
+  Notes:
+    *The function receives the row's index (0 = the first row of the bitmap) and must fill "length" bytes of data[]: packed rows have the same
+    format as a row of drawBitmap() (8 pixels per byte, the most significant bit on the left); grayscale rows have one byte per pixel.
+    *Only the part of the row which fits in the workspace is requested, so "length" may be shorter than the row; rows below the workspace are
+    not requested at all.
+    *Packed rows are written straight into the block being built, so the only memory used is the library's own transmit buffer; grayscale rows
+    use a temporary row of up to 64 bytes.
+    *Grayscale rows are converted with ordered (4x4 Bayer) dithering, aligned to the screen, so bitmaps drawn next to each other continue the
+    same pattern; a value of 128 lights half of the pixels.
+    *If the function returns false (for example if its source fails), nothing more is sent and FAILED is returned; the rows which were already
+    sent stay on the screen.
+    *The function must not call the library's drawing functions, since the block being built is the library's own.
+*/
+TLBFISLib::status TLBFISLib::drawBitmapStream(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, bitmapRowFunction_type function, bool grayscale)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_BITMAP_STREAM);
+  
+  //Constrain the bitmap's height, so no more lines than fit on the screen are requested.
+  if (startY >= current_H) {
+    return SENT;
+  }
+  if (height > current_H - startY) {
+    height = current_H - startY;
+  }
+  
+  //Constrain the X coordinate to the screen/workspace width.
+  startX %= current_W;
+  
+  //Calculate how many bytes of data a single line needs.
+  uint8_t bytes_per_line = ((current_W - startX + 7) / 8);
+  
+  //If there is nothing to draw, exit.
+  if (!function || !height || !width || !bytes_per_line) {
+    return SENT;
+  }
+  
+  //Only the pixels which fit in the lines are requested.
+  uint8_t row_width = (width < bytes_per_line * 8) ? width : bytes_per_line * 8;
+  
+  //The header (present in every block) has a size of 5, so 5 subtracted from the block size is the number of bytes free for the pixel data.
+  uint8_t lines_per_block = (_block_size - 5) / bytes_per_line;
+  
+  //Construct and send each block.
+  for (uint8_t row = 0; row < height;) {
+    uint8_t lines = height - row;
+    if (lines > lines_per_block) {
+      lines = lines_per_block;
+    }
+    
+    //Fill the transmission block with zeroes, so the right side of every line is padded.
+    wipe_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length);
+    
+    //Add bytes to the transmit buffer for sending bitmap graphics.
+    //1. Command byte (bitmap graphics)
+    add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, bitmap_byte);
+    //2. Command length (the data plus the option, X and Y bytes)
+    add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, uint8_t(lines * bytes_per_line + 3));
+    //3. Command options (bitmap mode)
+    add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, _bmp);
+    //4. X coordinate
+    add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, startX);
+    //5. Y coordinate
+    add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, uint8_t(startY + row));
+    
+    //Let the function fill every line of the block, exiting if it can't.
+    for (uint8_t line = 0; line < lines; line++, row++) {
+      if (!read_stream_row(function, row, _bitmap_command_buffer + _bitmap_command_buffer_length, current_X + startX, current_Y + startY + row, row_width, grayscale)) {
+        return FAILED;
+      }
+      _bitmap_command_buffer_length += bytes_per_line;
+    }
+    
+    //Send the transmit buffer, exiting if it fails.
+    status result = send_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length);
+    if (result != SENT) {
+      return result;
+    }
+  }
+  
+  return SENT;
+}
+
+/**
+  Function:
+    invertRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height)
+  
+  Parameters:
+    startX, startY -> coordinates of the top-left corner of the rectangle
+    width, height  -> dimensions of the rectangle
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Inverts every pixel inside a rectangle, without redrawing what's underneath (calling it again restores the original content).
+  
+  Notes:
+    *The workspace is clipped to the rectangle, which is then covered either with solid characters of the GRAPHICS font or with a solid bitmap, both
+    in transparent XOR mode; the cheaper one (in bytes on the bus) is chosen for the rectangle's size.
+    *Wide, short rectangles (highlighted buttons, cells, text lines) take a single text block; narrow, tall ones are sent as a bitmap.
+*/
+TLBFISLib::status TLBFISLib::invertRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_INVERT_RECT);
+  
+  //Constrain the rectangle to the workspace.
+  if (startX >= current_W || startY >= current_H) {
+    return SENT;
+  }
+  if (width > current_W - startX) {
+    width = current_W - startX;
+  }
+  if (height > current_H - startY) {
+    height = current_H - startY;
+  }
+  
+  //If there is nothing to invert, exit.
+  if (!width || !height) {
+    return SENT;
+  }
+  
+  //Estimate the cost of covering the rectangle with characters: one text block for every line of characters.
+  uint8_t chars_per_line = (width + 5) / 6;
+  uint8_t char_lines = (height + 6) / 7;
+  uint16_t text_cost = char_lines * (5 + chars_per_line + TLB_BLOCK_OVERHEAD);
+  
+  //Estimate the cost of covering the rectangle with a bitmap: as many lines as fit in each block.
+  uint8_t bytes_per_line = (width + 7) / 8;
+  uint8_t lines_per_block = (_block_size - 5) / bytes_per_line;
+  uint8_t bitmap_blocks = (height + lines_per_block - 1) / lines_per_block;
+  uint16_t bitmap_cost = bitmap_blocks * (5 + TLB_BLOCK_OVERHEAD) + height * bytes_per_line;
+  
+  //Text waiting to be merged must be sent before the workspace is clipped.
+  status result = flush();
+  if (result != SENT) {
+    return result;
+  }
+  
+  //Clip the workspace to the rectangle, so the characters/bitmap don't spill outside of it, exiting if it fails.
+  result = clip_area(current_X + startX, current_Y + startY, width, height);
+  if (result != SENT) {
+    return result;
+  }
+  
+  //The clipped workspace must be kept for the following blocks; it will be restored before the next command that depends on it.
+  _workspace_modified = false;
+  
+  if (text_cost <= bitmap_cost) {
+    for (uint8_t line = 0; line < char_lines && result == SENT; line++) {
+      //Add bytes to the transmit buffer for sending the text data.
+      //1. Command byte (write text); true = also clear the buffer
+      add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, write_byte, true);
+      //2. Command length (number of characters + 3)
+      add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, chars_per_line + 3);
+      //3. Command options (GRAPHICS font, XOR output, transparent)
+      add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, _text_graphics | _text_transparent);
+      //4. X coordinate
+      add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, 0);
+      //5. Y coordinate
+      add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, line * 7);
+      //Data bytes (solid characters, the same as TLBFIS_HIGHLIGHT)
+      for (uint8_t i = 0; i < chars_per_line; i++) {
+        add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, 0x3A);
+      }
+      //Send
+      result = send_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length);
+    }
+  }
+  else {
+    //Send a solid bitmap in XOR mode, repeating the same line (8 bytes cover the entire width of the screen).
+    static const uint8_t solid_line[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t prev_bmp = _bmp;
+    _bmp = _bmp_transparent;
+    result = send_bitmap_rows(0, 0, bytes_per_line, solid_line, bytes_per_line, height, false, true);
+    _bmp = prev_bmp;
+  }
+  
+  //The workspace is now clipped.
+  _workspace_modified = true;
+  return result;
+}
+
+/**
+  Function:
+    drawSegment(uint8_t startX, uint8_t startY, uint8_t endX, uint8_t endY)
+  
+  Parameters:
+    startX, startY -> coordinates of one end of the line
+    endX, endY     -> coordinates of the other end of the line
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Draws a straight line between any two points.
+  
+  Notes:
+    *Horizontal and vertical lines are drawn like drawLine(), with a single command; other lines are rasterized and sent as transparent bitmaps
+    covering only the rows they pass through.
+    *With the INVERTED draw color, slanted lines toggle the pixels they cover (see drawPolygon()).
+*/
+TLBFISLib::status TLBFISLib::drawSegment(uint8_t startX, uint8_t startY, uint8_t endX, uint8_t endY)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_SEGMENT);
+  
+  //A line is a polygon with two points, which isn't closed.
+  uint8_t points[4] = {startX, startY, endX, endY};
+  return drawPolygon(points, 2, false);
+}
+
+/**
+  Function:
+    drawPolygon(const uint8_t points[], uint8_t count, (bool closed))
+  
+  Parameters:
+    points[] -> coordinates of the corners, as X, Y pairs
+    count    -> how many corners there are (the array has twice as many elements)
+    (closed) -> whether or not to connect the last corner to the first one
+  
+  Default parameters:
+    (closed = true)
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Draws the outline of a polygon (or a line passing through multiple points, if not closed).
+  
+  Notes:
+    *Horizontal and vertical edges are sent as fills; all other edges are rasterized together and sent as transparent bitmaps.
+    *With the INVERTED draw color (see setDrawColor()), the fills clear their pixels, but the bitmaps are sent in XOR mode, so slanted edges toggle
+    the pixels they cover: they are only cleared where the screen was lit.
+*/
+TLBFISLib::status TLBFISLib::drawPolygon(const uint8_t* points, uint8_t count, bool closed)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_POLYGON);
+  
+  //If there is nothing to draw, exit.
+  if (!points || !count) {
+    return SENT;
+  }
+  
+  raster_shape shape = {points, count, closed && count > 2, 0, 0, 0, 0, 0, {0, 0}, {0, 0}};
+  return draw_shape(shape);
+}
+
+/**
+  Function:
+    drawCircle(uint8_t centerX, uint8_t centerY, uint8_t radius)
+  
+  Parameters:
+    centerX, centerY -> coordinates of the center of the circle
+    radius           -> radius of the circle (in pixels)
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Draws the outline of a circle.
+  
+  Notes:
+    *The circle is rasterized and sent as transparent bitmaps; with the INVERTED draw color (see setDrawColor()), they toggle the pixels they cover.
+*/
+TLBFISLib::status TLBFISLib::drawCircle(uint8_t centerX, uint8_t centerY, uint8_t radius)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_CIRCLE);
+  
+  //A circle is an arc which goes all the way around.
+  raster_shape shape = {nullptr, 0, false, centerX, centerY, radius, 0, 360, {0, 0}, {0, 0}};
+  return draw_shape(shape);
+}
+
+/**
+  Function:
+    drawArc(uint8_t centerX, uint8_t centerY, uint8_t radius, uint16_t start_angle, uint16_t end_angle)
+  
+  Parameters:
+    centerX, centerY -> coordinates of the center of the circle
+    radius           -> radius of the circle (in pixels)
+    start_angle      -> where the arc starts (in degrees, clockwise from the top of the circle)
+    end_angle        -> where the arc ends (in degrees, clockwise from the top of the circle)
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Draws a part of the outline of a circle, going clockwise from start_angle to end_angle.
+  
+  Notes:
+    *For example, the scale of a gauge going from the bottom-left to the bottom-right is drawArc(X, Y, R, 225, 135).
+    *Like drawCircle(), the arc toggles the pixels it covers with the INVERTED draw color.
+*/
+TLBFISLib::status TLBFISLib::drawArc(uint8_t centerX, uint8_t centerY, uint8_t radius, uint16_t start_angle, uint16_t end_angle)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_ARC);
+  
+  //Bring the angles into the 0-360 range (360 is kept, so an arc from 0 to 360 is an entire circle).
+  start_angle %= 360;
+  if (end_angle > 360) {
+    end_angle %= 360;
+  }
+  
+  raster_shape shape = {nullptr, 0, false, centerX, centerY, radius, start_angle, end_angle, {0, 0}, {0, 0}};
+  
+  //Find the directions of the ends once, so the rasterizer only compares them with the pixels using integers.
+  shape.start_dir[0] = lround(sin(start_angle * M_PI / 180) * 1024);
+  shape.start_dir[1] = lround(cos(start_angle * M_PI / 180) * 1024);
+  shape.end_dir[0] = lround(sin(end_angle * M_PI / 180) * 1024);
+  shape.end_dir[1] = lround(cos(end_angle * M_PI / 180) * 1024);
+  
+  return draw_shape(shape);
+}
+
+/**
+  Function:
+    drawLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
+  
+  Parameters:
+    startX, startY -> the coordinates of the line's origin
+    length         -> the length of the line
+    orientation    -> the line's orientation (HORIZONTAL/VERTICAL)
+  
+  Default parameters:
+    filled = orientation = HORIZONTAL
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Draws a line.
+*/
+TLBFISLib::status TLBFISLib::drawLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_LINE);
+  
+  //Drawing a line is the same as clearing the screen, but with a width/height of one pixel.
+  //For this, the workspace will be changed, but it's restored to the previous area before the next command that depends on it.
+  
+  //Determine which dimension should be 1 depending on the line orientation.
+  uint8_t width  = ((orientation == HORIZONTAL) ? length : 1); //for VERTICAL, width=1
+  uint8_t height = ((orientation == HORIZONTAL) ? 1 : length); //for HORIZONTAL, height=1
+  
+  //Fill the line's area with the draw color.
+  return fill_area(current_X + startX, current_Y + startY, width, height, _draw_color == NORMAL);
+}
+
+/**
+  Function:
+    drawThinLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
+  
+  Parameters:
+    startX, startY -> the coordinates of the line's origin
+    length         -> the length of the line
+    orientation    -> the line's orientation (HORIZONTAL/VERTICAL)
+  
+  Default parameters:
+    filled = orientation = HORIZONTAL
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Draws a thin line on high-resolution displays.
+  
+  Notes:
+    *On standard-resolution displays, it draws a normal line.
+    *The thin line's color can not be changed and is not affected by the setDrawColor() command.
+*/
+TLBFISLib::status TLBFISLib::drawThinLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_THIN_LINE);
+  
+  //Add bytes to the transmit buffer for drawing a thin line.
+  //1. Command byte (clear/claim area); true = also clear the buffer
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, line_byte, true);
+  //2. Command length (always 4)
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 4);
+  //3. Command options (0x10=VERTICAL, 0x20=HORIZONTAL)
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, (orientation == VERTICAL) ? 0x10 : 0x20);
+  //4. X coordinate
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, startX);
+  //5. Y coordinate
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, startY);
+  //6. Length
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, length);
+  //Send
+  return send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+}
+
+/**
+  Function:
+    drawRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, rectangleType filled)
+  
+  Parameters:
+    startX, startY -> the coordinates of the rectangle's origin (top-left pixel)
+    width, height  -> the dimensions of the rectangle
+    filled         -> whether the rectangle is only a border or a solid shape (NOT_FILLED/FILLED)
+  
+  Default parameters:
+    filled = NOT_FILLED
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise (see setRetryPolicy())
+  
+  Description:
+    Draws a rectangle.
+*/
+TLBFISLib::status TLBFISLib::drawRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, rectangleType filled)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_DRAW_RECT);
+  
+  //Drawing a rectangle is the same operation as clearing the screen, so the workspace must be restored before the next command that depends on it.
+  
+  //Fill the whole area with the border color, exiting if it fails.
+  status result = fill_area(current_X + startX, current_Y + startY, width, height, _draw_color == NORMAL);
+  if (result != SENT) {
+    return result;
+  }
+  
+  //Rectangles that are not filled are achieved by drawing a smaller rectangle inside, so only the border remains visible.
+  if (filled == NOT_FILLED) {
+    return fill_area(current_X + startX + 1, current_Y + startY + 1, width - 2, height - 2, _draw_color != NORMAL);
+  }
+  
+  return SENT;
+}
+
+///PRIVATE
+
+/**
+  Function:
+    add_to_tx_buffer(uint8_t tx_buffer[], uint8_t tx_buffer_size, uint8_t &tx_buffer_index, (const) uint8_t data[], uint8_t length, bool clear_buffer, (bool fromPGM))
+  
+  Parameters:
+    tx_buffer[]     -> buffer to add the bytes to
+    tx_buffer_size  -> total size of the buffer
+    tx_buffer_index -> current position in the buffer
+    data[]          -> array of bytes to add to the buffer
+    length          -> how many bytes from the array to add
+    clear_buffer    -> whether or not to start the buffer from the beginning when adding the bytes
+    (fromPGM)       -> whether or not the byte array is stored in PROGMEM
+  
+  Default parameters:
+    clear_buffer = false
+    (fromPGM) = false
+  
+  Description:
+    Adds bytes from the given array to the transmission buffer.
+*/
+void TLBFISLib::add_to_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index, const uint8_t* data, uint8_t length, bool clear_buffer, bool fromPGM)
+{
+  //Call the function which takes a byte array (uint8_t[]).
+  add_to_tx_buffer(tx_buffer, tx_buffer_size, tx_buffer_index, (uint8_t*)data, length, clear_buffer, fromPGM);
+}
+
+void TLBFISLib::add_to_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index, uint8_t* data, uint8_t length, bool clear_buffer, bool fromPGM)
+{
+  //If clearing was requested, set the buffer index to 0.
+  if (clear_buffer) {
+    tx_buffer_index = 0;
+  }
+  
+  //Calculate how much free space there is in the transmit buffer.
+  uint8_t free_space = tx_buffer_size - tx_buffer_index;
+  
+  //Calculate how many bytes will be copied into the transmit buffer.
+  uint8_t bytes_to_copy = (length < free_space) ? length : free_space;
+  
+  //If there is anything to copy, put the data into the transmit buffer.
+  if (bytes_to_copy) {
+    if (fromPGM) {
+      memcpy_P(tx_buffer + tx_buffer_index, data, bytes_to_copy);
+    }
+    else {
+      memcpy(tx_buffer + tx_buffer_index, data, bytes_to_copy);
+    }
+    
+    //Increment the buffer length with however many bytes were added.
+    tx_buffer_index += bytes_to_copy;
+  }
+}
+
+/**
+  Function:
+    add_to_tx_buffer(uint8_t data, bool clear_buffer)
+  
+  Parameters:
+    tx_buffer[]     -> buffer to add the byte to
+    tx_buffer_size  -> total size of the buffer
+    tx_buffer_index -> current position in the buffer
+    data            -> byte to add to the buffer
+    clear_buffer    -> whether or not to start the buffer from the beginning when adding the bytes
+  
+  Default parameters:
+    clear_buffer = false
+  
+  Description:
+    Adds a byte to the transmission buffer.
+*/
+void TLBFISLib::add_to_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index, uint8_t data, bool clear_buffer)
+{
+  //If clearing was requested, set the buffer index to 0.
+  if (clear_buffer) {
+    tx_buffer_index = 0;
+  }
+  
+  //Calculate how much free space there is in the transmit buffer.
+  uint8_t free_space = tx_buffer_size - tx_buffer_index;
+  
+  //Determine whether or not anything needs to be copied into the transmit buffer.
+  bool bytes_to_copy = (free_space >= 1);
+  
+  //If there is anything to copy, put the data into the transmit buffer.
+  if (bytes_to_copy) {
+    tx_buffer[tx_buffer_index] = data;
+    
+    //Increment the buffer length.
+    tx_buffer_index++;
+  }
+}
+
+/**
+  Function:
+    wipe_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index)
+  
+  Parameters:
+    tx_buffer[]     -> buffer to wipe
+    tx_buffer_size  -> total size of the buffer
+    tx_buffer_index -> current position in the buffer
+  
+  Description:
+    Clears the transmit buffer by filling it with zeroes.
+*/
+void TLBFISLib::wipe_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index)
+{
+  //Fill the buffer with zeroes.
+  memset(tx_buffer, 0, tx_buffer_size);
+  
+  //Set the index to zero.
+  tx_buffer_index = 0;
+}
+
+/**
+  Function:
+    send_tx_buffer()
+  
+  Parameters:
+    tx_buffer[]     -> buffer to be sent
+    tx_buffer_size  -> total size of the buffer
+    tx_buffer_index -> current position in the buffer
+  
+  Returns:
+    status -> SENT, FAILED or TIMED_OUT, according to the retry policy
+  
+  Description:
+    Sends the transmission buffer.
+  
+  Notes:
+    *While a TLBFISBus is serving this instance, a block which the cluster doesn't accept within the bus slice is given up on (TIMED_OUT), along
+    with all following blocks of the turn, so that the other clusters can use the bus.
+    *Nothing reaches the screen when the turn is given up, so widgets whose change didn't send any block keep their content (see
+    TLBFISWidget::screen_untouched()), and the registered widgets which didn't get a turn are refreshed by the next one.
+*/
+TLBFISLib::status TLBFISLib::send_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index)
+{
+  (void) tx_buffer_size;
+  (void) tx_buffer_index;
+  
+  //Text kept for merging was queued when its first characters were written.
+  unsigned long enqueued = (tx_buffer == _text_command_buffer) ? _text_enqueued : micros();
+  
+  //Text waiting to be merged must be sent before any other command.
+  if (_text_pending && tx_buffer != _text_command_buffer) {
+    status result = flush();
+    if (result != SENT) {
+      return result;
+    }
+  }
+  
+  //If a fill has moved the workspace, restore it before sending any command that depends on it (radio text doesn't use the workspace).
+  if (_workspace_modified && tx_buffer[0] != clear_byte && tx_buffer[0] != radio_byte) {
+    status result = restore_workspace();
+    if (result != SENT) {
+      return result;
+    }
+  }
+  
+  //If a submission queue was set, leave the block to the task which transmits.
+  if (_submission_queue) {
+    return submit_block(tx_buffer, enqueued);
+  }
+  
+  //If a block send function was set, give it the entire block.
+  if (_block_send_function) {
+    return send_block(tx_buffer, enqueued);
+  }
+  
+  uint8_t failures = 0; //how many times the cluster reported an error for this block
+  uint8_t repeats = 0; //how many times the cluster wasn't ready for this block, for the adaptive pacing
+  uint8_t attempts = 0; //how many times the block was attempted, for increasing the backoff
+  unsigned long first_attempt = millis(); //when the block was first attempted, for the bus slice
+  unsigned long block_start = micros(); //when the block was first attempted, for the transport statistics
+  unsigned long paced = pace_block(); //when the pause before the block ended
+  
+  while (true)
+  {
+    //If the deadline of the current call has passed, give up.
+    if (deadline_passed()) {
+      record_given_up();
+      return TIMED_OUT;
+    }
+    
+    //If the cluster has kept a shared bus waiting for too long, give up the rest of its turn.
+    if (_bus_slice && (_bus_yielded || millis() - first_attempt >= _bus_slice)) {
+      _bus_yielded = true;
+      record_given_up();
+      return TIMED_OUT;
+    }
+    
+    unsigned long attempt_start = micros();
+    TLBLib::sendStatus answer = TLB.send(tx_buffer);
+    record_transport(answer, tx_buffer, block_start);
+    
+    switch (answer)
+    {
+      case TLBLib::FAIL:
+        //If the cluster reported too many errors, give up.
+        if (_max_failures && ++failures >= _max_failures) {
+          record_given_up();
+          return FAILED;
+        }
+        break;
+      
+      case TLBLib::SUCCESS:
+        record_opcode_latency(tx_buffer[0], enqueued);
+        record_pacing(repeats, paced, attempt_start);
+        _sent_blocks++;
+        return SENT;
+      
+      case TLBLib::REPEAT:
+        if (repeats < 0xFF) {
+          repeats++;
+        }
+        break;
+    }
+    
+    //Wait before trying again.
+    pace_retry(attempts);
+  }
+}
+
+/**
+  Function:
+    probe_block(uint8_t size)
+  
+  Parameters:
+    size -> total size of the block (in bytes)
+  
+  Returns:
+    status -> SENT if the cluster accepted the block, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Sends a bitmap block of the given size at the top-left corner of the workspace, with all pixels off and transparency enabled, so that it doesn't
+    change the screen.
+*/
+TLBFISLib::status TLBFISLib::probe_block(uint8_t size)
+{
+  //Fill the transmission block with zeroes, which are the pixel data.
+  wipe_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length);
+  
+  //Add bytes to the transmit buffer for sending the bitmap data.
+  //1. Command byte (bitmap)
+  add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, bitmap_byte);
+  //2. Command length (everything after the command and length bytes)
+  add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, uint8_t(size - 2));
+  //3. Command options (transparent, normal output)
+  add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, _bmp_transparent | _bmp_or_output);
+  //4. X coordinate
+  add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, 0);
+  //5. Y coordinate
+  add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, 0);
+  //Send, and wait for the answer if the block was handed to the block send function.
+  status result = send_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length);
+  return (result == SENT) ? wait_block_send() : result;
+}
+
+/**
+  Function:
+    deadline_scope(TLBFISLib &instance, (latencyCall call))
+  
+  Parameters:
+    instance -> the library instance whose call is starting
+    (call)   -> which public function is being called, for the latency histograms
+  
+  Default parameters:
+    (call = CALL_COUNT) -> not counted
+  
+  Description:
+    Marks the start of a call; the deadline set by setRetryPolicy() and the latency are measured from the start of the outermost call.
+*/
+TLBFISLib::deadline_scope::deadline_scope(TLBFISLib &instance, latencyCall call) :
+  lib(instance),
+  call(call),
+  start(micros())
+{
+  if (!lib._call_depth++) {
+    lib._call_start = millis();
+  }
+}
+
+TLBFISLib::deadline_scope::~deadline_scope()
+{
+  //Only the outermost call is counted (writeMultiLineText() calls writeText(), for example).
+  if (!--lib._call_depth && lib._latency && call < CALL_COUNT) {
+    lib.record_latency(lib._latency->call[call], start);
+  }
+}
+
+/**
+  Function:
+    refresh_widgets(lane widget_lane, unsigned long start)
+  
+  Parameters:
+    widget_lane -> which lane's widgets to refresh
+    start       -> when update() started (in milliseconds), for the budget
+  
+  Description:
+    Refreshes the registered widgets of a lane which are dirty and whose interval has passed, until the budget runs out.
+  
+  Notes:
+    *Once the cluster has given up its turn on a shared bus (see TLBFISBus::setSlice()), the remaining widgets are left dirty, as they are, for the
+    next turn.
+*/
+void TLBFISLib::refresh_widgets(lane widget_lane, unsigned long start)
+{
+  if (!_widgets) {
+    return;
+  }
+  
+  //Start with the widget after the last one which was refreshed.
+  TLBFISWidget* first = _widget_cursor[widget_lane] ? _widget_cursor[widget_lane] : _widgets;
+  TLBFISWidget* widget = first;
+  bool refreshed = false;
+  
+  do {
+    TLBFISWidget* next = widget->_next_widget ? widget->_next_widget : _widgets;
+    
+    if (widget->_lane == widget_lane && widget->is_due()) {
+      //Urgent widgets are always refreshed; the others only while the budget lasts, but at least one normal widget gets a turn. None of them are
+      //refreshed once the cluster has given up its turn on a shared bus.
+      bool budget_spent = _widget_budget && millis() - start >= _widget_budget;
+      if (_bus_yielded || (widget_lane != LANE_URGENT && budget_spent && (refreshed || widget_lane == LANE_BULK))) {
+        //The next call continues with this widget.
+        _widget_cursor[widget_lane] = widget;
+        return;
+      }
+      
+      widget->run_refresh();
+      refreshed = true;
+    }
+    
+    widget = next;
+  } while (widget != first);
+}
+
+/**
+  Function:
+    send_bulk()
+  
+  Returns:
+    status -> SENT if the blocks were sent (or there were none), FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Sends the next blocks of the queued bitmaps, up to the limit set by setBulkBlocksPerUpdate().
+  
+  Notes:
+    *Every block is sent with the workspace and the settings recorded by queueBitmap(); if the workspace differs from the current one, the
+    cluster's workspace is switched for the blocks and restored before the next command that depends on it.
+    *If a block fails, it's sent again by the next call.
+*/
+TLBFISLib::status TLBFISLib::send_bulk()
+{
+  //If there is nothing queued, there is nothing to do.
+  if (!_bulk_count) {
+    return SENT;
+  }
+  
+  //Text waiting to be merged belongs to the current workspace, so it must be sent before switching.
+  status result = flush();
+  
+  //Save the current workspace and settings.
+  uint8_t saved_X = current_X, saved_Y = current_Y, saved_W = current_W, saved_H = current_H;
+  uint8_t saved_bmp = _bmp;
+  
+  for (uint8_t blocks = 0; blocks < _bulk_blocks && _bulk_count && result == SENT; blocks++) {
+    bulk_bitmap &job = _bulk_queue[_bulk_head];
+    
+    //Select the bitmap's workspace, which the cluster's workspace is moved to before the block (only once for consecutive blocks).
+    if (job.X != current_X || job.Y != current_Y || job.W != current_W || job.H != current_H) {
+      current_X = job.X;
+      current_Y = job.Y;
+      current_W = job.W;
+      current_H = job.H;
+      _workspace_modified = true;
+    }
+    _bmp = job.options;
+    
+    //Send as many lines as fit in a single block.
+    uint8_t lines = job.rows - job.rows_sent;
+    uint8_t lines_per_block = (_block_size - 5) / job.bytes_per_line;
+    if (lines > lines_per_block) {
+      lines = lines_per_block;
+    }
+    result = send_bitmap_rows(job.startX, job.startY + job.rows_sent, job.bytes_per_line, job.bitmap + (uint16_t)job.rows_sent * job.width_in_bytes, job.width_in_bytes, lines, job.fromPGM);
+    
+    //Move on to the next bitmap when the entire bitmap was sent.
+    if (result == SENT) {
+      job.rows_sent += lines;
+      if (job.rows_sent >= job.rows) {
+        _bulk_head = (_bulk_head + 1) % TLBFIS_BULK_QUEUE_LENGTH;
+        _bulk_count--;
+      }
+    }
+  }
+  
+  //Select the current workspace and settings again; the cluster's workspace is restored before the next command that depends on it.
+  _bmp = saved_bmp;
+  if (saved_X != current_X || saved_Y != current_Y || saved_W != current_W || saved_H != current_H) {
+    current_X = saved_X;
+    current_Y = saved_Y;
+    current_W = saved_W;
+    current_H = saved_H;
+    _workspace_modified = true;
+  }
+  
+  return result;
+}
+
+/**
+  Function:
+    record_latency(uint16_t histogram[], unsigned long start)
+  
+  Parameters:
+    histogram[] -> the histogram to add the latency to
+    start       -> when the measured operation started (in microseconds)
+  
+  Description:
+    Adds the time elapsed since the start of an operation to a latency histogram.
+*/
+void TLBFISLib::record_latency(uint16_t* histogram, unsigned long start)
+{
+  unsigned long latency = micros() - start;
+  
+  //Find the first bucket which contains the latency.
+  uint8_t bucket = 0;
+  while (latency >= latencyBucketLimit(bucket)) {
+    bucket++;
+  }
+  
+  //Don't let the counter overflow.
+  if (histogram[bucket] != 0xFFFF) {
+    histogram[bucket]++;
+  }
+}
+
+/**
+  Function:
+    record_opcode_latency(uint8_t opcode, unsigned long enqueued)
+  
+  Parameters:
+    opcode   -> the first byte of the block which was acknowledged
+    enqueued -> when the block was queued (in microseconds)
+  
+  Description:
+    Adds the latency of an acknowledged block to the histogram of its command type.
+*/
+void TLBFISLib::record_opcode_latency(uint8_t opcode, unsigned long enqueued)
+{
+  //If no histograms were provided, exit.
+  if (!_latency) {
+    return;
+  }
+  
+  latencyOpcode index;
+  if (opcode == clear_byte) {
+    index = OPCODE_WORKSPACE;
+  }
+  else if (opcode == write_byte) {
+    index = OPCODE_TEXT;
+  }
+  else if (opcode == bitmap_byte) {
+    index = OPCODE_BITMAP;
+  }
+  else if (opcode == line_byte) {
+    index = OPCODE_LINE;
+  }
+  else if (opcode == radio_byte) {
+    index = OPCODE_RADIO;
+  }
+  else {
+    return;
+  }
+  
+  record_latency(_latency->opcode[index], enqueued);
+}
+
+/**
+  Function:
+    record_transport(TLBLib::sendStatus answer, uint8_t tx_buffer[], unsigned long block_start)
+  
+  Parameters:
+    answer      -> the answer to the last attempt
+    tx_buffer[] -> the block which was attempted
+    block_start -> when the block was first attempted (in microseconds)
+  
+  Description:
+    Counts an attempt into the transport statistics, tracking when the cluster starts and stops misbehaving.
+*/
+void TLBFISLib::record_transport(TLBLib::sendStatus answer, uint8_t* tx_buffer, unsigned long block_start)
+{
+  //If no statistics were provided, exit.
+  if (!_transport) {
+    return;
+  }
+  
+  if (answer == TLBLib::SUCCESS) {
+    _transport->blocks++;
+    _transport->bytes += tx_buffer[1] + 2;
+    
+    unsigned long duration = micros() - block_start;
+    if (duration > _transport->worst_block_us) {
+      _transport->worst_block_us = duration;
+    }
+    
+    //The cluster has recovered.
+    if (_in_trouble) {
+      _in_trouble = false;
+      _transport->recoveries++;
+      
+      unsigned long recovery = millis() - _trouble_start;
+      if (recovery > _transport->worst_recovery_ms) {
+        _transport->worst_recovery_ms = recovery;
+      }
+    }
+    return;
+  }
+  
+  if (answer == TLBLib::REPEAT) {
+    _transport->repeats++;
+  }
+  else {
+    _transport->failures++;
+  }
+  
+  //Measure the recovery from the first repeat/error.
+  if (!_in_trouble) {
+    _in_trouble = true;
+    _trouble_start = millis();
+  }
+}
+
+/**
+  Function:
+    record_given_up()
+  
+  Description:
+    Counts a block which was given up on into the transport statistics.
+*/
+void TLBFISLib::record_given_up()
+{
+  if (_transport) {
+    _transport->given_up++;
+  }
+}
+
+/**
+  Function:
+    deadline_passed()
+  
+  Returns:
+    bool -> whether or not the current call has exceeded the deadline
+  
+  Description:
+    Checks the deadline set by setRetryPolicy().
+*/
+bool TLBFISLib::deadline_passed()
+{
+  return _timeout && (millis() - _call_start >= _timeout);
+}
+
+/**
+  Function:
+    back_off(uint8_t &attempts)
+  
+  Parameters:
+    attempts -> how many times the current block was retried, incremented by this function
+  
+  Description:
+    Waits before retrying a block, doubling the wait time set by setRetryPolicy() on every retry (up to 16 times).
+*/
+void TLBFISLib::back_off(uint8_t &attempts)
+{
+  //If no backoff was set, retry immediately.
+  if (!_backoff) {
+    return;
+  }
+  
+  delayMicroseconds((unsigned long)_backoff << attempts);
+  
+  if (attempts < 4) {
+    attempts++;
+  }
+}
+
+/**
+  Function:
+    pace_block()
+  
+  Returns:
+    unsigned long -> when the pause ended (in microseconds)
+  
+  Description:
+    Waits for the part of the pause learned by the adaptive pacing which hasn't passed since the cluster accepted the previous block.
+*/
+unsigned long TLBFISLib::pace_block()
+{
+  unsigned long now = micros();
+  
+  if (_pacing && now - _last_accept < _pace) {
+    delayMicroseconds(_pace - (now - _last_accept));
+    now = micros();
+  }
+  
+  return now;
+}
+
+/**
+  Function:
+    pace_retry(uint8_t &attempts)
+  
+  Parameters:
+    attempts -> how many times the current block was retried, for the backoff
+  
+  Description:
+    Waits before retrying a block: with the backoff set by setRetryPolicy() if there is one, otherwise, while adaptive pacing is enabled, for a sixteenth
+    of the pause (at least TLBFIS_PACING_RETRY), so the cluster isn't asked again and again while it's busy.
+*/
+void TLBFISLib::pace_retry(uint8_t &attempts)
+{
+  if (_backoff || !_pacing) {
+    back_off(attempts);
+    return;
+  }
+  
+  delayMicroseconds(_pace / 16 + TLBFIS_PACING_RETRY);
+}
+
+/**
+  Function:
+    record_pacing(uint8_t repeats, unsigned long paced, unsigned long attempt_start)
+  
+  Parameters:
+    repeats       -> how many REPEAT answers the block received
+    paced         -> when the pause before the block ended (in microseconds)
+    attempt_start -> when the attempt which was accepted started (in microseconds)
+  
+  Description:
+    Adapts the pause between blocks after a block was accepted.
+  
+  Notes:
+    *Only blocks which followed the previous one within TLBFIS_PACING_MAX tell how long the cluster needs between blocks; after a longer gap, REPEAT
+    answers mean that the cluster was busy with something else.
+*/
+void TLBFISLib::record_pacing(uint8_t repeats, unsigned long paced, unsigned long attempt_start)
+{
+  if (!_pacing) {
+    return;
+  }
+  
+  if (paced - _last_accept <= TLBFIS_PACING_MAX) {
+    if (repeats) {
+      //The cluster was ready by the time of the accepted attempt, so move the pause halfway there.
+      unsigned long needed = attempt_start - _last_accept;
+      if (needed > TLBFIS_PACING_MAX) {
+        needed = TLBFIS_PACING_MAX;
+      }
+      if (needed > _pace) {
+        _pace += (needed - _pace + 1) / 2;
+      }
+    }
+    else {
+      //Accepted at once, so try a shorter pause, in case the cluster has become faster.
+      _pace -= (_pace + 31) / 32;
+    }
+  }
+  
+  _last_accept = micros();
+}
+
+/**
+  Function:
+    send_block(uint8_t tx_buffer[], unsigned long enqueued)
+  
+  Parameters:
+    tx_buffer[] -> buffer to be sent
+    enqueued    -> when the block was queued (in microseconds), for the latency histograms
+  
+  Returns:
+    status -> SENT if the transfer was started, FAILED or TIMED_OUT if the previous block was given up on (see setRetryPolicy())
+  
+  Description:
+    Waits for the answer to the previous block, then copies the block into the block send buffer and starts transmitting it with the block send
+    function, without waiting for its answer.
+*/
+TLBFISLib::status TLBFISLib::send_block(uint8_t* tx_buffer, unsigned long enqueued)
+{
+  //The previous block must be answered before its buffer is reused; if it was given up on, this call reports it.
+  status result = wait_block_send();
+  if (result != SENT) {
+    return result;
+  }
+  
+  //The block consists of the command byte, the length byte and "length" more bytes.
+  _block_length = tx_buffer[1] + 2;
+  if (_block_length > TLB_MAX_BYTES_PER_BLOCK) {
+    _block_length = TLB_MAX_BYTES_PER_BLOCK;
+  }
+  
+  //Copy the block, so that it stays unchanged while it's transmitted (and retransmitted).
+  memcpy(_block_buffer, tx_buffer, _block_length);
+  
+  //Start the transfer; the next block is encoded while it's running.
+  _block_opcode = tx_buffer[0];
+  _block_enqueued = enqueued;
+  _block_busy = true;
+  _block_send_function(_block_buffer, _block_length);
+  return SENT;
+}
+
+/**
+  Function:
+    wait_block_send()
+  
+  Returns:
+    status -> SENT, FAILED or TIMED_OUT, according to the retry policy
+  
+  Description:
+    Waits until the block given to the block send function has been answered, giving it to the function again after REPEAT and FAIL answers.
+  
+  Notes:
+    *If the deadline passes or the cluster reports too many errors, the block is given up on; a transfer which is still running then only has to end
+    before the next one starts.
+*/
+TLBFISLib::status TLBFISLib::wait_block_send()
+{
+  //If there is no block send function, there is nothing to wait for.
+  if (!_block_send_function) {
+    return SENT;
+  }
+  
+  uint8_t failures = 0; //how many errors the cluster reported
+  uint8_t attempts = 0; //how many times the state was checked, for increasing the backoff
+  
+  while (true) {
+    //Wait for the current transfer to finish, unless the deadline of the current call passes.
+    while (_block_busy) {
+      if (deadline_passed()) {
+        //Give up on the block; the buffer stays busy until the transfer ends.
+        _block_length = 0;
+        return TIMED_OUT;
+      }
+      
+      //Let the task completing the transfer run.
+      back_off(attempts);
+      yield();
+    }
+    
+    //If there is no block waiting for an answer, the bus is free.
+    if (!_block_length) {
+      return SENT;
+    }
+    
+    //If the block was accepted, the bus is free.
+    if (_block_answer == TLBLib::SUCCESS) {
+      record_opcode_latency(_block_opcode, _block_enqueued);
+      _block_length = 0;
+      return SENT;
+    }
+    
+    //If the cluster reported too many errors, give up on the block.
+    if (_block_answer == TLBLib::FAIL && _max_failures && ++failures >= _max_failures) {
+      _block_length = 0;
+      return FAILED;
+    }
+    
+    //Otherwise, transmit the same block again.
+    _block_busy = true;
+    _block_send_function(_block_buffer, _block_length);
+  }
+}
+
+/**
+  Function:
+    submit_block(uint8_t tx_buffer[], unsigned long enqueued)
+  
+  Parameters:
+    tx_buffer[] -> buffer to be queued
+    enqueued    -> when the block was queued (in microseconds), for the latency histograms
+  
+  Returns:
+    status -> SENT if the block was queued, TIMED_OUT if the queue stayed full until the deadline
+  
+  Description:
+    Adds a block to the submission queue, waiting for the task which transmits to free a slot if the queue is full.
+*/
+TLBFISLib::status TLBFISLib::submit_block(uint8_t* tx_buffer, unsigned long enqueued)
+{
+  uint8_t attempts = 0; //how many times the queue was found full, for increasing the backoff
+  
+  while (!_submission_queue->push(tx_buffer, enqueued)) {
+    //If the deadline of the current call has passed, give up.
+    if (deadline_passed()) {
+      return TIMED_OUT;
+    }
+    
+    //Let the other task run before trying again.
+    back_off(attempts);
+    yield();
+  }
+  
+  return SENT;
+}
+
+/**
+  Function:
+    transmit_queue()
+  
+  Description:
+    Transmits the blocks which are waiting in the submission queue, retrying them according to the retry policy.
+  
+  Notes:
+    *Only the blocks which were queued when this function started are transmitted, so a task which keeps drawing can't keep update() from returning.
+    *If the timeout set by setRetryPolicy() passes, the remaining blocks are left for the next call; a block is only dropped after too many errors.
+*/
+void TLBFISLib::transmit_queue()
+{
+  unsigned long start = millis();
+  uint8_t count = _submission_queue->getCount();
+  
+  while (count--) {
+    unsigned long enqueued;
+    uint8_t* block = _submission_queue->front(enqueued);
+    if (!block) {
+      return;
+    }
+    
+    uint8_t failures = 0; //how many times the cluster reported an error for this block
+    uint8_t repeats = 0; //how many times the cluster wasn't ready for this block, for the adaptive pacing
+    uint8_t attempts = 0; //how many times the block was attempted, for increasing the backoff
+    unsigned long block_start = micros(); //when the block was first attempted, for the transport statistics
+    unsigned long paced = pace_block(); //when the pause before the block ended
+    
+    while (true) {
+      //If the timeout has passed, leave the block in the queue.
+      if (_timeout && millis() - start >= _timeout) {
+        return;
+      }
+      
+      unsigned long attempt_start = micros();
+      TLBLib::sendStatus result = TLB.send(block);
+      record_transport(result, block, block_start);
+      
+      //If the block was accepted, or the cluster reported too many errors, remove it.
+      if (result == TLBLib::SUCCESS) {
+        record_opcode_latency(block[0], enqueued);
+        record_pacing(repeats, paced, attempt_start);
+        break;
+      }
+      if (result == TLBLib::FAIL && _max_failures && ++failures >= _max_failures) {
+        record_given_up();
+        break;
+      }
+      if (result == TLBLib::REPEAT && repeats < 0xFF) {
+        repeats++;
+      }
+      
+      //Wait before trying again.
+      pace_retry(attempts);
+    }
+    
+    _submission_queue->pop();
+  }
+}
+
+/**
+  Function:
+    fill_area(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on)
+  
+  Parameters:
+    X, Y, W, H -> absolute coordinates of the top-left corner and width/height of the area
+    pixels_on  -> whether to turn the pixels of the area on (true) or off (false)
+  
+  Description:
+    Fills an area of the screen with a single color.
+  
+  Notes:
+    *Filling also moves the cluster's workspace to the filled area; instead of restoring it after every fill, the workspace is restored by send_tx_buffer()
+    before the next command which depends on it, so consecutive fills cost a single block each.
+*/
+TLBFISLib::status TLBFISLib::fill_area(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on)
+{
+  //Add bytes to the transmit buffer for filling the area.
+  //1. Command byte (clear/claim area); true = also clear the buffer
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
+  //2. Command length (always 5)
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
+  //3. Command options (0x02 = clear (pixels off), 0x03 = clear (pixels on))
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x02 + pixels_on);
+  //4. X coordinate
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, X);
+  //5. Y coordinate
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, Y);
+  //6. Width
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, W);
+  //7. Height
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, H);
+  //Send
+  status result = send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+  
+  //The workspace now differs from the current one (and if the command failed, it's not known where it is).
+  _workspace_modified = true;
+  return result;
+}
+
+/**
+  Function:
+    clip_area(uint8_t X, uint8_t Y, uint8_t W, uint8_t H)
+  
+  Parameters:
+    X, Y, W, H -> absolute coordinates of the top-left corner and width/height of the area
+  
+  Returns:
+    status -> SENT, FAILED or TIMED_OUT, according to the retry policy
+  
+  Description:
+    Sets the cluster's workspace to an area without changing the current workspace, which will be restored before the next command that depends on it.
+*/
+TLBFISLib::status TLBFISLib::clip_area(uint8_t X, uint8_t Y, uint8_t W, uint8_t H)
+{
+  //Add bytes to the transmit buffer for changing the workspace.
+  //1. Command byte (clear/claim area); true = also clear the buffer
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
+  //2. Command length (always 5)
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
+  //3. Command options (0x00 = change workspace without clearing)
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x00);
+  //4. X coordinate
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, X);
+  //5. Y coordinate
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, Y);
+  //6. Width
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, W);
+  //7. Height
+  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, H);
+  //Send
+  status result = send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length);
+  
+  //The workspace now differs from the current one (and if the command failed, it's not known where it is).
+  _workspace_modified = true;
+  return result;
+}
+
+/**
+  Function:
+    draw_shape(const raster_shape &shape)
+  
+  Parameters:
+    shape -> the shape to draw
+  
+  Returns:
+    status -> SENT, FAILED or TIMED_OUT, according to the retry policy
+  
+  Description:
+    Draws a shape: horizontal and vertical segments are sent as fills, and everything else is rasterized in bands of rows that fit in a block.
+  
+  Notes:
+    *Each band only covers the columns between its leftmost and rightmost pixel, and rows without any pixels are skipped.
+    *The workspace is clipped to the columns of the band (so the lines of the bitmap don't need to be padded up to the right edge of the workspace)
+    and restored before the next command that depends on it.
+    *With the inverted palette, the bitmaps are sent in XOR mode, so the pixels they cover are toggled; the pixels of the fills are left out of them,
+    so that the corners shared by both kinds of segments stay cleared.
+*/
+TLBFISLib::status TLBFISLib::draw_shape(const raster_shape &shape)
+{
+  status result = SENT;
+  
+  //Send the horizontal and vertical segments as fills.
+  if (shape.points) {
+    uint8_t segments = shape.closed ? shape.count : (shape.count - 1);
+    for (uint8_t i = 0; i < segments && result == SENT; i++) {
+      uint8_t next = (i + 1) % shape.count;
+      uint8_t x0 = shape.points[2 * i], y0 = shape.points[2 * i + 1];
+      uint8_t x1 = shape.points[2 * next], y1 = shape.points[2 * next + 1];
+      
+      //Other segments are rasterized below.
+      if (x0 != x1 && y0 != y1) {
+        continue;
+      }
+      
+      //Order the ends and constrain the segment to the workspace.
+      uint8_t left = (x0 < x1) ? x0 : x1, right = (x0 < x1) ? x1 : x0;
+      uint8_t top = (y0 < y1) ? y0 : y1, bottom = (y0 < y1) ? y1 : y0;
+      if (left >= current_W || top >= current_H) {
+        continue;
+      }
+      if (right >= current_W) {
+        right = current_W - 1;
+      }
+      if (bottom >= current_H) {
+        bottom = current_H - 1;
+      }
+      
+      result = fill_area(current_X + left, current_Y + top, right - left + 1, bottom - top + 1, _draw_color == NORMAL);
+    }
+    
+    //A single point is also drawn as a fill.
+    if (shape.count == 1 && shape.points[0] < current_W && shape.points[1] < current_H) {
+      result = fill_area(current_X + shape.points[0], current_Y + shape.points[1], 1, 1, _draw_color == NORMAL);
+    }
+  }
+  
+  if (result != SENT) {
+    return result;
+  }
+  
+  //First pass: find the leftmost and rightmost pixel of each row of the workspace.
+  uint8_t row_min[88], row_max[88];
+  memset(row_min, 0xFF, sizeof(row_min));
+  memset(row_max, 0x00, sizeof(row_max));
+  
+  raster_target target = {0, current_H, row_min, row_max, nullptr, 0, 0};
+  rasterize(shape, target);
+  
+  //Find the first and last row containing pixels; if there are none, exit.
+  uint8_t first_row = 0, last_row = current_H - 1;
+  while (first_row < current_H && row_min[first_row] > row_max[first_row]) {
+    first_row++;
+  }
+  if (first_row >= current_H) {
+    return SENT;
+  }
+  while (row_min[last_row] > row_max[last_row]) {
+    last_row--;
+  }
+  
+  //Second pass: send the rows in bands, each one as narrow and tall as possible while fitting in a block.
+  uint8_t band_bits[TLB_MAX_BYTES_PER_BLOCK - 5];
+  uint8_t clip_left = 0, clip_width = 0; //columns the workspace is clipped to (0 width = not clipped)
+  uint8_t row = first_row;
+  
+  while (row <= last_row && result == SENT) {
+    //Skip rows without pixels.
+    if (row_min[row] > row_max[row]) {
+      row++;
+      continue;
+    }
+    
+    //Add rows to the band while its bitmap fits in a block.
+    uint8_t left = row_min[row], right = row_max[row], rows = 1;
+    while (row + rows <= last_row && row_min[row + rows] <= row_max[row + rows]) {
+      uint8_t new_left = (row_min[row + rows] < left) ? row_min[row + rows] : left;
+      uint8_t new_right = (row_max[row + rows] > right) ? row_max[row + rows] : right;
+      if (((new_right - new_left + 8) / 8) * (rows + 1) > _block_size - 5) {
+        break;
+      }
+      
+      left = new_left;
+      right = new_right;
+      rows++;
+    }
+    uint8_t width = right - left + 1;
+    uint8_t bytes_per_line = (width + 7) / 8;
+    
+    //Clip the workspace to the band's columns (and all rows of the shape, so the following bands can reuse it), exiting if it fails.
+    if (width != clip_width || left != clip_left) {
+      result = clip_area(current_X + left, current_Y + first_row, width, last_row - first_row + 1);
+      if (result != SENT) {
+        return result;
+      }
+      
+      //The clipped workspace must be kept for the following blocks.
+      _workspace_modified = false;
+      clip_left = left;
+      clip_width = width;
+    }
+    
+    //Rasterize the band.
+    memset(band_bits, 0, sizeof(band_bits));
+    raster_target band = {row, rows, nullptr, nullptr, band_bits, left, bytes_per_line};
+    rasterize(shape, band);
+    
+    //With the inverted palette, the bitmap toggles the pixels, so the corners already cleared by the fills must not be turned back on.
+    if (_draw_color == INVERTED) {
+      unplot_fills(shape, band);
+    }
+    
+    //Send it as a transparent bitmap, so only the shape's pixels are drawn.
+    uint8_t prev_bmp = _bmp;
+    _bmp |= _bmp_transparent;
+    result = send_bitmap_rows(0, row - first_row, bytes_per_line, band_bits, bytes_per_line, rows, false);
+    _bmp = prev_bmp;
+    
+    row += rows;
+  }
+  
+  //The workspace is now clipped.
+  if (clip_width) {
+    _workspace_modified = true;
+  }
+  return result;
+}
+
+/**
+  Function:
+    rasterize(const raster_shape &shape, raster_target &target)
+  
+  Parameters:
+    shape  -> the shape to rasterize
+    target -> where to plot the pixels
+  
+  Description:
+    Generates the pixels of the shape's slanted segments (Bresenham's algorithm) or of its arc (midpoint circle algorithm).
+*/
+void TLBFISLib::rasterize(const raster_shape &shape, raster_target &target)
+{
+  //Polygons: only the segments which aren't horizontal or vertical (those are sent as fills).
+  if (shape.points) {
+    uint8_t segments = shape.closed ? shape.count : (shape.count - 1);
+    for (uint8_t i = 0; i < segments; i++) {
+      uint8_t next = (i + 1) % shape.count;
+      int16_t x0 = shape.points[2 * i], y0 = shape.points[2 * i + 1];
+      int16_t x1 = shape.points[2 * next], y1 = shape.points[2 * next + 1];
+      
+      if (x0 == x1 || y0 == y1) {
+        continue;
+      }
+      
+      //Step along the line, choosing the pixel closest to it on every step.
+      int16_t dx = abs(x1 - x0), sx = (x0 < x1) ? 1 : -1;
+      int16_t dy = -abs(y1 - y0), sy = (y0 < y1) ? 1 : -1;
+      int16_t error = dx + dy;
+      
+      while (true) {
+        plot(target, x0, y0);
+        
+        if (x0 == x1 && y0 == y1) {
+          break;
+        }
+        
+        int16_t error2 = 2 * error;
+        if (error2 >= dy) {
+          error += dy;
+          x0 += sx;
+        }
+        if (error2 <= dx) {
+          error += dx;
+          y0 += sy;
+        }
+      }
+    }
+    
+    return;
+  }
+  
+  //Arcs: generate one eighth of the circle and mirror it, keeping the pixels between the start and end angles.
+  int x = shape.radius, y = 0;
+  int error = 1 - x;
+  
+  //How far clockwise the arc goes from its start (a full circle doesn't need to be checked).
+  bool full = (!shape.start_angle && shape.end_angle >= 360);
+  uint16_t span = (shape.end_angle + 360 - shape.start_angle) % 360;
+  
+  while (x >= y) {
+    int offsets[8][2] = {
+      { x, -y}, { y, -x}, {-y, -x}, {-x, -y},
+      {-x,  y}, {-y,  x}, { y,  x}, { x,  y}
+    };
+    
+    for (uint8_t i = 0; i < 8; i++) {
+      //Skip the pixels outside of the arc.
+      if (!full) {
+        //Direction of the pixel, with the Y axis pointing up like the directions of the ends.
+        int32_t u = offsets[i][0], v = -offsets[i][1];
+        
+        //Cross products: positive if the pixel is clockwise from the start, and if the end is clockwise from the pixel (less than half a turn away).
+        int32_t after_start = (int32_t)shape.start_dir[1] * u - (int32_t)shape.start_dir[0] * v;
+        int32_t before_end = v * shape.end_dir[0] - u * shape.end_dir[1];
+        
+        bool inside;
+        if (span < 180) {
+          //A short arc contains the pixels between its ends (the start direction itself, but not the opposite one).
+          bool at_start = (after_start == 0 && (int32_t)shape.start_dir[0] * u + (int32_t)shape.start_dir[1] * v >= 0);
+          inside = (after_start > 0 || at_start) && before_end >= 0;
+        }
+        else {
+          //A long arc contains everything except the pixels strictly between its end and its start.
+          inside = (after_start >= 0 || before_end >= 0);
+        }
+        
+        if (!inside) {
+          continue;
+        }
+      }
+      
+      plot(target, shape.center_X + offsets[i][0], shape.center_Y + offsets[i][1]);
+    }
+    
+    y++;
+    if (error < 0) {
+      error += 2 * y + 1;
+    }
+    else {
+      x--;
+      error += 2 * (y - x) + 1;
+    }
+  }
+}
+
+/**
+  Function:
+    plot(raster_target &target, int16_t X, int16_t Y)
+  
+  Parameters:
+    target -> where to plot the pixel
+    X, Y   -> coordinates of the pixel (relative to the workspace)
+  
+  Description:
+    Records a pixel generated by the rasterizer: either extends its row's horizontal extent, or sets its bit in the band's bitmap.
+*/
+void TLBFISLib::plot(raster_target &target, int16_t X, int16_t Y)
+{
+  //Ignore pixels outside of the workspace or outside of the rows being rasterized.
+  if (X < 0 || X >= current_W || Y < target.top || Y >= target.top + target.rows) {
+    return;
+  }
+  
+  uint8_t row = Y - target.top;
+  
+  //First pass: extend the row.
+  if (!target.bits) {
+    if (X < target.row_min[row]) {
+      target.row_min[row] = X;
+    }
+    if (X > target.row_max[row]) {
+      target.row_max[row] = X;
+    }
+    return;
+  }
+  
+  //Second pass: set the pixel's bit (the leftmost pixel is the most significant bit).
+  int16_t column = X - target.left;
+  if (column < 0 || column >= target.bytes_per_line * 8) {
+    return;
+  }
+  target.bits[row * target.bytes_per_line + column / 8] |= 0x80 >> (column % 8);
+}
+
+/**
+  Function:
+    unplot_fills(const raster_shape &shape, raster_target &target)
+  
+  Parameters:
+    shape  -> the shape whose horizontal and vertical segments were sent as fills
+    target -> the band whose bitmap must leave them out
+  
+  Description:
+    Clears the bits of a band's bitmap which are covered by the fills of the shape's horizontal and vertical segments.
+*/
+void TLBFISLib::unplot_fills(const raster_shape &shape, raster_target &target)
+{
+  //Only polygons have fills.
+  if (!shape.points) {
+    return;
+  }
+  
+  uint8_t segments = shape.closed ? shape.count : (shape.count - 1);
+  for (uint8_t i = 0; i < segments; i++) {
+    uint8_t next = (i + 1) % shape.count;
+    int16_t x0 = shape.points[2 * i], y0 = shape.points[2 * i + 1];
+    int16_t x1 = shape.points[2 * next], y1 = shape.points[2 * next + 1];
+    
+    //Slanted segments are part of the bitmap.
+    if (x0 != x1 && y0 != y1) {
+      continue;
+    }
+    
+    //Limit the segment to the rows and columns of the band.
+    int16_t left = (x0 < x1) ? x0 : x1, right = (x0 < x1) ? x1 : x0;
+    int16_t top = (y0 < y1) ? y0 : y1, bottom = (y0 < y1) ? y1 : y0;
+    if (left < target.left) {
+      left = target.left;
+    }
+    if (right >= target.left + target.bytes_per_line * 8) {
+      right = target.left + target.bytes_per_line * 8 - 1;
+    }
+    if (top < target.top) {
+      top = target.top;
+    }
+    if (bottom >= target.top + target.rows) {
+      bottom = target.top + target.rows - 1;
+    }
+    
+    for (int16_t Y = top; Y <= bottom; Y++) {
+      for (int16_t X = left; X <= right; X++) {
+        int16_t column = X - target.left;
+        target.bits[(Y - target.top) * target.bytes_per_line + column / 8] &= ~(0x80 >> (column % 8));
+      }
+    }
+  }
+}
+
+/**
+  Function:
+    restore_workspace()
+  
+  Description:
+    Moves the cluster's workspace back to the current one, if a fill has changed it.
+*/
+TLBFISLib::status TLBFISLib::restore_workspace()
+{
+  //If the workspace wasn't changed, there is nothing to do.
+  if (!_workspace_modified) {
+    return SENT;
+  }
+  _workspace_modified = false;
+  
+  //The command is built in a separate buffer, because this may be called while another command is waiting in _clear_command_buffer.
+  uint8_t buffer[7], buffer_length = 0;
+  
+  //Add bytes to the transmit buffer for changing the workspace.
+  //1. Command byte (clear/claim area)
+  add_to_tx_buffer(buffer, sizeof(buffer), buffer_length, clear_byte);
+  //2. Command length (always 5)
+  add_to_tx_buffer(buffer, sizeof(buffer), buffer_length, 5);
+  //3. Command options (0x00 = change workspace without clearing)
+  add_to_tx_buffer(buffer, sizeof(buffer), buffer_length, 0x00);
+  //4. X coordinate
+  add_to_tx_buffer(buffer, sizeof(buffer), buffer_length, current_X);
+  //5. Y coordinate
+  add_to_tx_buffer(buffer, sizeof(buffer), buffer_length, current_Y);
+  //6. Width
+  add_to_tx_buffer(buffer, sizeof(buffer), buffer_length, current_W);
+  //7. Height
+  add_to_tx_buffer(buffer, sizeof(buffer), buffer_length, current_H);
+  //Send
+  status result = send_tx_buffer(buffer, sizeof(buffer), buffer_length);
+  
+  //If it failed, try again before the next command.
+  if (result != SENT) {
+    _workspace_modified = true;
+  }
+  return result;
+}
+
+/**
+  Function:
+    send_bitmap_rows(uint8_t startX, uint8_t startY, uint8_t bytes_per_line, const uint8_t bitmap[], uint8_t width_in_bytes, uint8_t rows, bool fromPGM, (bool repeat_row))
+  
+  Parameters:
+    startX, startY -> the coordinates of the first row's leftmost pixel
+    bytes_per_line -> how many bytes are sent for every line (the bitmap's lines are cut or padded with zeroes to this size)
+    bitmap[]       -> the first row of the bitmap to send
+    width_in_bytes -> how many bytes a row of the bitmap occupies in memory
+    rows           -> how many rows to send
+    fromPGM        -> whether or not the bitmap is stored in PROGMEM
+    (repeat_row)   -> whether to send the first row of the bitmap on every line, instead of advancing through the bitmap
+  
+  Default parameters:
+    (repeat_row = false)
+  
+  Description:
+    Splits rows of a bitmap into as few blocks as possible and sends them.
+*/
+TLBFISLib::status TLBFISLib::send_bitmap_rows(uint8_t startX, uint8_t startY, uint8_t bytes_per_line, const uint8_t* bitmap, uint8_t width_in_bytes, uint8_t rows, bool fromPGM, bool repeat_row)
+{
   //The header (present in every block) has a size of 5, so 5 subtracted from the total size of the block is the number of bytes free for the pixel data.
   //Calculate how many lines of the bitmap fit inside a block.
-  uint8_t lines_per_block = (TLB_MAX_BYTES_PER_BLOCK - 5) / total_bytes_per_line;
+  uint8_t lines_per_block = (_block_size - 5) / bytes_per_line;
   
-  uint8_t blocks_needed = (height + (lines_per_block - 1)) / lines_per_block; //how many blocks will be needed
-  uint8_t lines_on_last_block = height - ((blocks_needed - 1) * lines_per_block); //how many lines of the bitmap will be sent in the last block
-  uint8_t width_in_bytes = (width + 7) / 8; //convert the width from pixels into bytes (1 byte = 8 pixels)
+  uint8_t blocks_needed = (rows + (lines_per_block - 1)) / lines_per_block; //how many blocks will be needed
+  uint8_t lines_on_last_block = rows - ((blocks_needed - 1) * lines_per_block); //how many lines of the bitmap will be sent in the last block
   uint8_t current_row = startY; //the current Y coordinate, starting from the requested Y and increasing with every block
   uint16_t bytes_sent = 0; //how many bytes have been sent so far, to "navigate" the chunk of memory that is the bitmap
   
@@ -983,8 +4267,8 @@ void TLBFISLib::drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_
     add_to_tx_buffer(
       _bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length,
       (block == blocks_needed - 1) ? //if on the last block,
-      (lines_on_last_block * total_bytes_per_line + 3) : //then calculate with the number of lines on the last block,
-      (lines_per_block * total_bytes_per_line + 3) //otherwise calculate with the number of lines on intermediate blocks
+      (lines_on_last_block * bytes_per_line + 3) : //then calculate with the number of lines on the last block,
+      (lines_per_block * bytes_per_line + 3) //otherwise calculate with the number of lines on intermediate blocks
     );
     //3. Command options (bitmap mode)
     add_to_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length, _bmp);
@@ -995,8 +4279,8 @@ void TLBFISLib::drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_
     
     //Calculate how many blank bytes should be added to the right.
     uint8_t bytes_of_right_padding = (
-      (width_in_bytes < total_bytes_per_line) ? //if the bitmap's width is less than how many bytes must be sent per line,
-      (total_bytes_per_line - width_in_bytes) : //then the difference is added to the right,
+      (width_in_bytes < bytes_per_line) ? //if the bitmap's width is less than how many bytes must be sent per line,
+      (bytes_per_line - width_in_bytes) : //then the difference is added to the right,
       0 //otherwise nothing is added to the right
     );
     
@@ -1008,7 +4292,7 @@ void TLBFISLib::drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_
     );
     
     //Calculate how many bytes will be copied into the transmit buffer for each line.
-    uint8_t bytes_to_copy_per_line = total_bytes_per_line - bytes_of_right_padding;
+    uint8_t bytes_to_copy_per_line = bytes_per_line - bytes_of_right_padding;
     
     //Copy data from the bitmap into the transmit buffer.
     for (uint8_t current_line = 0; current_line < lines_on_this_block; current_line++) {
@@ -1018,356 +4302,180 @@ void TLBFISLib::drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_
       //Pad the right side with zeroes; the block was wiped (contains zeroes), so the index only needs to be incremented.
       _bitmap_command_buffer_length += bytes_of_right_padding;
       
-      //Increment the about of bytes sent to continue drawing the bitmap in the next loop.
-      bytes_sent += width_in_bytes;
+      //Increment the about of bytes sent to continue drawing the bitmap in the next loop (unless the same row is repeated).
+      if (!repeat_row) {
+        bytes_sent += width_in_bytes;
+      }
     }
     
     //Increment the current Y coordinate by however many lines were added to the buffer.
     current_row += lines_per_block;
     
     //Send the transmit buffer, exiting if it fails.
-    while (!send_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length));
+    status result = send_tx_buffer(_bitmap_command_buffer, sizeof(_bitmap_command_buffer), _bitmap_command_buffer_length);
+    if (result != SENT) {
+      return result;
+    }
   }
-}
-
-/**
-  Function:
-    drawLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
-  
-  Parameters:
-    startX, startY -> the coordinates of the line's origin
-    length         -> the length of the line
-    orientation    -> the line's orientation (HORIZONTAL/VERTICAL)
-  
-  Default parameters:
-    filled = orientation = HORIZONTAL
-  
-  Description:
-    Draws a line.
-*/
-void TLBFISLib::drawLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
-{
-  //Drawing a line is the same as clearing the screen, but with a width/height of one pixel.
-  //For this, the workspace will be changed, but afterwards it's restored to the previous area.
-  
-  //Determine which dimension should be 1 depending on the line orientation.
-  uint8_t width  = ((orientation == HORIZONTAL) ? length : 1); //for VERTICAL, width=1
-  uint8_t height = ((orientation == HORIZONTAL) ? 1 : length); //for HORIZONTAL, height=1
-  
-  //Add bytes to the transmit buffer for drawing a line.
-  //1. Command byte (clear/claim area); true = also clear the buffer
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
-  //2. Command length (always 5)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
-  //3. Command options (0x02 = clear (NORMAL color), 0x03 = clear (INVERTED color))
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x02 + !_draw_color);
-  //4. X coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_X + startX);
-  //5. Y coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_Y + startY);
-  //6. Width
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, width);
-  //7. Height
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, height);
-  //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
-  
-  //Restore the current workspace to the previous area.
-  
-  //Add bytes to the transmit buffer for changing the workspace.
-  //1. Command byte (clear/claim area); true = also clear the buffer
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
-  //2. Command length (always 5)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
-  //3. Command options (0x00 = change workspace without clearing)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x00);
-  //4. X coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_X);
-  //5. Y coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_Y);
-  //6. Width
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_W);
-  //7. Height
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_H);
-  //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
-}
-
-/**
-  Function:
-    drawThinLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
-  
-  Parameters:
-    startX, startY -> the coordinates of the line's origin
-    length         -> the length of the line
-    orientation    -> the line's orientation (HORIZONTAL/VERTICAL)
-  
-  Default parameters:
-    filled = orientation = HORIZONTAL
-  
-  Description:
-    Draws a thin line on high-resolution displays.
   
-  Notes:
-    *On standard-resolution displays, it draws a normal line.
-    *The thin line's color can not be changed and is not affected by the setDrawColor() command.
-*/
-void TLBFISLib::drawThinLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation)
-{
-  //Add bytes to the transmit buffer for drawing a thin line.
-  //1. Command byte (clear/claim area); true = also clear the buffer
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, line_byte, true);
-  //2. Command length (always 4)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 4);
-  //3. Command options (0x10=VERTICAL, 0x20=HORIZONTAL)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, (orientation == VERTICAL) ? 0x10 : 0x20);
-  //4. X coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, startX);
-  //5. Y coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, startY);
-  //6. Length
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, length);
-  //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
+  return SENT;
 }
 
 /**
   Function:
-    drawRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, rectangleType filled)
+    read_stream_row(bitmapRowFunction_type function, uint8_t row, uint8_t data[], uint8_t X, uint8_t Y, uint8_t width, bool grayscale)
   
   Parameters:
-    startX, startY -> the coordinates of the rectangle's origin (top-left pixel)
-    width, height  -> the dimensions of the rectangle
-    filled         -> whether the rectangle is only a border or a solid shape (NOT_FILLED/FILLED)
+    function  -> function which provides the rows
+    row       -> index of the row to request
+    data[]    -> where to store the packed row (must be cleared)
+    X, Y      -> absolute coordinates of the row's first pixel, for aligning the dithering
+    width     -> how many pixels to request
+    grayscale -> whether the function provides one byte per pixel, which must be dithered
   
-  Default parameters:
-    filled = NOT_FILLED
+  Returns:
+    bool -> whether or not the function provided the row
   
   Description:
-    Draws a rectangle.
+    Requests a row of a streamed bitmap, converting it to packed pixels if it's in grayscale.
 */
-void TLBFISLib::drawRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, rectangleType filled)
+bool TLBFISLib::read_stream_row(bitmapRowFunction_type function, uint8_t row, uint8_t* data, uint8_t X, uint8_t Y, uint8_t width, bool grayscale)
 {
-  //Drawing a rectangle is the same operation as clearing the screen, so the workspace must be restored afterwards.
-
-  //Add bytes to the transmit buffer for drawing a rectangle.
-  //1. Command byte (clear/claim area); true = also clear the buffer
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
-  //2. Command length (always 5)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
-  //3. Command options (0x02 = clear (NORMAL color), 0x03 = clear (INVERTED color))
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x02 + !_draw_color); //the border color is the inverted draw_color
-  //4. X coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_X + startX);
-  //5. Y coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_Y + startY);
-  //6. Width
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, width);
-  //7. Height
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, height);
-  //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
-  
-  //Filled rectangles are achieved by drawing a smaller rectangle inside, so only the border remains visible.
-  if (filled == NOT_FILLED) {
-    //Add bytes to the transmit buffer for drawing a rectangle.
-    //1. Command byte (clear/claim area); true = also clear the buffer
-    add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
-    //2. Command length (always 5)
-    add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
-    //3. Command options (0x02 = clear (NORMAL color), 0x03 = clear (INVERTED color))
-    add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x02 + _draw_color);
-    //4. X coordinate
-    add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_X + startX + 1);
-    //5. Y coordinate
-    add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_Y + startY + 1);
-    //6. Width
-    add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, width - 2);
-    //7. Height
-    add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, height - 2);
-    //Send
-    while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
+  //Packed rows are provided in their final place.
+  if (!grayscale) {
+    return function(row, data, (width + 7) / 8);
   }
   
-  //Restore the current workspace to the previous area.
-  
-  //Add bytes to the transmit buffer for changing the workspace.
-  //1. Command byte (clear/claim area); true = also clear the buffer
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, clear_byte, true);
-  //2. Command length (always 5)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 5);
-  //3. Command options (0x00 = change workspace without clearing)
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, 0x00);
-  //4. X coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_X);
-  //5. Y coordinate
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_Y);
-  //6. Width
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_W);
-  //7. Height
-  add_to_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length, current_H);
-  //Send
-  while(!send_tx_buffer(_clear_command_buffer, sizeof(_clear_command_buffer), _clear_command_buffer_length));
-}
-
-///PRIVATE
-
-/**
-  Function:
-    add_to_tx_buffer(uint8_t tx_buffer[], uint8_t tx_buffer_size, uint8_t &tx_buffer_index, (const) uint8_t data[], uint8_t length, bool clear_buffer, (bool fromPGM))
-  
-  Parameters:
-    tx_buffer[]     -> buffer to add the bytes to
-    tx_buffer_size  -> total size of the buffer
-    tx_buffer_index -> current position in the buffer
-    data[]          -> array of bytes to add to the buffer
-    length          -> how many bytes from the array to add
-    clear_buffer    -> whether or not to start the buffer from the beginning when adding the bytes
-    (fromPGM)       -> whether or not the byte array is stored in PROGMEM
-  
-  Default parameters:
-    clear_buffer = false
-    (fromPGM) = false
-  
-  Description:
-    Adds bytes from the given array to the transmission buffer.
-*/
-void TLBFISLib::add_to_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index, const uint8_t* data, uint8_t length, bool clear_buffer, bool fromPGM)
-{
-  //Call the function which takes a byte array (uint8_t[]).
-  add_to_tx_buffer(tx_buffer, tx_buffer_size, tx_buffer_index, (uint8_t*)data, length, clear_buffer, fromPGM);
-}
-
-void TLBFISLib::add_to_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index, uint8_t* data, uint8_t length, bool clear_buffer, bool fromPGM)
-{
-  //If clearing was requested, set the buffer index to 0.
-  if (clear_buffer) {
-    tx_buffer_index = 0;
+  //Thresholds of the 4x4 Bayer matrix, between 8 and 248.
+  static const uint8_t bayer[16] = {
+      8, 136,  40, 168,
+    200,  72, 232, 104,
+     56, 184,  24, 152,
+    248, 120, 216,  88
+  };
+  
+  //A row can't be wider than the screen.
+  uint8_t gray[64];
+  if (!function(row, gray, width)) {
+    return false;
   }
   
-  //Calculate how much free space there is in the transmit buffer.
-  uint8_t free_space = tx_buffer_size - tx_buffer_index;
-  
-  //Calculate how many bytes will be copied into the transmit buffer.
-  uint8_t bytes_to_copy = (length < free_space) ? length : free_space;
-  
-  //If there is anything to copy, put the data into the transmit buffer.
-  if (bytes_to_copy) {
-    if (fromPGM) {
-      memcpy_P(tx_buffer + tx_buffer_index, data, bytes_to_copy);
-    }
-    else {
-      memcpy(tx_buffer + tx_buffer_index, data, bytes_to_copy);
+  //Light every pixel which is brighter than the threshold at its position on the screen.
+  const uint8_t* thresholds = bayer + ((Y & 3) << 2);
+  for (uint8_t x = 0; x < width; x++) {
+    if (gray[x] > thresholds[(X + x) & 3]) {
+      data[x / 8] |= 0x80 >> (x % 8);
     }
-    
-    //Increment the buffer length with however many bytes were added.
-    tx_buffer_index += bytes_to_copy;
   }
+  
+  return true;
 }
 
 /**
   Function:
-    add_to_tx_buffer(uint8_t data, bool clear_buffer)
+    plan_bitmap_rows(uint8_t actions[], uint8_t rows, uint8_t bytes_per_line, bool shrink_workspace, bool apply)
   
   Parameters:
-    tx_buffer[]     -> buffer to add the byte to
-    tx_buffer_size  -> total size of the buffer
-    tx_buffer_index -> current position in the buffer
-    data            -> byte to add to the buffer
-    clear_buffer    -> whether or not to start the buffer from the beginning when adding the bytes
+    actions[]        -> the action chosen for every row (ROW_BITMAP for rows which contain both colors)
+    rows             -> how many rows the bitmap has
+    bytes_per_line   -> how many bytes would be sent for every line of the bitmap
+    shrink_workspace -> whether the workspace would be shrunk around the bitmap before sending it
+    apply            -> whether or not to store the decisions in actions[]
   
-  Default parameters:
-    clear_buffer = false
+  Returns:
+    uint16_t -> the estimated cost of sending the bitmap (in bytes)
   
   Description:
-    Adds a byte to the transmission buffer.
-*/
-void TLBFISLib::add_to_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index, uint8_t data, bool clear_buffer)
-{
-  //If clearing was requested, set the buffer index to 0.
-  if (clear_buffer) {
-    tx_buffer_index = 0;
-  }
-  
-  //Calculate how much free space there is in the transmit buffer.
-  uint8_t free_space = tx_buffer_size - tx_buffer_index;
-  
-  //Determine whether or not anything needs to be copied into the transmit buffer.
-  bool bytes_to_copy = (free_space >= 1);
-  
-  //If there is anything to copy, put the data into the transmit buffer.
-  if (bytes_to_copy) {
-    tx_buffer[tx_buffer_index] = data;
-    
-    //Increment the buffer length.
-    tx_buffer_index++;
-  }
-}
-
-/**
-  Function:
-    wipe_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index)
-  
-  Parameters:
-    tx_buffer[]     -> buffer to wipe
-    tx_buffer_size  -> total size of the buffer
-    tx_buffer_index -> current position in the buffer
+    Decides for every run of single-colored rows whether it is cheaper to send it as part of the bitmap or separately (as a fill, or not at all),
+    and estimates the total cost of the result.
   
-  Description:
-    Clears the transmit buffer by filling it with zeroes.
+  Notes:
+    *Every block costs its own bytes plus TLB_BLOCK_OVERHEAD.
 */
-void TLBFISLib::wipe_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index)
+uint16_t TLBFISLib::plan_bitmap_rows(uint8_t* actions, uint8_t rows, uint8_t bytes_per_line, bool shrink_workspace, bool apply)
 {
-  //Fill the buffer with zeroes.
-  memset(tx_buffer, 0, tx_buffer_size);
-  
-  //Set the index to zero.
-  tx_buffer_index = 0;
-}
-
-/**
-  Function:
-    send_tx_buffer()
-  
-  Parameters:
-    tx_buffer[]     -> buffer to be sent
-    tx_buffer_size  -> total size of the buffer
-    tx_buffer_index -> current position in the buffer
+  //Calculate how many lines of the bitmap fit inside a block (after the 5-byte header).
+  uint8_t lines_per_block = (_block_size - 5) / bytes_per_line;
   
-  Returns:
-    bool -> whether or not the buffer was transmitted successfully
+  uint16_t cost = 0; //the total estimated cost
+  uint8_t segment_rows = 0; //how many rows the bitmap segment currently being built contains
+  bool workspace_changed = shrink_workspace; //whether the workspace will have to be restored at the end
   
-  Description:
-    Sends the transmission buffer.
-*/
-bool TLBFISLib::send_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index)
-{
-  (void) tx_buffer_size;
-  (void) tx_buffer_index;
+  //Shrinking the workspace is one extra command.
+  if (shrink_workspace) {
+    cost += 7 + TLB_BLOCK_OVERHEAD;
+  }
   
-  while (true)
-  {
-    switch (TLB.send(tx_buffer))
-    {
-      case TLBLib::FAIL:
-        return false;
+  for (uint8_t row = 0; row < rows;) {
+    //Find the end of the current run of rows with the same action.
+    uint8_t end = row + 1;
+    while (end < rows && actions[end] == actions[row]) {
+      end++;
+    }
+    uint8_t action = actions[row];
+    
+    //For single-colored rows, compare the cost of sending them as part of the bitmap against sending them separately.
+    if (action != ROW_BITMAP) {
+      //As part of the bitmap, every row costs one line.
+      uint16_t merge_cost = (end - row) * bytes_per_line;
       
-      case TLBLib::SUCCESS:
-        return true;
+      //Separately, filling costs a command (skipping is free), and splitting the bitmap in two costs another block header.
+      uint16_t separate_cost = (action == ROW_SKIP) ? 0 : (7 + TLB_BLOCK_OVERHEAD);
+      if (segment_rows && end < rows && actions[end] == ROW_BITMAP) {
+        separate_cost += 5 + TLB_BLOCK_OVERHEAD;
+      }
       
-      case TLBLib::REPEAT:
-        break;
+      //If it's not cheaper to send them separately, keep them in the bitmap.
+      if (merge_cost <= separate_cost) {
+        action = ROW_BITMAP;
+        
+        if (apply) {
+          memset(actions + row, ROW_BITMAP, end - row);
+        }
+      }
+    }
+    
+    if (action == ROW_BITMAP) {
+      //Add the rows to the current bitmap segment.
+      segment_rows += end - row;
     }
+    else {
+      //Close the current bitmap segment, adding the cost of its lines and of the headers of the blocks it needs.
+      if (segment_rows) {
+        cost += segment_rows * bytes_per_line + ((segment_rows + lines_per_block - 1) / lines_per_block) * (5 + TLB_BLOCK_OVERHEAD);
+        segment_rows = 0;
+      }
+      
+      //Add the cost of filling.
+      if (action != ROW_SKIP) {
+        cost += 7 + TLB_BLOCK_OVERHEAD;
+        workspace_changed = true;
+      }
+    }
+    
+    row = end;
+  }
+  
+  //Close the last bitmap segment.
+  if (segment_rows) {
+    cost += segment_rows * bytes_per_line + ((segment_rows + lines_per_block - 1) / lines_per_block) * (5 + TLB_BLOCK_OVERHEAD);
   }
+  
+  //Restoring the workspace is one extra command.
+  if (workspace_changed) {
+    cost += 7 + TLB_BLOCK_OVERHEAD;
+  }
+  
+  return cost;
 }
 
 /**
   Function:
     _charWidth(uint8_t message)
-    
+  
   Parameters:
     message -> character whose width to calculate
-    
+  
   Returns:
     uint8_t -> width of the given character (in pixels)
   
@@ -1425,6 +4533,62 @@ uint16_t TLBFISLib::_stringWidth(uint8_t* message, size_t length, bool fromPGM)
   }
 }
 
+/**
+  Function:
+    can_merge_text(uint8_t startX, uint8_t startY, size_t length)
+  
+  Parameters:
+    startX, startY -> coordinates of the text that would be added
+    length         -> how many characters would be added
+  
+  Returns:
+    bool -> whether or not the text can be added to the block waiting in the text buffer
+  
+  Description:
+    Checks if text continues the pending block: same line, same settings, starting exactly where the block ends, and fitting in the buffer.
+*/
+bool TLBFISLib::can_merge_text(uint8_t startX, uint8_t startY, size_t length)
+{
+  return _text_pending &&
+         !(_font & (_text_right | _text_center)) && //only left-aligned text keeps its position when merged
+         _text_command_buffer[2] == (_font & ~_text_right) && //same settings
+         _text_command_buffer[4] == startY && //same line
+         _text_pending_end == startX && //no gap or overlap
+         _text_command_buffer_length + length <= _block_size; //enough space left
+}
+
+/**
+  Function:
+    end_text_block(uint16_t end_X)
+  
+  Parameters:
+    end_X -> X coordinate where the text in the buffer ends
+  
+  Returns:
+    status -> SENT if the block was sent or kept, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Sends the text block which was just built, or keeps it in the buffer if it can be merged with following characters.
+  
+  Notes:
+    *Kept text is only sent later (by flush()), so SENT then only means that it's waiting; an error is reported by the call which sends it.
+*/
+TLBFISLib::status TLBFISLib::end_text_block(uint16_t end_X)
+{
+  //The block is queued from now on, even if it's merged with following characters.
+  _text_enqueued = micros();
+  
+  //Left-aligned text is kept, if merging is enabled.
+  if (_text_merging && !(_font & (_text_right | _text_center))) {
+    _text_pending = true;
+    _text_pending_end = end_X;
+    return SENT;
+  }
+  
+  //Other text is sent right away.
+  return send_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length);
+}
+
 /**
   Function:
     _writeChar(uint8_t startX, uint8_t startY, uint8_t character)
@@ -1436,13 +4600,16 @@ uint16_t TLBFISLib::_stringWidth(uint8_t* message, size_t length, bool fromPGM)
   Description:
     Writes a single character at the given coordinates.
 */
-void TLBFISLib::_writeChar(uint8_t startX, uint8_t startY, uint8_t character)
+TLBFISLib::status TLBFISLib::_writeChar(uint8_t startX, uint8_t startY, uint8_t character)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_WRITE_CHAR);
+  
+  //Calculate the width of the character.
+  uint8_t width = _charWidth(character);
+  
   //If aligning to the right, the effect will be achieved by subtracting the character's width from the workspace width.
   if (_font & _text_right) {
-    //Calculate the width of the character.
-    uint8_t width = _charWidth(character);
-    
     //If the character fits in the workspace, subtract the character's width from the workspace width and add to the X coordinate.
     if (width < current_W) {
       startX += current_W - width + 1;
@@ -1456,7 +4623,24 @@ void TLBFISLib::_writeChar(uint8_t startX, uint8_t startY, uint8_t character)
   if (!(_font & _text_graphics)) {
     character = pgm_read_byte_near(TLBFIS_ISO_IEC_8859_1 + character);
   }
-
+  
+  //If the character continues the text waiting in the buffer, add it to the same block.
+  if (can_merge_text(startX, startY, 1)) {
+    //Data bytes (text)
+    add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, character);
+    
+    //Increase the command length and move the end of the block.
+    _text_command_buffer[1]++;
+    _text_pending_end += width;
+    return SENT;
+  }
+  
+  //Otherwise, send the text that is waiting before starting a new block, exiting if it fails.
+  status result = flush();
+  if (result != SENT) {
+    return result;
+  }
+  
   //Add bytes to the transmit buffer for sending the text data.
   //1. Command byte (write text); true = also clear the buffer
   add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, write_byte, true);
@@ -1470,40 +4654,45 @@ void TLBFISLib::_writeChar(uint8_t startX, uint8_t startY, uint8_t character)
   add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, startY);
   //6. Data bytes (text)
   add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, character);
-  //Send
-  while(!send_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length));
+  //Send, or keep the block to merge it with the following characters
+  return end_text_block(startX + width);
 }
 
 /**
   Function:
-    _writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t message[], bool fromPGM)
+    _writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t message[], bool fromPGM, bool encoded, uint16_t encoded_width)
   
   Parameters:
     startX, startY -> coordinates of the string (top-left pixel)
     length         -> the string length
     message[]      -> the string to write
     fromPGM        -> whether or not the string is stored in PROGMEM
+    encoded        -> whether or not the string is already in the cluster's character set
+    encoded_width  -> width of the string (in pixels), if it's already in the cluster's character set
   
   Description:
     Writes a string at the given coordinates.
 */
-void TLBFISLib::_writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::_writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message, bool fromPGM, bool encoded, uint16_t encoded_width)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_WRITE_TEXT);
+  
   //If an empty string is supplied, exit.
   if (!length) {
-    return;
+    return SENT;
   }
   
   //Constrain the length to the maximum size that fits in the transmit buffer.
-  if (length > sizeof(_text_command_buffer) - 5) { //5 is the size of the header that must be sent at the start of the block
-    length = sizeof(_text_command_buffer) - 5;
+  if (length > _block_size - 5U) { //5 is the size of the header that must be sent at the start of the block
+    length = _block_size - 5;
   }
   
+  //Calculate the width of the string (converted strings can't be measured, their width is provided).
+  uint16_t width = encoded ? encoded_width : _stringWidth(message, length, fromPGM);
+  
   //If aligning to the right, the effect will be achieved by subtracting the character's width from the workspace width.
   if (_font & _text_right) {
-    //Calculate the width of the string.
-    uint16_t width = _stringWidth(message, length, fromPGM);
-    
     //If the string fits in the workspace, subtract the character's width from the workspace width and add to the X coordinate.
     if (width < current_W) {
       startX += current_W - width;
@@ -1513,23 +4702,38 @@ void TLBFISLib::_writeText(uint8_t startX, uint8_t startY, size_t length, uint8_
     }
   }
   
-  //Add bytes to the transmit buffer for sending the text data.
-  //1. Command byte (write text); true = also clear the buffer
-  add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, write_byte, true);
-  //2. Command length (text data + the 3 parameter bytes)
-  add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, uint8_t(length + 3));
-  //3. Command options (font, strip away right alignment bit for compatibility)
-  add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, _font & ~_text_right);
-  //4. X coordinate
-  add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, startX);
-  //5. Y coordinate
-  add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, startY);
+  //Determine whether the string continues the text waiting in the buffer.
+  bool merged = can_merge_text(startX, startY, length);
+  
+  //If it does, only the command length has to be increased.
+  if (merged) {
+    _text_command_buffer[1] += length;
+  }
+  //Otherwise, send the text that is waiting before starting a new block, exiting if it fails.
+  else {
+    status result = flush();
+    if (result != SENT) {
+      return result;
+    }
+    
+    //Add bytes to the transmit buffer for sending the text data.
+    //1. Command byte (write text); true = also clear the buffer
+    add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, write_byte, true);
+    //2. Command length (text data + the 3 parameter bytes)
+    add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, uint8_t(length + 3));
+    //3. Command options (font, strip away right alignment bit for compatibility)
+    add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, _font & ~_text_right);
+    //4. X coordinate
+    add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, startX);
+    //5. Y coordinate
+    add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, startY);
+  }
   
   //6. Data bytes (text)
   //Navigate the character array.
   for (size_t i = 0; i < length; i++) {
     //If not using the graphical font, convert the characters to the cluster's character set, using the lookup table.
-    if (!(_font & _text_graphics)) {
+    if (!(_font & _text_graphics) && !encoded) {
       if (fromPGM) {
         add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, pgm_read_byte_near(TLBFIS_ISO_IEC_8859_1 + pgm_read_byte_near(message + i)));
       }
@@ -1537,7 +4741,7 @@ void TLBFISLib::_writeText(uint8_t startX, uint8_t startY, size_t length, uint8_
         add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, pgm_read_byte_near(TLBFIS_ISO_IEC_8859_1 + message[i]));
       }
     }
-    //If using the graphical font, don't apply any conversions.
+    //If using the graphical font (or if the string is already converted), don't apply any conversions.
     else {
       if (fromPGM) {
         add_to_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length, pgm_read_byte_near(message + i));
@@ -1548,8 +4752,13 @@ void TLBFISLib::_writeText(uint8_t startX, uint8_t startY, size_t length, uint8_
     }
   }
   
-  //Send
-  while(!send_tx_buffer(_text_command_buffer, sizeof(_text_command_buffer), _text_command_buffer_length));
+  //Move the end of the block which is waiting, or send the new block (or keep it, to merge it with the following characters).
+  if (merged) {
+    _text_pending_end += width;
+    return SENT;
+  }
+  
+  return end_text_block(startX + width);
 }
 
 /**
@@ -1564,12 +4773,15 @@ void TLBFISLib::_writeText(uint8_t startX, uint8_t startY, size_t length, uint8_
   Description:
     Writes a multi-line string starting at the given coordinates.
 */
-void TLBFISLib::_writeMultiLineText(uint8_t startX, uint8_t startY, char* message, bool fromPGM)
+TLBFISLib::status TLBFISLib::_writeMultiLineText(uint8_t startX, uint8_t startY, char* message, bool fromPGM)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_WRITE_MULTI_LINE_TEXT);
+  
   //If an invalid message was provided, exit.
   if (!message)
   {
-    return;
+    return SENT;
   }
   
   //Determine whether or not the graphical font is selected.
@@ -1608,7 +4820,11 @@ void TLBFISLib::_writeMultiLineText(uint8_t startX, uint8_t startY, char* messag
     
     //If there is a string between the two pointers (instead of just another newline), write the string.
     if (curr - orig) {
-      _writeText(startX, startY + (in_graphics_font ? 7 : (7 + _spacing)) * row, curr - orig, (uint8_t*)orig, fromPGM);
+      //Write the line, exiting if it fails.
+      status result = _writeText(startX, startY + (in_graphics_font ? 7 : (7 + _spacing)) * row, curr - orig, (uint8_t*)orig, fromPGM);
+      if (result != SENT) {
+        return result;
+      }
     }
     
     //Advance the pointer.
@@ -1619,7 +4835,441 @@ void TLBFISLib::_writeMultiLineText(uint8_t startX, uint8_t startY, char* messag
   }
   
   //Write the last string (which ends at the null terminator).
-  writeText(startX, startY + (in_graphics_font ? 7 : (7 + _spacing)) * row, (const char*)orig, fromPGM);
+  return writeText(startX, startY + (in_graphics_font ? 7 : (7 + _spacing)) * row, (const char*)orig, fromPGM);
+}
+
+/**
+  Function:
+    vprint_at(uint8_t startX, uint8_t startY, const char format[], va_list args, bool fromPGM)
+  
+  Parameters:
+    startX, startY -> coordinates of the string (top-left pixel)
+    format[]       -> printf-style format string
+    args           -> values for the conversions in the format string
+    fromPGM        -> whether or not the format string is stored in PROGMEM
+  
+  Returns:
+    status -> SENT if the command was sent, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Parses the format string, sending every character it produces to a text_stream.
+*/
+TLBFISLib::status TLBFISLib::vprint_at(uint8_t startX, uint8_t startY, const char* format, va_list args, bool fromPGM)
+{
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_PRINT_AT);
+  
+  text_stream stream(*this, startX, startY);
+  
+  uint8_t character;
+  while ((character = next_format_char(format, fromPGM)) && stream.result == SENT) {
+    //Regular characters are written as they are.
+    if (character != '%') {
+      stream.put(character);
+      continue;
+    }
+    
+    //Flags
+    bool left_justify = false, zero_pad = false;
+    char sign_flag = 0;
+    character = next_format_char(format, fromPGM);
+    while (character == '-' || character == '0' || character == '+' || character == ' ') {
+      if (character == '-') {
+        left_justify = true;
+      }
+      else if (character == '0') {
+        zero_pad = true;
+      }
+      //'+' takes priority over ' '.
+      else if (sign_flag != '+') {
+        sign_flag = character;
+      }
+      character = next_format_char(format, fromPGM);
+    }
+    
+    //Width (no character is narrower than a pixel, so 64 characters are wider than the screen)
+    uint8_t width = 0;
+    if (character == '*') {
+      int value = va_arg(args, int);
+      width = (value > 0) ? ((value > 64) ? 64 : value) : 0;
+      character = next_format_char(format, fromPGM);
+    }
+    while (character >= '0' && character <= '9') {
+      uint16_t value = width * 10 + (character - '0');
+      width = (value > 64) ? 64 : value;
+      character = next_format_char(format, fromPGM);
+    }
+    
+    //Precision
+    int8_t precision = -1;
+    if (character == '.') {
+      precision = 0;
+      character = next_format_char(format, fromPGM);
+      if (character == '*') {
+        int value = va_arg(args, int);
+        precision = (value > 0) ? ((value > 9) ? 9 : value) : 0;
+        character = next_format_char(format, fromPGM);
+      }
+      while (character >= '0' && character <= '9') {
+        precision = precision * 10 + (character - '0');
+        if (precision > 9) {
+          precision = 9;
+        }
+        character = next_format_char(format, fromPGM);
+      }
+    }
+    
+    //Length
+    bool is_long = false;
+    while (character == 'l' || character == 'h') {
+      is_long |= (character == 'l');
+      character = next_format_char(format, fromPGM);
+    }
+    
+    switch (character) {
+      case 'd':
+      case 'i':
+      case 'q':
+      {
+        int32_t value = is_long ? va_arg(args, long) : va_arg(args, int);
+        uint32_t magnitude = (value < 0) ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+        
+        //Fixed point values are split at the decimal point.
+        uint8_t decimals = (character == 'q' && precision > 0) ? precision : 0;
+        uint32_t scale = 1;
+        for (uint8_t i = 0; i < decimals; i++) {
+          scale *= 10;
+        }
+        
+        stream.put_number(magnitude / scale, magnitude % scale, decimals, (value < 0) ? '-' : sign_flag, 10, width, left_justify, zero_pad);
+        break;
+      }
+      
+      case 'u':
+      case 'x':
+      case 'X':
+      {
+        uint32_t value = is_long ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+        stream.put_number(value, 0, 0, 0, (character == 'u') ? 10 : 16, width, left_justify, zero_pad, character == 'X');
+        break;
+      }
+      
+      case 'f':
+      {
+        double value = va_arg(args, double);
+        uint8_t decimals = (precision >= 0) ? precision : 2;
+        
+        //Not-a-number and infinite values are written as words.
+        if (isnan(value) || isinf(value)) {
+          if (value < 0) {
+            stream.put('-');
+          }
+          const char* word = isnan(value) ? "nan" : "inf";
+          while (*word) {
+            stream.put(*word++);
+          }
+          break;
+        }
+        
+        bool negative = (value < 0);
+        if (negative) {
+          value = -value;
+        }
+        
+        //Split the value into the integer part and the rounded decimals (the integer part is limited to 32 bits).
+        uint32_t scale = 1;
+        for (uint8_t i = 0; i < decimals; i++) {
+          scale *= 10;
+        }
+        uint32_t integer = (value < 4294967295.0) ? (uint32_t)value : 4294967295UL;
+        uint32_t fraction = (uint32_t)((value - integer) * scale + 0.5);
+        if (fraction >= scale) {
+          integer++;
+          fraction -= scale;
+        }
+        
+        stream.put_number(integer, fraction, decimals, negative ? '-' : sign_flag, 10, width, left_justify, zero_pad);
+        break;
+      }
+      
+      case 'c':
+      {
+        uint8_t padding = (width > 1) ? width - 1 : 0;
+        while (!left_justify && padding) {
+          stream.put(' ');
+          padding--;
+        }
+        stream.put((uint8_t)va_arg(args, int));
+        while (left_justify && padding) {
+          stream.put(' ');
+          padding--;
+        }
+        break;
+      }
+      
+      case 's':
+      case 'S':
+      {
+        //Measure the string (up to the precision), for padding.
+        const char* string = va_arg(args, const char*);
+        bool string_fromPGM = (character == 'S');
+        uint8_t length = 0;
+        while ((precision < 0 || length < precision) && length < 255 && (string_fromPGM ? pgm_read_byte_near(string + length) : string[length])) {
+          length++;
+        }
+        
+        uint8_t padding = (width > length) ? width - length : 0;
+        while (!left_justify && padding) {
+          stream.put(' ');
+          padding--;
+        }
+        for (uint8_t i = 0; i < length; i++) {
+          stream.put(string_fromPGM ? pgm_read_byte_near(string + i) : string[i]);
+        }
+        while (left_justify && padding) {
+          stream.put(' ');
+          padding--;
+        }
+        break;
+      }
+      
+      case '%':
+        stream.put('%');
+        break;
+      
+      //If the format string ends in the middle of a conversion, stop.
+      case 0:
+        return stream.finish();
+      
+      //Unknown conversions are skipped.
+      default:
+        break;
+    }
+  }
+  
+  return stream.finish();
+}
+
+/**
+  Function:
+    next_format_char(const char* &format, bool fromPGM)
+  
+  Parameters:
+    format  -> position in the format string, advanced past the character
+    fromPGM -> whether or not the format string is stored in PROGMEM
+  
+  Returns:
+    uint8_t -> the character at the current position
+  
+  Description:
+    Reads a character from a format string.
+*/
+uint8_t TLBFISLib::next_format_char(const char* &format, bool fromPGM)
+{
+  uint8_t character = fromPGM ? pgm_read_byte_near(format) : *format;
+  format++;
+  return character;
+}
+
+/**
+  Function:
+    text_stream(TLBFISLib &instance, uint8_t X, uint8_t Y)
+  
+  Parameters:
+    instance -> the library instance whose text buffer to use
+    X, Y     -> coordinates of the text (top-left pixel)
+  
+  Description:
+    Prepares the text buffer for adding characters: left-aligned text continues the block waiting in the buffer if possible, otherwise
+    it's sent and a new block is started.
+*/
+TLBFISLib::text_stream::text_stream(TLBFISLib &instance, uint8_t X, uint8_t Y) :
+  lib(instance),
+  startX(X),
+  startY(Y),
+  end_X(X),
+  aligned(instance._font & (instance._text_right | instance._text_center))
+{
+  //Continue the block which is waiting, if the text starts where it ends.
+  if (!aligned && lib.can_merge_text(startX, startY, 0)) {
+    return;
+  }
+  
+  //Otherwise, send it and start a new block.
+  result = lib.flush();
+  if (result == SENT) {
+    start_block(startX);
+  }
+}
+
+/**
+  Function:
+    start_block(uint16_t X)
+  
+  Parameters:
+    X -> X coordinate of the block
+  
+  Description:
+    Adds the header of a text command to the text buffer, without any characters.
+*/
+void TLBFISLib::text_stream::start_block(uint16_t X)
+{
+  //1. Command byte (write text); true = also clear the buffer
+  lib.add_to_tx_buffer(lib._text_command_buffer, sizeof(lib._text_command_buffer), lib._text_command_buffer_length, lib.write_byte, true);
+  //2. Command length (increased for every character)
+  lib.add_to_tx_buffer(lib._text_command_buffer, sizeof(lib._text_command_buffer), lib._text_command_buffer_length, 3);
+  //3. Command options (font, strip away right alignment bit for compatibility)
+  lib.add_to_tx_buffer(lib._text_command_buffer, sizeof(lib._text_command_buffer), lib._text_command_buffer_length, lib._font & ~lib._text_right);
+  //4. X coordinate
+  lib.add_to_tx_buffer(lib._text_command_buffer, sizeof(lib._text_command_buffer), lib._text_command_buffer_length, (uint8_t)X);
+  //5. Y coordinate
+  lib.add_to_tx_buffer(lib._text_command_buffer, sizeof(lib._text_command_buffer), lib._text_command_buffer_length, startY);
+}
+
+/**
+  Function:
+    put(uint8_t character)
+  
+  Parameters:
+    character -> the character to add
+  
+  Description:
+    Converts a character to the cluster's character set and adds it to the text buffer, sending the block and starting a new one if it's full.
+*/
+void TLBFISLib::text_stream::put(uint8_t character)
+{
+  if (result != SENT) {
+    return;
+  }
+  
+  //If the buffer is full, continue in a new block right after the text (aligned text is cut off instead).
+  if (lib._text_command_buffer_length >= lib._block_size) {
+    if (aligned || end_X > 0xFF) {
+      return;
+    }
+    
+    lib._text_pending = true;
+    lib._text_pending_end = end_X;
+    result = lib.flush();
+    if (result != SENT) {
+      return;
+    }
+    start_block(end_X);
+  }
+  
+  //Measure the character before converting it, like the other text functions.
+  end_X += lib._charWidth(character);
+  if (!(lib._font & lib._text_graphics)) {
+    character = pgm_read_byte_near(TLBFIS_ISO_IEC_8859_1 + character);
+  }
+  
+  //Data byte (text), increasing the command length.
+  lib.add_to_tx_buffer(lib._text_command_buffer, sizeof(lib._text_command_buffer), lib._text_command_buffer_length, character);
+  lib._text_command_buffer[1]++;
+  empty = false;
+}
+
+/**
+  Function:
+    put_number(uint32_t value, uint32_t fraction, uint8_t decimals, char sign, uint8_t base, uint8_t width, bool left_justify, bool zero_pad, (bool uppercase))
+  
+  Parameters:
+    value        -> the integer part of the number
+    fraction     -> the decimals, as an integer (ignored if decimals is 0)
+    decimals     -> how many decimals to write
+    sign         -> character written before the number ('-', '+', ' ' or 0 for none)
+    base         -> 10 or 16
+    width        -> minimum number of characters
+    left_justify -> whether to pad on the right instead of the left
+    zero_pad     -> whether to pad with zeros (after the sign) instead of spaces
+    (uppercase)  -> whether to use uppercase hexadecimal digits
+  
+  Default parameters:
+    (uppercase = false)
+  
+  Description:
+    Writes a number, padded to the given width.
+  
+  Notes:
+    *With the COMPACT font, padding spaces are SPACE_5PX characters, which are as wide as a digit.
+*/
+void TLBFISLib::text_stream::put_number(uint32_t value, uint32_t fraction, uint8_t decimals, char sign, uint8_t base, uint8_t width, bool left_justify, bool zero_pad, bool uppercase)
+{
+  //Digits of the integer part, from the last one.
+  char digits[10];
+  uint8_t count = 0;
+  do {
+    uint8_t digit = value % base;
+    digits[count++] = (digit < 10) ? ('0' + digit) : ((uppercase ? 'A' : 'a') + digit - 10);
+    value /= base;
+  } while (value);
+  
+  //Determine how much padding is needed.
+  uint8_t length = count + (sign ? 1 : 0) + (decimals ? decimals + 1 : 0);
+  uint8_t padding = (width > length) ? width - length : 0;
+  
+  //Padding spaces must be as wide as the digits, so that the previous value is always covered.
+  uint8_t space = (lib._font & lib._text_compact) ? SPACE_5PX[0] : ' ';
+  
+  while (!left_justify && !zero_pad && padding) {
+    put(space);
+    padding--;
+  }
+  if (sign) {
+    put(sign);
+  }
+  while (!left_justify && zero_pad && padding) {
+    put('0');
+    padding--;
+  }
+  
+  while (count) {
+    put(digits[--count]);
+  }
+  
+  //Decimals, from the first one.
+  if (decimals) {
+    put('.');
+    uint32_t scale = 1;
+    for (uint8_t i = 1; i < decimals; i++) {
+      scale *= 10;
+    }
+    while (scale) {
+      put('0' + (fraction / scale) % 10);
+      scale /= 10;
+    }
+  }
+  
+  while (left_justify && padding) {
+    put(space);
+    padding--;
+  }
+}
+
+/**
+  Function:
+    finish()
+  
+  Returns:
+    status -> SENT if the text was sent (or kept for merging), FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Completes the block in the text buffer, aligning it to the right if needed, then sends it or keeps it for merging.
+*/
+TLBFISLib::status TLBFISLib::text_stream::finish()
+{
+  //If something failed or nothing was added, there is nothing to send.
+  if (result != SENT || empty) {
+    return result;
+  }
+  
+  //If aligning to the right, the effect will be achieved by subtracting the text's width from the workspace width.
+  if (lib._font & lib._text_right) {
+    uint16_t width = end_X - startX;
+    lib._text_command_buffer[3] = (width < lib.current_W) ? startX + lib.current_W - width : 0;
+  }
+  
+  return lib.end_text_block(end_X);
 }
 
 /**
@@ -1634,12 +5284,15 @@ void TLBFISLib::_writeMultiLineText(uint8_t startX, uint8_t startY, char* messag
   Description:
     Writes a string in radio mode.
 */
-void TLBFISLib::_writeRadioText(bool line, size_t length, uint8_t* message, bool raw, bool fromPGM)
+TLBFISLib::status TLBFISLib::_writeRadioText(bool line, size_t length, uint8_t* message, bool raw, bool fromPGM)
 {
+  //The deadline and latency are measured from here.
+  deadline_scope scope(*this, CALL_WRITE_RADIO_TEXT);
+  
   //If an invalid length or message were provided, exit.
   if (!length || !message)
   {
-    return;
+    return SENT;
   }
   
   //Constrain the message length to 8 characters.
@@ -1679,5 +5332,5 @@ void TLBFISLib::_writeRadioText(bool line, size_t length, uint8_t* message, bool
   }
   
   //Send the buffer.
-  while (!send_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length));
+  return send_tx_buffer(_radio_command_buffer, sizeof(_radio_command_buffer), _radio_command_buffer_length);
 }
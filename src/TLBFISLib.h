@@ -3,8 +3,55 @@
 
 #include <TLBLib.h> //TLB library
 #include "characters.h" //character definitions
+#include <stdarg.h> //variable arguments for printAt()
 
-#define TLB_MAX_BYTES_PER_BLOCK 42 //how many bytes can be sent in one message
+#ifndef TLB_MAX_BYTES_PER_BLOCK
+#define TLB_MAX_BYTES_PER_BLOCK 42 //how many bytes can be sent in one message (size of the buffers, and the largest block calibrateBlockSize() tries)
+#endif
+#ifndef TLB_DEFAULT_BYTES_PER_BLOCK
+#define TLB_DEFAULT_BYTES_PER_BLOCK 42 //how many bytes are sent in one message until another size is set or calibrated
+#endif
+#define TLB_MIN_BYTES_PER_BLOCK 16 //smallest block size that can be used (a full line of a bitmap must fit in a block)
+#define TLB_BLOCK_OVERHEAD      10 //estimated cost of a block's framing and handshake (in bytes), used when choosing between encodings
+
+#ifndef TLBFIS_LATENCY_BUCKETS
+#define TLBFIS_LATENCY_BUCKETS 12 //how many buckets each latency histogram has
+#endif
+#ifndef TLBFIS_LATENCY_BASE_US
+#define TLBFIS_LATENCY_BASE_US 256 //upper limit of the first latency bucket (in microseconds), doubled for each following bucket
+#endif
+#ifndef TLBFIS_BULK_QUEUE_LENGTH
+#define TLBFIS_BULK_QUEUE_LENGTH 4 //how many bitmaps can wait in the bulk lane
+#endif
+#ifndef TLBFIS_BUS_SLICE
+#define TLBFIS_BUS_SLICE 10 //default longest time a block may wait for its cluster while other clusters share the bus (in milliseconds)
+#endif
+#ifndef TLBFIS_KEEPALIVE_INTERVAL
+#define TLBFIS_KEEPALIVE_INTERVAL 50 //default longest time between two calls to update() reported by msUntilNextUpdate() (in milliseconds)
+#endif
+#ifndef TLBFIS_PACING_MAX
+#define TLBFIS_PACING_MAX 10000 //longest pause adaptive pacing may keep between two blocks (in microseconds)
+#endif
+#ifndef TLBFIS_PACING_RETRY
+#define TLBFIS_PACING_RETRY 50 //shortest wait between two attempts of a block while adaptive pacing is enabled (in microseconds)
+#endif
+#ifndef TLBFIS_PACING_WINDOW_BLOCKS
+#define TLBFIS_PACING_WINDOW_BLOCKS 4 //for how many paced blocks update() may keep text waiting to be merged
+#endif
+
+#ifdef __AVR__
+//There is only one core; the pause is only changed by update(), and the state of a block transfer by an interrupt.
+typedef volatile uint16_t tlbfis_pace;
+typedef volatile uint8_t tlbfis_block_state;
+#else
+#include <atomic> //pause learned by the task which transmits, state of a block transfer completed by another task or an interrupt
+typedef std::atomic<uint16_t> tlbfis_pace;
+typedef std::atomic<uint8_t> tlbfis_block_state;
+#endif
+
+class TLBFISWidget; //widgets which can be refreshed by update()
+class TLBFISBus; //scheduler for several clusters sharing a bus
+class TLBFISQueue; //blocks waiting to be transmitted by another task
 
 class TLBFISLib
 { 
@@ -53,25 +100,150 @@ class TLBFISLib
       FILLED
     };
     
+    //Results of the drawing functions
+    enum status {
+      SENT,
+      FAILED,
+      TIMED_OUT
+    };
+    
+    //Priorities of the work done by update(), for the addWidget() function
+    enum lane {
+      LANE_URGENT,
+      LANE_NORMAL,
+      LANE_BULK,
+      LANE_COUNT
+    };
+    
+    //Command types measured by the latency histograms
+    enum latencyOpcode {
+      OPCODE_WORKSPACE,
+      OPCODE_TEXT,
+      OPCODE_BITMAP,
+      OPCODE_LINE,
+      OPCODE_RADIO,
+      OPCODE_COUNT
+    };
+    
+    //Public functions measured by the latency histograms
+    enum latencyCall {
+      CALL_INIT_SCREEN,
+      CALL_SET_WORKSPACE,
+      CALL_RESET_WORKSPACE,
+      CALL_CLEAR,
+      CALL_UPDATE,
+      CALL_FLUSH,
+      CALL_TURN_OFF,
+      CALL_WRITE_CHAR,
+      CALL_WRITE_TEXT,
+      CALL_WRITE_MULTI_LINE_TEXT,
+      CALL_WRITE_RADIO_TEXT,
+      CALL_WRITE_RADIO_RAW_DATA,
+      CALL_CLEAR_RADIO_TEXT,
+      CALL_TOGGLE_HIGHLIGHT,
+      CALL_DRAW_BITMAP,
+      CALL_DRAW_BITMAP_OPTIMIZED,
+      CALL_DRAW_BITMAP_STREAM,
+      CALL_DRAW_LINE,
+      CALL_DRAW_THIN_LINE,
+      CALL_DRAW_RECT,
+      CALL_INVERT_RECT,
+      CALL_DRAW_SEGMENT,
+      CALL_DRAW_POLYGON,
+      CALL_DRAW_CIRCLE,
+      CALL_DRAW_ARC,
+      CALL_PRINT_AT,
+      CALL_COUNT
+    };
+    
+    //Latency histograms for the latencyHistograms() function (bucket n counts latencies shorter than latencyBucketLimit(n))
+    struct latencyStats {
+      uint16_t opcode[OPCODE_COUNT][TLBFIS_LATENCY_BUCKETS];
+      uint16_t call[CALL_COUNT][TLBFIS_LATENCY_BUCKETS];
+    };
+    
+    //Transmission counters for the transportStatistics() function
+    struct transportStats {
+      unsigned long blocks; //blocks accepted by the cluster
+      unsigned long bytes; //bytes in those blocks
+      unsigned long repeats; //how many times the cluster asked for a block again
+      unsigned long failures; //how many errors the cluster reported
+      unsigned long given_up; //blocks which were given up on (FAILED/TIMED_OUT)
+      unsigned long recoveries; //how many times a block was accepted after repeats, errors or an error function call
+      unsigned long worst_block_us; //longest time a block took to be accepted, from its first attempt
+      unsigned long worst_recovery_ms; //longest time from the first repeat/error until a block was accepted again
+    };
+    
+    //Function type for transmitting an entire block at once ("void blockSendFunction(const uint8_t* data, uint8_t length)")
+    typedef void (*blockSendFunction_type)(const uint8_t* data, uint8_t length);
+    
+    //Function type for providing a bitmap one row at a time ("bool bitmapRowFunction(uint8_t row, uint8_t* data, uint8_t length)")
+    typedef bool (*bitmapRowFunction_type)(uint8_t row, uint8_t* data, uint8_t length);
+    
     //Constructor
     TLBFISLib(uint8_t ENA_pin, TLBLib::sendFunction_type sendFunction, TLBLib::beginFunction_type beginFunction = nullptr, TLBLib::endFunction_type endFunction = nullptr);
-  
+    
     //Set a function ("void errorFunction(unsigned long duration)") to be executed when an error is detected
     void errorFunction(TLBLib::errorFunction_type function);
     
+    //Set a function to transmit entire blocks (for example by DMA), with a buffer of TLB_MAX_BYTES_PER_BLOCK bytes that it may read until completion
+    void blockSendFunction(blockSendFunction_type function, uint8_t* buffer);
+    //Signal that the block given to the block send function was transmitted (can be called from an interrupt)
+    void blockSendComplete(bool success = true);
+    //Signal that the block given to the block send function was answered by the cluster, like TLBLib::send() (SUCCESS, REPEAT or FAIL)
+    void blockSendComplete(TLBLib::sendStatus answer);
+    
+    //Let another task transmit the blocks: drawing functions add them to the queue, and update() transmits them (nullptr = transmit right away)
+    void submissionQueue(TLBFISQueue* queue);
+    
+    //Limit how long drawing functions may wait for the cluster (0 = no limit)
+    void setRetryPolicy(uint8_t max_failures, unsigned long timeout_ms = 0, uint16_t backoff_us = 0);
+    
+    //Space blocks according to how quickly the cluster accepts them, and keep text to be merged for longer while it's slow (disabled by default)
+    void setAdaptivePacing(bool enabled);
+    //Get the pause currently kept between two blocks (in microseconds)
+    uint16_t getPacing();
+    //Get how long update() currently keeps text waiting to be merged (in milliseconds)
+    uint8_t getCoalescingWindow();
+    
+    //Count the blocks, retries and recoveries into the given structure (nullptr = stop counting)
+    void transportStatistics(transportStats* stats);
+    //Clear the transport statistics
+    void resetTransportStatistics();
+    
+    //Record how long commands take to be acknowledged into the given histograms (nullptr = stop recording)
+    void latencyHistograms(latencyStats* stats);
+    //Clear the latency histograms
+    void resetLatencyHistograms();
+    //Get the upper limit of a latency histogram bucket (in microseconds)
+    static unsigned long latencyBucketLimit(uint8_t bucket);
+    
     //Initialize the bus
     void begin();
     //Deinitialize the bus
     void end();
     
     //Initialize the screen
-    void initScreen(screenSize screen_size = HALFSCREEN, drawColor color = NORMAL);
+    status initScreen(screenSize screen_size = HALFSCREEN, drawColor color = NORMAL);
+    
+    //Find the largest block the cluster accepts, with blocks which don't change the screen (returns the size, or 0 if it couldn't be determined)
+    uint8_t calibrateBlockSize();
+    //Set the largest block which is sent (limited to TLB_MIN_BYTES_PER_BLOCK...TLB_MAX_BYTES_PER_BLOCK)
+    void setBlockSize(uint8_t size);
+    //Get the largest block which is sent
+    uint8_t getBlockSize();
     
     //Modify the current workspace
-    void setWorkspace(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool clear = false, drawColor color = NORMAL);
+    status setWorkspace(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool clear = false, drawColor color = NORMAL);
     
     //Reset the current workspace to the entire screen
-    void resetWorkspace(bool clear = false, drawColor color = NORMAL);
+    status resetWorkspace(bool clear = false, drawColor color = NORMAL);
+    
+    //Get the current workspace's X coordinate (in pixels);
+    uint8_t getWorkspaceX();
+    
+    //Get the current workspace's Y coordinate (in pixels);
+    uint8_t getWorkspaceY();
     
     //Get the current workspace's width (in pixels);
     uint8_t getWorkspaceWidth();
@@ -80,77 +252,129 @@ class TLBFISLib
     uint8_t getWorkspaceHeight();
     
     //Clear the current workspace
-    void clear(drawColor color = NORMAL);
+    status clear(drawColor color = NORMAL);
     
     //Maintain the connection
     void update(); //must be called while not doing anything / waiting
+    //Send pending text, widgets and queued bitmaps (the drawing part of update(), which must be called separately with a submission queue)
+    void updateWidgets();
+    
+    //Send any text still waiting to be merged with following characters
+    status flush();
     
     //Return to the "trip computer" mode
     void turnOff(); //update() must still be called frequently, initScreen() is required for displaying anything again
     
+    //Register a widget, to be refreshed by update() when it changes (instead of right away)
+    void addWidget(TLBFISWidget &widget, lane widget_lane = LANE_NORMAL);
+    //Unregister a widget (it's refreshed right away again)
+    void removeWidget(TLBFISWidget &widget);
+    //Limit how long update() may spend refreshing widgets (in milliseconds, 0 = no limit)
+    void setWidgetBudget(uint16_t budget_ms);
+    //Make all registered widgets redraw entirely
+    void invalidateWidgets();
+    //Make the registered widgets overlapping an area redraw entirely
+    void invalidateWidgets(uint8_t X, uint8_t Y, uint8_t W, uint8_t H);
+    
+    //Queue a bitmap in the bulk lane, to be sent by update() a few blocks at a time
+    status queueBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM = true);
+    //Set how many blocks of queued bitmaps update() may send in a single call
+    void setBulkBlocksPerUpdate(uint8_t blocks);
+    //Get how many bitmaps are waiting in the bulk lane
+    uint8_t getQueuedBitmaps();
+    //Discard the bitmaps waiting in the bulk lane
+    void clearBitmapQueue();
+    
+    //Set the longest time between two calls to update() which keeps the connection alive (in milliseconds)
+    void setKeepaliveInterval(uint16_t interval_ms);
+    //Get how long the sketch may sleep before calling update() again (in milliseconds, 0 = call it right away)
+    unsigned long msUntilNextUpdate();
+    
     //Draw color (NORMAL / INVERTED)
-    void setDrawColor(drawColor color);
+    status setDrawColor(drawColor color);
+    //Get the draw color
+    drawColor getDrawColor();
     
     //Text font (STANDARD / COMPACT / GRAPHICS)
-    void setFont(font text_font);
+    status setFont(font text_font);
+    //Get the text font
+    font getFont();
     //Text transparency (OPAQUE / TRANSPARENT)
-    void setTextTransparency(transparency text_transparency);
+    status setTextTransparency(transparency text_transparency);
+    //Get the text transparency
+    transparency getTextTransparency();
     //Text alignment (LEFT / CENTER / RIGHT)
-    void setTextAlignment(alignment text_alignment);
+    status setTextAlignment(alignment text_alignment);
+    //Get the text alignment
+    alignment getTextAlignment();
     //Vertical distance between lines (in pixels) for strings containing newlines
     void setLineSpacing(uint8_t spacing);
+    //Get the vertical distance between lines
+    uint8_t getLineSpacing();
+    //Merging of consecutive left-aligned text on the same line into a single block (enabled by default)
+    void setTextMerging(bool enabled);
     
     //Display a single character (char)
-    void writeChar(uint8_t startX, uint8_t startY, char character);
+    status writeChar(uint8_t startX, uint8_t startY, char character);
     //Display a single character (uint8_t)
-    void writeChar(uint8_t startX, uint8_t startY, uint8_t character);
+    status writeChar(uint8_t startX, uint8_t startY, uint8_t character);
     
     //Display a string (length, const char[])
-    void writeText(uint8_t startX, uint8_t startY, size_t length, const char* message, bool fromPGM = false);
+    status writeText(uint8_t startX, uint8_t startY, size_t length, const char* message, bool fromPGM = false);
     //Display a string (const char[])
-    void writeText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM = false);
+    status writeText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM = false);
     //Display a string (char[])
-    void writeText(uint8_t startX, uint8_t startY, char* message);
+    status writeText(uint8_t startX, uint8_t startY, char* message);
     //Display a string (length, char[])
-    void writeText(uint8_t startX, uint8_t startY, size_t length, char* message);
+    status writeText(uint8_t startX, uint8_t startY, size_t length, char* message);
     //Display a string (length, const uint8_t[])
-    void writeText(uint8_t startX, uint8_t startY, size_t length, const uint8_t* message, bool fromPGM = false);
+    status writeText(uint8_t startX, uint8_t startY, size_t length, const uint8_t* message, bool fromPGM = false);
     //Display a string (const uint8_t[])
-    void writeText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM = false);
+    status writeText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM = false);
     //Display a string (uint8_t[])
-    void writeText(uint8_t startX, uint8_t startY, uint8_t* message);
+    status writeText(uint8_t startX, uint8_t startY, uint8_t* message);
     //Display a string (length, uint8_t[])
-    void writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message);
+    status writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message);
+    
+    //Display a string which was already converted to the cluster's character set with encodeChar()
+    status writeEncodedText(uint8_t startX, uint8_t startY, size_t length, const uint8_t* message, uint16_t width);
+    //Convert a character to the cluster's character set, according to the current font
+    uint8_t encodeChar(uint8_t character);
+    
+    //Display formatted text (printf-style)
+    status printAt(uint8_t startX, uint8_t startY, const char* format, ...);
+    //Display formatted text (printf-style, format string stored in PROGMEM)
+    status printAt_P(uint8_t startX, uint8_t startY, const char* format, ...);
     
     //Display a string containing newlines (const char[])
-    void writeMultiLineText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM = false);
+    status writeMultiLineText(uint8_t startX, uint8_t startY, const char* message, bool fromPGM = false);
     //Display a string containing newlines (char[])
-    void writeMultiLineText(uint8_t startX, uint8_t startY, char* message);
+    status writeMultiLineText(uint8_t startX, uint8_t startY, char* message);
     //Display a string containing newlines (const uint8_t[])
-    void writeMultiLineText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM = false);
+    status writeMultiLineText(uint8_t startX, uint8_t startY, const uint8_t* message, bool fromPGM = false);
     //Display a string containing newlines (uint8_t[])
-    void writeMultiLineText(uint8_t startX, uint8_t startY, uint8_t* message);
+    status writeMultiLineText(uint8_t startX, uint8_t startY, uint8_t* message);
     
     //Display a string in radio mode (length, const char[])
-    void writeRadioText(bool line, size_t length, const char* message, bool raw = false, bool fromPGM = false);
+    status writeRadioText(bool line, size_t length, const char* message, bool raw = false, bool fromPGM = false);
     //Display a string in radio mode (const char[])
-    void writeRadioText(bool line, const char* message, bool raw = false, bool fromPGM = false);
+    status writeRadioText(bool line, const char* message, bool raw = false, bool fromPGM = false);
     //Display a string in radio mode (char[])
-    void writeRadioText(bool line, char* message, bool raw = false);
+    status writeRadioText(bool line, char* message, bool raw = false);
     //Display a string in radio mode (length, char[])
-    void writeRadioText(bool line, size_t length, char* message, bool raw = false);
+    status writeRadioText(bool line, size_t length, char* message, bool raw = false);
     //Display a string in radio mode (length, const uint8_t[])
-    void writeRadioText(bool line, size_t length, const uint8_t* message, bool raw = false, bool fromPGM = false);
+    status writeRadioText(bool line, size_t length, const uint8_t* message, bool raw = false, bool fromPGM = false);
     //Display a string in radio mode (const uint8_t[])
-    void writeRadioText(bool line, const uint8_t* message, bool raw = false, bool fromPGM = false);
+    status writeRadioText(bool line, const uint8_t* message, bool raw = false, bool fromPGM = false);
     //Display a string in radio mode (uint8_t[])
-    void writeRadioText(bool line, uint8_t* message, bool raw = false);
+    status writeRadioText(bool line, uint8_t* message, bool raw = false);
     //Display a string in radio mode (length, uint8_t[])
-    void writeRadioText(bool line, size_t length, uint8_t* message, bool raw = false);
+    status writeRadioText(bool line, size_t length, uint8_t* message, bool raw = false);
     //Send raw data in radio mode
-    void writeRadioRawData(uint8_t* data);
+    status writeRadioRawData(uint8_t* data);
     //Clear the radio mode string
-    void clearRadioText();
+    status clearRadioText();
     
     //Replace spaces in a number string with a wider space to avoid "ghosting" (uint8_t[])
     void fixNumberPadding(uint8_t* message);
@@ -180,24 +404,51 @@ class TLBFISLib
     uint16_t stringWidth(size_t length, uint8_t* message);
     
     //Toggle highlighting of a line (provide the Y coordinate of the text to be highlighed)
-    void toggleHighlight(uint8_t startY);
+    status toggleHighlight(uint8_t startY);
     
     //Bitmap transparency (OPAQUE / TRANSPARENT)
     void setBitmapTransparency(transparency bitmap_transparency);
     
     //Draw a bitmap
-    void drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM = true);
+    status drawBitmap(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM = true);
+    
+    //Draw a bitmap, encoding uniform areas as fills and choosing the cheapest combination of commands
+    status drawBitmapOptimized(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, const uint8_t* const bitmap, bool fromPGM = true);
+    
+    //Draw a bitmap whose rows are provided by a function, one at a time (packed like for drawBitmap(), or 8-bit grayscale, dithered by the library)
+    status drawBitmapStream(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, bitmapRowFunction_type function, bool grayscale = false);
     
     //Draw a straight line
-    void drawLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation = HORIZONTAL);
+    status drawLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation = HORIZONTAL);
     
     //Draw a thin straight line (for high-res displays)
-    void drawThinLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation = HORIZONTAL);
+    status drawThinLine(uint8_t startX, uint8_t startY, uint8_t length, lineOrientation orientation = HORIZONTAL);
     
     //Draw a rectangle
-    void drawRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, rectangleType filled = NOT_FILLED);
+    status drawRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height, rectangleType filled = NOT_FILLED);
+    
+    //Invert the pixels inside a rectangle (XOR), choosing the cheapest method for its size
+    status invertRect(uint8_t startX, uint8_t startY, uint8_t width, uint8_t height);
+    
+    //Draw a straight line between any two points
+    status drawSegment(uint8_t startX, uint8_t startY, uint8_t endX, uint8_t endY);
+    
+    //Draw the outline of a polygon (points given as X, Y pairs)
+    status drawPolygon(const uint8_t* points, uint8_t count, bool closed = true);
+    
+    //Draw the outline of a circle
+    status drawCircle(uint8_t centerX, uint8_t centerY, uint8_t radius);
+    
+    //Draw a part of a circle (angles in degrees, clockwise from the top)
+    status drawArc(uint8_t centerX, uint8_t centerY, uint8_t radius, uint16_t start_angle, uint16_t end_angle);
   
   private:
+    //The bus scheduler manages its clusters' registry and slice.
+    friend class TLBFISBus;
+    
+    //Widgets check if a change which was given up reached the screen.
+    friend class TLBFISWidget;
+    
     //Instance of the TLB library.
     TLBLib TLB;
     
@@ -230,16 +481,128 @@ class TLBFISLib
     screenSize _screen_size  = HALFSCREEN;
     drawColor _screen_color = NORMAL;
     bool _draw_color   = NORMAL;
+    bool _workspace_modified = false; //set when a fill has moved the cluster's workspace away from the current one
+    bool _text_merging = true; //whether left-aligned text is kept in the buffer, to merge it with the following characters
+    bool _text_pending = false; //set while the text buffer contains a block which wasn't sent yet
+    uint16_t _text_pending_end = 0; //X coordinate where the next character must start to be merged with the pending block
+    unsigned long _text_enqueued = 0; //when the block in the text buffer was queued (in microseconds)
+    
+    //Shapes drawn by the software rasterizer
+    struct raster_shape {
+      const uint8_t* points; //X, Y pairs of the corners of a polygon (nullptr for arcs)
+      uint8_t count; //how many corners there are
+      bool closed; //whether or not the last corner is connected to the first one
+      int16_t center_X, center_Y; //center of an arc
+      uint8_t radius; //radius of an arc
+      uint16_t start_angle, end_angle; //angles between which an arc is drawn (0 and 360 for a circle)
+      int16_t start_dir[2], end_dir[2]; //directions of the start and end angles (X to the right, Y up, scaled by 1024), for the angle test of arcs
+    };
+    
+    //Where the rasterizer plots pixels (either the extent of each row, or the bitmap of a band of rows)
+    struct raster_target {
+      int16_t top; //first row being rasterized
+      uint8_t rows; //how many rows are being rasterized
+      uint8_t* row_min; //leftmost pixel of each row
+      uint8_t* row_max; //rightmost pixel of each row
+      uint8_t* bits; //bitmap of the rows (nullptr to record the extents instead)
+      int16_t left; //X coordinate of the bitmap's first column
+      uint8_t bytes_per_line; //width of the bitmap (in bytes)
+    };
+    
+    //Actions chosen by the encoder for each row of drawBitmapOptimized()
+    enum rowAction {
+      ROW_BITMAP,
+      ROW_SKIP,
+      ROW_FILL_OFF,
+      ROW_FILL_ON
+    };
     
     //Reception buffer
     uint8_t _receive_buffer[2];
     
+    //Block-level transmission
+    blockSendFunction_type _block_send_function = nullptr;
+    uint8_t* _block_buffer = nullptr; //provided by the user, holds the block being transmitted while the next one is built
+    uint8_t _block_length = 0; //length of the block being transmitted (0 once it was accepted or given up on)
+    tlbfis_block_state _block_busy{false}; //set while a block is being transmitted
+    tlbfis_block_state _block_answer{TLBLib::SUCCESS}; //answer of the cluster to the last transfer (TLBLib::sendStatus)
+    uint8_t _block_opcode = 0; //opcode of the block being transmitted
+    unsigned long _block_enqueued = 0; //when the block being transmitted was queued (in microseconds)
+    
+    //Submission queue
+    TLBFISQueue* _submission_queue = nullptr; //provided by the user (nullptr = blocks are transmitted right away)
+    
+    //Retry policy
+    uint8_t _max_failures = 0; //how many errors are tolerated for a single block (0 = unlimited)
+    unsigned long _timeout = 0; //how long a call may take (in milliseconds, 0 = unlimited)
+    uint16_t _backoff = 0; //how long to wait before the first retry (in microseconds, doubled on every retry)
+    unsigned long _call_start = 0; //when the outermost call started (in milliseconds)
+    uint8_t _call_depth = 0; //how many calls are nested
+    
+    //Adaptive pacing
+    bool _pacing = false; //whether the pause between blocks is adapted to the cluster
+    tlbfis_pace _pace{0}; //pause kept between the acceptance of a block and the first attempt of the next one (in microseconds)
+    unsigned long _last_accept = 0; //when the cluster last accepted a block (in microseconds)
+    
+    //Measures the deadline and latency from the start of the outermost call
+    struct deadline_scope {
+      deadline_scope(TLBFISLib &instance, latencyCall call = CALL_COUNT);
+      ~deadline_scope();
+      TLBFISLib &lib;
+      latencyCall call;
+      unsigned long start;
+    };
+    
+    //Latency histograms
+    latencyStats* _latency = nullptr; //provided by the user
+    
+    //Transport statistics
+    transportStats* _transport = nullptr; //provided by the user
+    bool _in_trouble = false; //set from the first repeat/error until a block is accepted again
+    unsigned long _trouble_start = 0; //when the repeats/errors started (in milliseconds)
+    
+    //Widget registry
+    TLBFISWidget* _widgets = nullptr; //first registered widget (each one points to the next)
+    TLBFISWidget* _widget_cursor[LANE_COUNT] = {}; //widget of each lane which is checked first by the next call to update() (nullptr = the first one)
+    uint16_t _widget_budget = 0; //how long update() may spend refreshing widgets (in milliseconds, 0 = unlimited)
+    
+    //Bitmaps waiting in the bulk lane (the parameters of drawBitmap() and the settings at the time they were queued)
+    struct bulk_bitmap {
+      const uint8_t* bitmap;
+      bool fromPGM;
+      uint8_t startX, startY;
+      uint8_t bytes_per_line; //how many bytes are sent for every line
+      uint8_t width_in_bytes; //how many bytes every line of the bitmap has
+      uint8_t rows; //how many lines are sent
+      uint8_t rows_sent; //how many lines were already sent
+      uint8_t options; //bitmap options (transparency and color)
+      uint8_t X, Y, W, H; //workspace
+    };
+    bulk_bitmap _bulk_queue[TLBFIS_BULK_QUEUE_LENGTH];
+    uint8_t _bulk_head = 0; //index of the bitmap being sent
+    uint8_t _bulk_count = 0; //how many bitmaps are waiting
+    uint8_t _bulk_blocks = 1; //how many blocks update() may send in a single call
+    
+    //Keepalive
+    uint16_t _keepalive_interval = TLBFIS_KEEPALIVE_INTERVAL; //longest time between two calls to update() (in milliseconds)
+    unsigned long _last_update = 0; //when update() last maintained the connection (in milliseconds)
+    
+    //Shared bus
+    TLBFISBus* _bus = nullptr; //scheduler which drives this instance (nullptr = not registered)
+    TLBFISLib* _next_cluster = nullptr; //next instance on the same bus
+    uint16_t _bus_slice = 0; //how long a block may wait for the cluster while the bus is serving it (in milliseconds, 0 = unlimited)
+    bool _bus_yielded = false; //set when a block waited for too long, so the rest of the turn is given up
+    uint16_t _sent_blocks = 0; //how many blocks the cluster accepted (wrapping around), so that widgets can tell if a change sent anything
+    
     //Transmission buffers
     uint8_t _clear_command_buffer  [7],                       _clear_command_buffer_length  = 0;
     uint8_t _text_command_buffer   [TLB_MAX_BYTES_PER_BLOCK], _text_command_buffer_length   = 0;
     uint8_t _radio_command_buffer  [19],                      _radio_command_buffer_length  = 0;
     uint8_t _bitmap_command_buffer [TLB_MAX_BYTES_PER_BLOCK], _bitmap_command_buffer_length = 0;
     
+    //Largest block which is sent (text and bitmaps are split into blocks of this size)
+    uint8_t _block_size = (TLB_DEFAULT_BYTES_PER_BLOCK < TLB_MAX_BYTES_PER_BLOCK) ? TLB_DEFAULT_BYTES_PER_BLOCK : TLB_MAX_BYTES_PER_BLOCK;
+    
     ///FUNCTIONS
     
     //Manipulate the transmission buffers
@@ -249,17 +612,90 @@ class TLBFISLib
     void wipe_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index);
     
     //Send the transmission buffer
-    bool send_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index);
+    status send_tx_buffer(uint8_t* tx_buffer, uint8_t tx_buffer_size, uint8_t &tx_buffer_index);
+    
+    //Send a block of the given size which doesn't change the screen, for calibrateBlockSize()
+    status probe_block(uint8_t size);
+    
+    //Apply the retry policy
+    bool deadline_passed();
+    void back_off(uint8_t &attempts);
+    
+    //Adapt the pauses between blocks to the cluster
+    unsigned long pace_block();
+    void pace_retry(uint8_t &attempts);
+    void record_pacing(uint8_t repeats, unsigned long paced, unsigned long attempt_start);
+    
+    //Refresh the registered widgets of a lane which are due
+    void refresh_widgets(lane widget_lane, unsigned long start);
+    
+    //Send the next blocks of the queued bitmaps
+    status send_bulk();
+    
+    //Record latencies into the histograms
+    void record_latency(uint16_t* histogram, unsigned long start);
+    void record_opcode_latency(uint8_t opcode, unsigned long enqueued);
+    
+    //Count an answer of the cluster into the transport statistics
+    void record_transport(TLBLib::sendStatus answer, uint8_t* tx_buffer, unsigned long block_start);
+    //Count a block which was given up on
+    void record_given_up();
+    
+    //Transmit a block with the block send function
+    status send_block(uint8_t* tx_buffer, unsigned long enqueued);
+    status wait_block_send();
+    
+    //Add a block to the submission queue, waiting for a free slot
+    status submit_block(uint8_t* tx_buffer, unsigned long enqueued);
+    //Transmit the blocks waiting in the submission queue
+    void transmit_queue();
+    
+    //Fill or clip an area (absolute coordinates), restoring the workspace before the next command that depends on it
+    status fill_area(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on);
+    status clip_area(uint8_t X, uint8_t Y, uint8_t W, uint8_t H);
+    status restore_workspace();
+    
+    //Rasterize shapes
+    status draw_shape(const raster_shape &shape);
+    void rasterize(const raster_shape &shape, raster_target &target);
+    void plot(raster_target &target, int16_t X, int16_t Y);
+    void unplot_fills(const raster_shape &shape, raster_target &target);
+    
+    //Encode bitmaps
+    status send_bitmap_rows(uint8_t startX, uint8_t startY, uint8_t bytes_per_line, const uint8_t* bitmap, uint8_t width_in_bytes, uint8_t rows, bool fromPGM, bool repeat_row = false);
+    bool read_stream_row(bitmapRowFunction_type function, uint8_t row, uint8_t* data, uint8_t startX, uint8_t Y, uint8_t width, bool grayscale);
+    uint16_t plan_bitmap_rows(uint8_t* actions, uint8_t rows, uint8_t bytes_per_line, bool shrink_workspace, bool apply);
     
     //Determine text width
     uint8_t  _charWidth(uint8_t message);
     uint16_t _stringWidth(uint8_t* message, size_t length, bool fromPGM = false);
     
+    //Merge consecutive text into one block
+    bool can_merge_text(uint8_t startX, uint8_t startY, size_t length);
+    status end_text_block(uint16_t end_X);
+    
     //Write text
-    void _writeChar(uint8_t startX, uint8_t startY, uint8_t character);
-    void _writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message, bool fromPGM = false);
-    void _writeMultiLineText(uint8_t startX, uint8_t startY, char* message, bool fromPGM = false);
-    void _writeRadioText(bool line, size_t length, uint8_t* message, bool raw = false, bool fromPGM = false);
+    status _writeChar(uint8_t startX, uint8_t startY, uint8_t character);
+    status _writeText(uint8_t startX, uint8_t startY, size_t length, uint8_t* message, bool fromPGM = false, bool encoded = false, uint16_t encoded_width = 0);
+    status _writeMultiLineText(uint8_t startX, uint8_t startY, char* message, bool fromPGM = false);
+    
+    //Format text straight into the text buffer, converting and measuring characters as they are produced
+    struct text_stream {
+      text_stream(TLBFISLib &instance, uint8_t X, uint8_t Y);
+      void put(uint8_t character);
+      void put_number(uint32_t value, uint32_t fraction, uint8_t decimals, char sign, uint8_t base, uint8_t width, bool left_justify, bool zero_pad, bool uppercase = false);
+      status finish();
+      void start_block(uint16_t X);
+      TLBFISLib &lib;
+      uint8_t startX, startY;
+      uint16_t end_X; //X coordinate where the next character will be written
+      bool aligned; //set for right/center alignment, which can't be split into multiple blocks
+      bool empty = true; //set while no characters were added
+      status result = SENT;
+    };
+    status vprint_at(uint8_t startX, uint8_t startY, const char* format, va_list args, bool fromPGM);
+    uint8_t next_format_char(const char* &format, bool fromPGM);
+    status _writeRadioText(bool line, size_t length, uint8_t* message, bool raw = false, bool fromPGM = false);
 };
 
 #endif
@@ -0,0 +1,491 @@
+#include "TLBFISMenu.h"
+
+/**
+  Function:
+    TLBFISMenu(TLBFISLib &fis, (uint8_t X, uint8_t Y, uint8_t W, uint8_t rows, uint8_t row_height))
+  
+  Parameters:
+    fis          -> instance of the FIS library to draw with
+    (X, Y)       -> coordinates of the top-left corner of the menu (as given to setWorkspace())
+    (W)          -> width of the menu
+    (rows)       -> how many items are visible at once
+    (row_height) -> height of each row (in pixels)
+  
+  Default parameters:
+    (X = 0, Y = 0, W = 64) -> the entire width of the screen
+    (rows = 6, row_height = 8) -> the entire height of the HALFSCREEN size
+  
+  Description:
+    Creates a menu which keeps track of its items, the selected item and the visible part of the list.
+  
+  Notes:
+    *Moving the cursor within the visible rows only toggles the highlighting of two lines; scrolling changes the item of every row, so the menu is
+    then drawn entirely (which takes fewer blocks than rewriting each row in its own workspace).
+    *Each function sets the workspace to the menu's area while drawing, and sets back the previous workspace afterwards; for the fastest cursor
+    movements, leave the workspace set to the menu's area (this is already the case for a menu covering the entire screen).
+    *The items are written with the current text settings of the library (font, alignment, transparency).
+    *Cursor movements are always sent right away; if the menu is registered with TLBFISLib::addWidget(), TLBFISLib::update() redraws it after
+    invalidate() (or initScreen()).
+*/
+TLBFISMenu::TLBFISMenu(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W, uint8_t rows, uint8_t row_height) :
+  FIS(fis),
+  _X(X),
+  _Y(Y),
+  _W(W),
+  _rows(rows ? rows : 1),
+  _row_height(row_height)
+{}
+
+/**
+  Function:
+    setItems(const char* items[], uint8_t count, (bool fromPGM))
+  
+  Parameters:
+    items[]   -> array of strings to display
+    count     -> how many strings there are in the array
+    (fromPGM) -> whether or not the strings are stored in PROGMEM (the array itself must be stored in RAM)
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Description:
+    Sets the list of items and moves the cursor to the first one.
+  
+  Notes:
+    *The strings are not copied, so they must remain valid while the menu is used.
+    *The menu is redrawn entirely by the next function which updates the screen.
+*/
+void TLBFISMenu::setItems(const char* const* items, uint8_t count, bool fromPGM)
+{
+  _items = items;
+  _item_count = count;
+  _fromPGM = fromPGM;
+  
+  _cursor = 0;
+  _first = 0;
+  invalidate();
+}
+
+/**
+  Function:
+    draw()
+  
+  Returns:
+    status -> SENT if the menu was drawn, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Clears the menu's area and draws the visible items, highlighting the selected one.
+*/
+TLBFISLib::status TLBFISMenu::draw()
+{
+  //Set the workspace to the menu's area and clear it.
+  TLBFISLib::status result = enter_area(true);
+  
+  //Write every visible item.
+  for (uint8_t row = 0; row < _rows && result == TLBFISLib::SENT; row++) {
+    const char* item = item_at(_first, row);
+    
+    if (item) {
+      result = FIS.writeText(0, row * _row_height, item, _fromPGM);
+    }
+    
+    //Highlight the selected item.
+    if (result == TLBFISLib::SENT && item && _first + row == _cursor) {
+      result = FIS.toggleHighlight(row * _row_height);
+    }
+  }
+  
+  //The screen only matches the state if everything was sent.
+  _drawn = (result == TLBFISLib::SENT);
+  
+  //Set back the previous workspace.
+  TLBFISLib::status leave_result = leave_area();
+  return (result != TLBFISLib::SENT) ? result : leave_result;
+}
+
+/**
+  Function:
+    next()
+  
+  Returns:
+    status -> SENT if the screen was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Moves the cursor to the next item, scrolling the list if necessary.
+  
+  Notes:
+    *If the last item is selected, nothing happens.
+*/
+TLBFISLib::status TLBFISMenu::next()
+{
+  //If the last item is selected, there is nowhere to go.
+  if (_cursor + 1 >= _item_count) {
+    return _drawn ? TLBFISLib::SENT : draw();
+  }
+  
+  return move_to(_cursor + 1);
+}
+
+/**
+  Function:
+    previous()
+  
+  Returns:
+    status -> SENT if the screen was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Moves the cursor to the previous item, scrolling the list if necessary.
+  
+  Notes:
+    *If the first item is selected, nothing happens.
+*/
+TLBFISLib::status TLBFISMenu::previous()
+{
+  //If the first item is selected, there is nowhere to go.
+  if (!_cursor) {
+    return _drawn ? TLBFISLib::SENT : draw();
+  }
+  
+  return move_to(_cursor - 1);
+}
+
+/**
+  Function:
+    select(uint8_t index)
+  
+  Parameters:
+    index -> index of the item to select
+  
+  Returns:
+    status -> SENT if the screen was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Moves the cursor to the given item, scrolling the list as little as possible to make it visible.
+*/
+TLBFISLib::status TLBFISMenu::select(uint8_t index)
+{
+  return move_to(index);
+}
+
+/**
+  Function:
+    redrawItem(uint8_t index)
+  
+  Parameters:
+    index -> index of the item whose text was changed
+  
+  Returns:
+    status -> SENT if the screen was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Rewrites a single item, if it's visible.
+*/
+TLBFISLib::status TLBFISMenu::redrawItem(uint8_t index)
+{
+  //If the menu wasn't drawn yet, draw it entirely.
+  if (!_drawn) {
+    return draw();
+  }
+  
+  //If the item isn't visible, there is nothing to do.
+  if (index < _first || index >= _first + _rows) {
+    return TLBFISLib::SENT;
+  }
+  
+  //Set the workspace to the menu's area, exiting if it fails.
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result = enter_area();
+  if (result != TLBFISLib::SENT) {
+    return result;
+  }
+  
+  //Rewrite the row (if nothing was sent, see screen_untouched(), the screen still matches the state).
+  result = draw_row(index - _first);
+  if (result != TLBFISLib::SENT && !screen_untouched(FIS, blocks)) {
+    _drawn = false;
+  }
+  
+  //Set back the previous workspace.
+  TLBFISLib::status leave_result = leave_area();
+  return (result != TLBFISLib::SENT) ? result : leave_result;
+}
+
+/**
+  Function:
+    invalidate()
+  
+  Description:
+    Makes the next function which updates the screen redraw the entire menu (for example after the screen was cleared).
+*/
+void TLBFISMenu::invalidate()
+{
+  _drawn = false;
+  mark_dirty();
+}
+
+/**
+  Function:
+    refresh()
+  
+  Returns:
+    status -> SENT if the menu is displayed, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Draws the entire menu if the screen doesn't match it; cursor movements are already sent when they happen.
+*/
+TLBFISLib::status TLBFISMenu::refresh()
+{
+  return _drawn ? TLBFISLib::SENT : draw();
+}
+
+/**
+  Function:
+    getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the menu (output, on the screen)
+    W, H -> dimensions of the menu (output)
+  
+  Description:
+    Provides the area covered by the menu.
+*/
+void TLBFISMenu::getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  X = _X;
+  Y = _Y;
+  W = _W;
+  H = _rows * _row_height;
+}
+
+/**
+  Function:
+    getSelected()
+  
+  Returns:
+    uint8_t -> index of the selected item
+  
+  Description:
+    Provides the index of the item where the cursor is.
+*/
+uint8_t TLBFISMenu::getSelected()
+{
+  return _cursor;
+}
+
+/**
+  Function:
+    getFirstVisible()
+  
+  Returns:
+    uint8_t -> index of the item on the first row
+  
+  Description:
+    Provides the index of the first visible item.
+*/
+uint8_t TLBFISMenu::getFirstVisible()
+{
+  return _first;
+}
+
+/**
+  Function:
+    getItemCount()
+  
+  Returns:
+    uint8_t -> number of items
+  
+  Description:
+    Provides the number of items given to setItems().
+*/
+uint8_t TLBFISMenu::getItemCount()
+{
+  return _item_count;
+}
+
+/**
+  Function:
+    move_to(uint8_t index)
+  
+  Parameters:
+    index -> index of the item to select
+  
+  Returns:
+    status -> SENT if the screen was updated, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Moves the cursor, scrolls the list as little as possible and updates the screen: only the highlighting if the visible items didn't change,
+    everything otherwise.
+*/
+TLBFISLib::status TLBFISMenu::move_to(uint8_t index)
+{
+  //Constrain the index.
+  if (index >= _item_count) {
+    index = _item_count ? (_item_count - 1) : 0;
+  }
+  
+  //Scroll the list as little as possible to make the new item visible.
+  uint8_t old_first = _first;
+  uint8_t old_cursor = _cursor;
+  if (index < _first) {
+    _first = index;
+  }
+  else if (index >= _first + _rows) {
+    _first = index - _rows + 1;
+  }
+  _cursor = index;
+  
+  //If the screen doesn't match the previous state, or the list scrolled, draw everything.
+  //Every row then shows a different item, and a single clear of the menu's area is cheaper than clipping, clearing and writing each row.
+  if (!_drawn || _first != old_first) {
+    return draw();
+  }
+  
+  //If nothing changed, there is nothing to do.
+  if (_cursor == old_cursor) {
+    return TLBFISLib::SENT;
+  }
+  
+  //Set the workspace to the menu's area, exiting if it fails.
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result = enter_area();
+  if (result != TLBFISLib::SENT) {
+    _drawn = screen_untouched(FIS, blocks);
+    return result;
+  }
+  
+  //Remove the highlighting of the previous item and highlight the new one.
+  result = FIS.toggleHighlight((old_cursor - _first) * _row_height);
+  if (result == TLBFISLib::SENT) {
+    result = FIS.toggleHighlight((_cursor - _first) * _row_height);
+  }
+  
+  //If anything failed, the screen no longer matches the state (unless nothing was sent, see screen_untouched()).
+  if (result != TLBFISLib::SENT && !screen_untouched(FIS, blocks)) {
+    _drawn = false;
+  }
+  
+  //Set back the previous workspace.
+  TLBFISLib::status leave_result = leave_area();
+  return (result != TLBFISLib::SENT) ? result : leave_result;
+}
+
+/**
+  Function:
+    enter_area((bool clear))
+  
+  Parameters:
+    (clear) -> whether or not to also clear the menu's area
+  
+  Default parameters:
+    (clear = false)
+  
+  Returns:
+    status -> SENT if the workspace was set, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Saves the current workspace and sets the workspace to the menu's area, if it isn't already.
+*/
+TLBFISLib::status TLBFISMenu::enter_area(bool clear)
+{
+  //Save the current workspace.
+  _saved_X = FIS.getWorkspaceX();
+  _saved_Y = FIS.getWorkspaceY();
+  _saved_W = FIS.getWorkspaceWidth();
+  _saved_H = FIS.getWorkspaceHeight();
+  
+  //If it's already the menu's area, it only needs to be cleared (if requested).
+  if (_saved_X == _X && _saved_Y == _Y && _saved_W == _W && _saved_H == _rows * _row_height) {
+    _clipped = false;
+    return clear ? FIS.clear() : TLBFISLib::SENT;
+  }
+  
+  _clipped = true;
+  return FIS.setWorkspace(_X, _Y, _W, _rows * _row_height, clear);
+}
+
+/**
+  Function:
+    leave_area()
+  
+  Returns:
+    status -> SENT if the workspace was set, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Sets back the workspace saved by enter_area(), if it was changed.
+*/
+TLBFISLib::status TLBFISMenu::leave_area()
+{
+  //If the workspace wasn't changed, there is nothing to do.
+  if (!_clipped) {
+    return TLBFISLib::SENT;
+  }
+  
+  _clipped = false;
+  return FIS.setWorkspace(_saved_X, _saved_Y, _saved_W, _saved_H);
+}
+
+/**
+  Function:
+    draw_row(uint8_t row)
+  
+  Parameters:
+    row -> index of the visible row to draw
+  
+  Returns:
+    status -> SENT if the row was drawn, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Clears a single row and writes its item (highlighting it if selected), using a workspace clipped to the row.
+*/
+TLBFISLib::status TLBFISMenu::draw_row(uint8_t row)
+{
+  //Clip the workspace to the row and clear it.
+  _clipped = true;
+  TLBFISLib::status result = FIS.setWorkspace(_X, _Y + row * _row_height, _W, _row_height, true);
+  if (result != TLBFISLib::SENT) {
+    return result;
+  }
+  
+  //If the row is past the end of the list, leave it empty.
+  const char* item = item_at(_first, row);
+  if (!item) {
+    return TLBFISLib::SENT;
+  }
+  
+  //Write the item.
+  result = FIS.writeText(0, 0, item, _fromPGM);
+  if (result != TLBFISLib::SENT) {
+    return result;
+  }
+  
+  //Highlight it, if it's selected.
+  if (_first + row == _cursor) {
+    result = FIS.toggleHighlight(0);
+  }
+  
+  return result;
+}
+
+/**
+  Function:
+    item_at(uint8_t first, uint8_t row)
+  
+  Parameters:
+    first -> index of the item on the first row
+    row   -> index of the visible row
+  
+  Returns:
+    const char* -> the item shown on the row (nullptr if the row is past the end of the list)
+  
+  Description:
+    Determines which item is shown on a row.
+*/
+const char* TLBFISMenu::item_at(uint8_t first, uint8_t row)
+{
+  uint16_t index = first + row;
+  if (!_items || index >= _item_count) {
+    return nullptr;
+  }
+  
+  return _items[index];
+}
@@ -0,0 +1,80 @@
+#ifndef TLBFISMenu_h
+#define TLBFISMenu_h
+
+#include "TLBFISWidget.h" //widget base class
+
+class TLBFISMenu : public TLBFISWidget
+{
+  public:
+    //Constructor (the menu occupies "rows" lines of "row_height" pixels, starting at X, Y)
+    TLBFISMenu(TLBFISLib &fis, uint8_t X = 0, uint8_t Y = 0, uint8_t W = 64, uint8_t rows = 6, uint8_t row_height = 8);
+    
+    //Set the list of items (the array must remain valid while the menu is used)
+    void setItems(const char* const* items, uint8_t count, bool fromPGM = false);
+    
+    //Draw the entire menu
+    TLBFISLib::status draw();
+    
+    //Move the cursor to the next/previous item
+    TLBFISLib::status next();
+    TLBFISLib::status previous();
+    //Move the cursor to the given item
+    TLBFISLib::status select(uint8_t index);
+    
+    //Redraw an item whose text was changed
+    TLBFISLib::status redrawItem(uint8_t index);
+    
+    //Draw the entire menu, if the screen doesn't match it
+    TLBFISLib::status refresh();
+    
+    //Make the next update redraw the entire menu
+    void invalidate();
+    
+    //Get the area covered by the menu
+    void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Get the index of the selected item
+    uint8_t getSelected();
+    //Get the index of the first visible item
+    uint8_t getFirstVisible();
+    //Get the number of items
+    uint8_t getItemCount();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Area of the menu (screen coordinates)
+    uint8_t _X, _Y, _W, _rows, _row_height;
+    
+    //Items
+    const char* const* _items = nullptr;
+    uint8_t _item_count = 0;
+    bool _fromPGM = false;
+    
+    //State
+    uint8_t _cursor = 0; //index of the selected item
+    uint8_t _first = 0; //index of the item on the first row
+    bool _drawn = false; //set when the screen matches the state above
+    
+    //Workspace which was set before the menu started drawing
+    uint8_t _saved_X, _saved_Y, _saved_W, _saved_H;
+    bool _clipped = false; //set while the workspace is not the one the menu was entered with
+    
+    ///FUNCTIONS
+    
+    //Move the cursor and update the screen
+    TLBFISLib::status move_to(uint8_t index);
+    
+    //Manage the workspace
+    TLBFISLib::status enter_area(bool clear = false);
+    TLBFISLib::status leave_area();
+    
+    //Draw a single row
+    TLBFISLib::status draw_row(uint8_t row);
+    
+    //Get the item shown on a row, given the first visible item
+    const char* item_at(uint8_t first, uint8_t row);
+};
+
+#endif
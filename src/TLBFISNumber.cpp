@@ -0,0 +1,417 @@
+#include "TLBFISNumber.h"
+
+/**
+  Function:
+    TLBFISNumber(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t digits, (uint8_t decimals), (bool is_signed))
+  
+  Parameters:
+    fis         -> instance of the FIS library to draw with
+    X, Y        -> coordinates of the top-left corner of the field (relative to the workspace)
+    digits      -> how many digits the field displays, including the decimals (limited to TLBFIS_NUMBER_MAX_DIGITS)
+    (decimals)  -> how many of the digits are after the decimal point (the value is a fixed point number: 235 with 1 decimal is "23.5")
+    (is_signed) -> whether negative values can be displayed (a place for the minus sign is reserved)
+  
+  Default parameters:
+    (decimals = 0)
+    (is_signed = false)
+  
+  Description:
+    Creates a right-aligned numeric field of constant width, for values which are refreshed often (RPM, speed, temperature).
+  
+  Notes:
+    *The field is padded on the left with blank characters (as wide as the missing digits), so it always covers the same area and the digits
+    always stay in the same place.
+    *When the value changes, only the characters between the first and the last one which changed are sent.
+    *Values which don't fit are limited to the largest one which does (for example 999 for 3 digits).
+*/
+TLBFISNumber::TLBFISNumber(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t digits, uint8_t decimals, bool is_signed) :
+  FIS(fis),
+  _X(X),
+  _Y(Y),
+  _digits(digits ? ((digits > TLBFIS_NUMBER_MAX_DIGITS) ? TLBFIS_NUMBER_MAX_DIGITS : digits) : 1),
+  _decimals(decimals),
+  _signed(is_signed)
+{
+  //At least one digit must be before the decimal point.
+  if (_decimals >= _digits) {
+    _decimals = _digits - 1;
+  }
+}
+
+/**
+  Function:
+    setFont(TLBFISLib::font text_font)
+  
+  Parameters:
+    text_font -> which font to use (STANDARD/COMPACT)
+  
+  Description:
+    Selects the font used by the field (COMPACT by default); the field is drawn again by the next update.
+*/
+void TLBFISNumber::setFont(TLBFISLib::font text_font)
+{
+  _font = (text_font == TLBFISLib::STANDARD) ? TLBFISLib::STANDARD : TLBFISLib::COMPACT;
+  invalidate();
+}
+
+/**
+  Function:
+    setUnit(const char unit[], (bool fromPGM))
+  
+  Parameters:
+    unit[]    -> the text to display after the number (nullptr for none)
+    (fromPGM) -> whether or not the string is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Description:
+    Sets a unit which is displayed after the number; it's only drawn together with the entire field.
+*/
+void TLBFISNumber::setUnit(const char* unit, bool fromPGM)
+{
+  _unit = unit;
+  _unit_fromPGM = fromPGM;
+  invalidate();
+}
+
+/**
+  Function:
+    setValue(int32_t value)
+  
+  Parameters:
+    value -> the value to display (for fields with decimals, in units of the last decimal)
+  
+  Returns:
+    status -> SENT if the field was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Displays a value, sending only the characters which differ from the ones displayed, as a single text command.
+  
+  Notes:
+    *If the field is registered with TLBFISLib::addWidget(), the value is only sent by TLBFISLib::update().
+*/
+TLBFISLib::status TLBFISNumber::setValue(int32_t value)
+{
+  //If the value doesn't change, there is nothing to do.
+  if (_drawn && value == _value) {
+    return TLBFISLib::SENT;
+  }
+  _value = value;
+  
+  return request_refresh();
+}
+
+/**
+  Function:
+    refresh()
+  
+  Returns:
+    status -> SENT if the field was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Sends the characters of the value which differ from the ones displayed, as a single text command.
+*/
+TLBFISLib::status TLBFISNumber::refresh()
+{
+  //If the screen doesn't match the state, draw everything.
+  if (!_drawn) {
+    return draw();
+  }
+  
+  select_settings();
+  
+  uint8_t chars[TLBFIS_NUMBER_MAX_CHARS], widths[TLBFIS_NUMBER_MAX_CHARS];
+  uint8_t length = render(_value, chars, widths);
+  
+  //The field always has the same width, so characters at the same distance from its start or from its end are in the same place.
+  uint8_t shortest = (length < _length) ? length : _length;
+  uint8_t first = 0;
+  while (first < shortest && chars[first] == _chars[first]) {
+    first++;
+  }
+  uint8_t last = 0; //how many characters at the end are the same
+  while (first + last < shortest && chars[length - 1 - last] == _chars[_length - 1 - last]) {
+    last++;
+  }
+  
+  //Send the characters in between, which cover exactly the ones which changed.
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result = TLBFISLib::SENT;
+  if (first + last < length) {
+    uint8_t startX = 0, width = 0;
+    for (uint8_t i = 0; i < first; i++) {
+      startX += widths[i];
+    }
+    for (uint8_t i = first; i < length - last; i++) {
+      width += widths[i];
+    }
+    
+    result = FIS.writeEncodedText(_X + startX, _Y, length - last - first, chars + first, width);
+    if (result == TLBFISLib::SENT) {
+      result = FIS.flush();
+    }
+  }
+  
+  restore_settings();
+  
+  //If it failed, the displayed characters are unknown, so the entire field will be drawn again (unless nothing was sent, see screen_untouched()).
+  if (result != TLBFISLib::SENT) {
+    _drawn = screen_untouched(FIS, blocks);
+    return result;
+  }
+  
+  memcpy(_chars, chars, length);
+  _length = length;
+  return result;
+}
+
+/**
+  Function:
+    draw()
+  
+  Returns:
+    status -> SENT if the field was drawn, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Draws the entire field and the unit (for example after the screen was initialized).
+*/
+TLBFISLib::status TLBFISNumber::draw()
+{
+  _drawn = false;
+  select_settings();
+  
+  uint8_t widths[TLBFIS_NUMBER_MAX_CHARS];
+  _length = render(_value, _chars, widths);
+  uint8_t width = getWidth();
+  
+  TLBFISLib::status result = FIS.writeEncodedText(_X, _Y, _length, _chars, width);
+  
+  //The unit continues the same text command.
+  if (result == TLBFISLib::SENT && _unit) {
+    result = FIS.writeText(_X + width, _Y, _unit, _unit_fromPGM);
+  }
+  if (result == TLBFISLib::SENT) {
+    result = FIS.flush();
+  }
+  
+  restore_settings();
+  
+  _drawn = (result == TLBFISLib::SENT);
+  return result;
+}
+
+/**
+  Function:
+    invalidate()
+  
+  Description:
+    Makes the next update redraw the entire field (for example after the screen was initialized).
+*/
+void TLBFISNumber::invalidate()
+{
+  _drawn = false;
+  mark_dirty();
+}
+
+/**
+  Function:
+    getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the field (output, relative to the workspace)
+    W, H -> dimensions of the field, including the unit (output)
+  
+  Description:
+    Provides the area covered by the field.
+*/
+void TLBFISNumber::getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  X = _X;
+  Y = _Y;
+  W = getWidth();
+  H = 7;
+  
+  //Measure the unit with the field's font, keeping the user's font afterwards.
+  if (_unit) {
+    TLBFISLib::font prev_font = FIS.getFont();
+    FIS.setFont(_font);
+    W += FIS.stringWidth(_unit, _unit_fromPGM);
+    FIS.setFont(prev_font);
+  }
+}
+
+/**
+  Function:
+    getWidth()
+  
+  Returns:
+    uint8_t -> width of the field, without the unit (in pixels)
+  
+  Description:
+    Calculates how wide the field is, with the selected font: a place for the sign (if signed), the digits and the decimal point.
+*/
+uint8_t TLBFISNumber::getWidth()
+{
+  //Measure the characters with the field's font, keeping the user's font afterwards.
+  TLBFISLib::font prev_font = FIS.getFont();
+  FIS.setFont(_font);
+  
+  uint8_t width = _digits * FIS.charWidth('0');
+  if (_signed) {
+    width += FIS.charWidth('-');
+  }
+  if (_decimals) {
+    width += FIS.charWidth('.');
+  }
+  
+  FIS.setFont(prev_font);
+  return width;
+}
+
+/**
+  Function:
+    render(int32_t value, uint8_t chars[], uint8_t widths[])
+  
+  Parameters:
+    value    -> the value to convert
+    chars[]  -> buffer for the characters (in the cluster's character set)
+    widths[] -> buffer for the width of each character
+  
+  Returns:
+    uint8_t -> how many characters were written in the buffers
+  
+  Description:
+    Converts a value to the characters which display it, padded on the left with blank characters up to the width of the field.
+  
+  Notes:
+    *The field's font must be selected.
+*/
+uint8_t TLBFISNumber::render(int32_t value, uint8_t* chars, uint8_t* widths)
+{
+  //Unsigned fields can't display negative values.
+  if (value < 0 && !_signed) {
+    value = 0;
+  }
+  bool negative = (value < 0);
+  uint32_t magnitude = negative ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+  
+  //Limit the value to the number of digits.
+  uint32_t limit = 1;
+  for (uint8_t i = 0; i < _digits; i++) {
+    limit *= 10;
+  }
+  if (magnitude >= limit) {
+    magnitude = limit - 1;
+  }
+  
+  //Determine the digits, from the last one; there is always one before the decimal point.
+  char digits[TLBFIS_NUMBER_MAX_DIGITS];
+  uint8_t count = 0;
+  do {
+    digits[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude || count <= _decimals);
+  
+  //Calculate how much space is left for padding.
+  uint8_t digit_width = FIS.charWidth('0');
+  uint8_t width = count * digit_width + (negative ? FIS.charWidth('-') : 0) + (_decimals ? FIS.charWidth('.') : 0);
+  uint8_t padding = getWidth() - width;
+  
+  uint8_t length = 0;
+  width = 0;
+  
+  //With the COMPACT font, pad with the blank characters (2, 3, 5 and 6 pixels wide), which can cover any width except 1 pixel.
+  if (_font == TLBFISLib::COMPACT) {
+    while (padding >= 8) {
+      add_char(4, chars, widths, length, width);
+      padding -= 6;
+    }
+    switch (padding) {
+      case 2: add_char(1, chars, widths, length, width); break;
+      case 3: add_char(2, chars, widths, length, width); break;
+      case 4: add_char(1, chars, widths, length, width); add_char(1, chars, widths, length, width); break;
+      case 5: add_char(3, chars, widths, length, width); break;
+      case 6: add_char(4, chars, widths, length, width); break;
+      case 7: add_char(3, chars, widths, length, width); add_char(1, chars, widths, length, width); break;
+    }
+  }
+  //With the STANDARD font, all characters are as wide as a space.
+  else {
+    uint8_t space_width = FIS.charWidth(' ');
+    while (padding >= space_width) {
+      add_char(' ', chars, widths, length, width);
+      padding -= space_width;
+    }
+  }
+  
+  if (negative) {
+    add_char('-', chars, widths, length, width);
+  }
+  while (count) {
+    //The decimal point goes before the decimals.
+    if (count == _decimals) {
+      add_char('.', chars, widths, length, width);
+    }
+    add_char(digits[--count], chars, widths, length, width);
+  }
+  
+  return length;
+}
+
+/**
+  Function:
+    add_char(uint8_t character, uint8_t chars[], uint8_t widths[], uint8_t &length, uint8_t &width)
+  
+  Parameters:
+    character -> the character to add
+    chars[]   -> buffer for the characters
+    widths[]  -> buffer for the width of each character
+    length    -> how many characters are in the buffers (increased)
+    width     -> total width of the characters (increased)
+  
+  Description:
+    Converts a character to the cluster's character set and adds it to a rendered value.
+*/
+void TLBFISNumber::add_char(uint8_t character, uint8_t* chars, uint8_t* widths, uint8_t &length, uint8_t &width)
+{
+  if (length >= TLBFIS_NUMBER_MAX_CHARS) {
+    return;
+  }
+  
+  chars[length] = FIS.encodeChar(character);
+  widths[length] = FIS.charWidth(character);
+  width += widths[length];
+  length++;
+}
+
+/**
+  Function:
+    select_settings()
+  
+  Description:
+    Saves the text settings and selects the ones used by the field (its font, OPAQUE, LEFT).
+*/
+void TLBFISNumber::select_settings()
+{
+  _saved_font = FIS.getFont();
+  _saved_transparency = FIS.getTextTransparency();
+  _saved_alignment = FIS.getTextAlignment();
+  FIS.setFont(_font);
+  FIS.setTextTransparency(TLBFISLib::OPAQUE);
+  FIS.setTextAlignment(TLBFISLib::LEFT);
+}
+
+/**
+  Function:
+    restore_settings()
+  
+  Description:
+    Restores the text settings saved by select_settings().
+*/
+void TLBFISNumber::restore_settings()
+{
+  FIS.setFont(_saved_font);
+  FIS.setTextTransparency(_saved_transparency);
+  FIS.setTextAlignment(_saved_alignment);
+}
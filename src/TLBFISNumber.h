@@ -0,0 +1,75 @@
+#ifndef TLBFISNumber_h
+#define TLBFISNumber_h
+
+#include "TLBFISWidget.h" //widget base class
+
+#define TLBFIS_NUMBER_MAX_DIGITS 9  //how many digits a numeric field can have
+#define TLBFIS_NUMBER_MAX_CHARS  24 //how many characters a numeric field can be made of (digits, sign, decimal point and padding)
+
+class TLBFISNumber : public TLBFISWidget
+{
+  public:
+    //Constructor (the field starts at X, Y, relative to the workspace)
+    TLBFISNumber(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t digits, uint8_t decimals = 0, bool is_signed = false);
+    
+    //Set the font (STANDARD / COMPACT)
+    void setFont(TLBFISLib::font text_font);
+    //Set the text displayed after the number (the string must remain valid while the field is used)
+    void setUnit(const char* unit, bool fromPGM = false);
+    
+    //Display a value, sending only the characters which changed
+    TLBFISLib::status setValue(int32_t value);
+    
+    //Redraw the entire field
+    TLBFISLib::status draw();
+    
+    //Send the characters which differ from the value
+    TLBFISLib::status refresh();
+    
+    //Make the next update redraw the entire field
+    void invalidate();
+    
+    //Get the area covered by the field and the unit
+    void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Get the width of the field, without the unit (in pixels)
+    uint8_t getWidth();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Position of the field (workspace coordinates)
+    uint8_t _X, _Y;
+    
+    //Settings
+    uint8_t _digits, _decimals;
+    bool _signed;
+    TLBFISLib::font _font = TLBFISLib::COMPACT;
+    const char* _unit = nullptr;
+    bool _unit_fromPGM = false;
+    
+    //State
+    int32_t _value = 0;
+    uint8_t _chars[TLBFIS_NUMBER_MAX_CHARS]; //displayed characters, in the cluster's character set
+    uint8_t _length = 0;
+    bool _drawn = false; //set when the screen matches the state above
+    
+    //Text settings which were set before the field started drawing
+    TLBFISLib::font _saved_font;
+    TLBFISLib::transparency _saved_transparency;
+    TLBFISLib::alignment _saved_alignment;
+    
+    ///FUNCTIONS
+    
+    //Convert a value to the characters which display it
+    uint8_t render(int32_t value, uint8_t* chars, uint8_t* widths);
+    //Add a character to a rendered value
+    void add_char(uint8_t character, uint8_t* chars, uint8_t* widths, uint8_t &length, uint8_t &width);
+    
+    //Manage the text settings
+    void select_settings();
+    void restore_settings();
+};
+
+#endif
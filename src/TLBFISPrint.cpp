@@ -0,0 +1,132 @@
+#include "TLBFISPrint.h"
+
+/**
+  Function:
+    TLBFISPrint(TLBFISLib &fis, (uint8_t X), (uint8_t Y))
+  
+  Parameters:
+    fis    -> instance of the FIS library to write with
+    (X, Y) -> coordinates where printing starts (top-left pixel)
+  
+  Default parameters:
+    (X = 0)
+    (Y = 0)
+  
+  Description:
+    Creates an adapter which allows using the Arduino print() and println() functions (for numbers, floats, F() strings etc.) on the screen.
+  
+  Notes:
+    *Characters are written one by one with writeChar(), which converts them and adds them to the text waiting in the buffer, so a line
+    printed in one go is sent as a single block, without an intermediate string.
+    *Text merging must be enabled (it is by default) and the alignment should be LEFT, otherwise every character is sent separately.
+    *'\n' moves the cursor to the beginning of the next line, spaced like in writeMultiLineText().
+*/
+TLBFISPrint::TLBFISPrint(TLBFISLib &fis, uint8_t X, uint8_t Y) :
+  FIS(fis),
+  _start_X(X),
+  _X(X),
+  _Y(Y)
+{
+}
+
+/**
+  Function:
+    setCursor(uint8_t X, uint8_t Y)
+  
+  Parameters:
+    X, Y -> coordinates where the next character will be written (top-left pixel)
+  
+  Description:
+    Moves the cursor; following lines will also start at the given X coordinate.
+*/
+void TLBFISPrint::setCursor(uint8_t X, uint8_t Y)
+{
+  _start_X = _X = X;
+  _Y = Y;
+}
+
+/**
+  Function:
+    getCursorX()
+    getCursorY()
+  
+  Returns:
+    uint8_t -> coordinate where the next character will be written
+  
+  Description:
+    Provides the position of the cursor.
+*/
+uint8_t TLBFISPrint::getCursorX()
+{
+  return _X;
+}
+
+uint8_t TLBFISPrint::getCursorY()
+{
+  return _Y;
+}
+
+/**
+  Function:
+    getStatus()
+  
+  Returns:
+    status -> SENT if the last character was written, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Provides the result of the last character written, since print() only returns how many characters were written.
+*/
+TLBFISLib::status TLBFISPrint::getStatus()
+{
+  return _status;
+}
+
+/**
+  Function:
+    write(uint8_t character)
+  
+  Parameters:
+    character -> the character to write
+  
+  Returns:
+    size_t -> 1 if the character was written, 0 otherwise
+  
+  Description:
+    Writes a character at the cursor and advances it by the character's width.
+*/
+size_t TLBFISPrint::write(uint8_t character)
+{
+  //Ignore carriage returns, since println() sends "\r\n".
+  if (character == '\r') {
+    return 1;
+  }
+  
+  //Move to the next line, spaced like in writeMultiLineText().
+  if (character == '\n') {
+    _X = _start_X;
+    _Y += (FIS.getFont() == TLBFISLib::GRAPHICS) ? 7 : (7 + FIS.getLineSpacing());
+    return 1;
+  }
+  
+  _status = FIS.writeChar(_X, _Y, character);
+  if (_status != TLBFISLib::SENT) {
+    return 0;
+  }
+  
+  //Advance the cursor, stopping at the maximum coordinate.
+  uint16_t X = _X + FIS.charWidth(character);
+  _X = (X > 0xFF) ? 0xFF : X;
+  return 1;
+}
+
+/**
+  Function:
+    flush()
+  
+  Description:
+    Sends the text waiting to be merged with following characters (see TLBFISLib::flush()).
+*/
+void TLBFISPrint::flush()
+{
+  _status = FIS.flush();
+}
@@ -0,0 +1,39 @@
+#ifndef TLBFISPrint_h
+#define TLBFISPrint_h
+
+#include "TLBFISLib.h" //FIS library
+
+class TLBFISPrint : public Print
+{
+  public:
+    //Constructor (printing starts at X, Y)
+    TLBFISPrint(TLBFISLib &fis, uint8_t X = 0, uint8_t Y = 0);
+    
+    //Set where the next character will be written (and where lines start after a newline)
+    void setCursor(uint8_t X, uint8_t Y);
+    //Get where the next character will be written
+    uint8_t getCursorX();
+    uint8_t getCursorY();
+    
+    //Get the result of the last character written
+    TLBFISLib::status getStatus();
+    
+    //Write a character (used by all of the print() and println() functions)
+    size_t write(uint8_t character);
+    using Print::write;
+    
+    //Send the text waiting to be merged with following characters
+    void flush();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Cursor
+    uint8_t _start_X, _X, _Y;
+    
+    //Result of the last character written
+    TLBFISLib::status _status = TLBFISLib::SENT;
+};
+
+#endif
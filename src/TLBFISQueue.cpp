@@ -0,0 +1,170 @@
+#include "TLBFISQueue.h"
+
+/**
+  Function:
+    TLBFISQueue()
+  
+  Description:
+    Creates an empty submission queue, to be given to TLBFISLib::submissionQueue().
+  
+  Notes:
+    *The queue is a ring of encoded blocks with a single producer (the task which draws) and a single consumer (the task which calls
+    TLBFISLib::update()); neither side ever waits for the other, and no locks are used.
+    *Every slot takes TLB_MAX_BYTES_PER_BLOCK bytes, and one slot is always kept free to tell a full queue from an empty one; the number of slots
+    can be changed by defining TLBFIS_QUEUE_LENGTH before including the library.
+*/
+TLBFISQueue::TLBFISQueue()
+{
+  store(_head, 0);
+  store(_tail, 0);
+}
+
+/**
+  Function:
+    getCount()
+  
+  Returns:
+    uint8_t -> how many blocks are waiting to be transmitted
+  
+  Description:
+    Provides the number of queued blocks (from either side, it may change right after it was read).
+*/
+uint8_t TLBFISQueue::getCount()
+{
+  uint8_t head = load(_head), tail = load(_tail);
+  return (tail + TLBFIS_QUEUE_LENGTH - head) % TLBFIS_QUEUE_LENGTH;
+}
+
+/**
+  Function:
+    getCapacity()
+  
+  Returns:
+    uint8_t -> how many blocks the queue can hold
+  
+  Description:
+    Provides the size of the queue (TLBFIS_QUEUE_LENGTH - 1).
+*/
+uint8_t TLBFISQueue::getCapacity()
+{
+  return TLBFIS_QUEUE_LENGTH - 1;
+}
+
+/**
+  Function:
+    push(const uint8_t block[], unsigned long enqueued)
+  
+  Parameters:
+    block[]  -> the encoded block (command byte, length byte and "length" more bytes)
+    enqueued -> when the block was queued (in microseconds)
+  
+  Returns:
+    bool -> whether or not the block was added (false = the queue is full)
+  
+  Description:
+    Copies a block into the next free slot, then publishes it to the consumer.
+*/
+bool TLBFISQueue::push(const uint8_t* block, unsigned long enqueued)
+{
+  //If the slot after the last one is the oldest one, the queue is full.
+  uint8_t tail = load(_tail);
+  uint8_t next = (tail + 1) % TLBFIS_QUEUE_LENGTH;
+  if (next == load(_head)) {
+    return false;
+  }
+  
+  //The block consists of the command byte, the length byte and "length" more bytes.
+  uint8_t length = block[1] + 2;
+  if (length > TLB_MAX_BYTES_PER_BLOCK) {
+    length = TLB_MAX_BYTES_PER_BLOCK;
+  }
+  
+  //Fill the slot, then move the index, so the consumer only sees complete blocks.
+  memcpy(_slots[tail].data, block, length);
+  _slots[tail].enqueued = enqueued;
+  store(_tail, next);
+  return true;
+}
+
+/**
+  Function:
+    front(unsigned long &enqueued)
+  
+  Parameters:
+    enqueued -> when the block was queued (output, in microseconds)
+  
+  Returns:
+    uint8_t* -> the oldest block, or nullptr if the queue is empty
+  
+  Description:
+    Provides the block which should be transmitted next; it remains in the queue until pop() is called.
+*/
+uint8_t* TLBFISQueue::front(unsigned long &enqueued)
+{
+  uint8_t head = load(_head);
+  if (head == load(_tail)) {
+    return nullptr;
+  }
+  
+  enqueued = _slots[head].enqueued;
+  return _slots[head].data;
+}
+
+/**
+  Function:
+    pop()
+  
+  Description:
+    Removes the oldest block, giving its slot back to the producer.
+*/
+void TLBFISQueue::pop()
+{
+  uint8_t head = load(_head);
+  if (head == load(_tail)) {
+    return;
+  }
+  
+  store(_head, (head + 1) % TLBFIS_QUEUE_LENGTH);
+}
+
+/**
+  Function:
+    load(const tlbfis_queue_index &index)
+  
+  Parameters:
+    index -> the index to read
+  
+  Returns:
+    uint8_t -> the value of the index
+  
+  Description:
+    Reads an index, making the slots published by the other side (before it stored the index) visible to this side.
+*/
+uint8_t TLBFISQueue::load(const tlbfis_queue_index &index)
+{
+#ifdef __AVR__
+  return index;
+#else
+  return index.load(std::memory_order_acquire);
+#endif
+}
+
+/**
+  Function:
+    store(tlbfis_queue_index &index, uint8_t value)
+  
+  Parameters:
+    index -> the index to write
+    value -> its new value
+  
+  Description:
+    Writes an index, after everything this side wrote to the slots.
+*/
+void TLBFISQueue::store(tlbfis_queue_index &index, uint8_t value)
+{
+#ifdef __AVR__
+  index = value;
+#else
+  index.store(value, std::memory_order_release);
+#endif
+}
@@ -0,0 +1,58 @@
+#ifndef TLBFISQueue_h
+#define TLBFISQueue_h
+
+#include "TLBFISLib.h" //FIS library
+
+#ifndef TLBFIS_QUEUE_LENGTH
+#define TLBFIS_QUEUE_LENGTH 8 //how many slots a submission queue has (one of them is always kept free)
+#endif
+
+#ifdef __AVR__
+//Single-byte accesses are atomic on AVR, and there is only one core.
+typedef volatile uint8_t tlbfis_queue_index;
+#else
+#include <atomic> //atomic indices
+typedef std::atomic<uint8_t> tlbfis_queue_index;
+#endif
+
+class TLBFISQueue
+{
+  public:
+    //Constructor
+    TLBFISQueue();
+    
+    //Get how many blocks are waiting to be transmitted
+    uint8_t getCount();
+    //Get how many blocks the queue can hold
+    uint8_t getCapacity();
+  
+  private:
+    //Blocks are added and removed by the FIS library.
+    friend class TLBFISLib;
+    
+    //Slots
+    struct slot {
+      uint8_t data[TLB_MAX_BYTES_PER_BLOCK];
+      unsigned long enqueued; //when the block was queued (in microseconds), for the latency histograms
+    };
+    slot _slots[TLBFIS_QUEUE_LENGTH];
+    
+    //Indices (each one is only written by one side: _head by the consumer, _tail by the producer)
+    tlbfis_queue_index _head; //slot of the oldest block
+    tlbfis_queue_index _tail; //slot where the next block will be added
+    
+    ///FUNCTIONS
+    
+    //Producer side: add a block (returns false if the queue is full)
+    bool push(const uint8_t* block, unsigned long enqueued);
+    
+    //Consumer side: get the oldest block (nullptr if the queue is empty), then remove it once it was transmitted
+    uint8_t* front(unsigned long &enqueued);
+    void pop();
+    
+    //Access the indices with the memory ordering required for passing the slots between the two sides
+    static uint8_t load(const tlbfis_queue_index &index);
+    static void store(tlbfis_queue_index &index, uint8_t value);
+};
+
+#endif
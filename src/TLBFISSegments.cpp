@@ -0,0 +1,381 @@
+#include "TLBFISSegments.h"
+
+//Segments lit for each digit (bit 0 = segment A ... bit 6 = segment G)
+const uint8_t PROGMEM TLBFIS_SEGMENT_DIGITS[] = {
+  0x3F, //0
+  0x06, //1
+  0x5B, //2
+  0x4F, //3
+  0x66, //4
+  0x6D, //5
+  0x7D, //6
+  0x07, //7
+  0x7F, //8
+  0x6F  //9
+};
+
+/**
+  Function:
+    TLBFISSegments(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t digits, (uint8_t digit_width), (uint8_t digit_height), (uint8_t thickness), (uint8_t spacing))
+  
+  Parameters:
+    fis            -> instance of the FIS library to draw with
+    X, Y           -> coordinates of the top-left corner of the display (relative to the workspace)
+    digits         -> how many digits the display has (limited to TLBFIS_SEGMENTS_MAX_DIGITS)
+    (digit_width)  -> width of a digit (in pixels)
+    (digit_height) -> height of a digit (in pixels)
+    (thickness)    -> thickness of a segment (in pixels)
+    (spacing)      -> distance between two digits (in pixels)
+  
+  Default parameters:
+    (digit_width = 10)
+    (digit_height = 19)
+    (thickness = 2)
+    (spacing = 3)
+  
+  Description:
+    Creates a display of large digits, built from 7 rectangular segments each, for a primary readout like the speed.
+  
+  Notes:
+    *Every segment is a single fill command (7 bytes); when the value changes, only the segments which turn on or off are sent, turning the
+    pixels on or off.
+    *The workspace must be the same every time the display is updated.
+    *If it's cheaper, a digit is cleared entirely with one fill and only its lit segments are drawn again.
+*/
+TLBFISSegments::TLBFISSegments(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t digits, uint8_t digit_width, uint8_t digit_height, uint8_t thickness, uint8_t spacing) :
+  FIS(fis),
+  _X(X),
+  _Y(Y),
+  _digits(digits ? ((digits > TLBFIS_SEGMENTS_MAX_DIGITS) ? TLBFIS_SEGMENTS_MAX_DIGITS : digits) : 1),
+  _digit_width(digit_width),
+  _digit_height(digit_height),
+  _thickness(thickness ? thickness : 1),
+  _spacing(spacing)
+{
+  //The segments must fit in the digit.
+  if (_digit_width < 2 * _thickness + 1) {
+    _digit_width = 2 * _thickness + 1;
+  }
+  if (_digit_height < 3 * _thickness + 2) {
+    _digit_height = 3 * _thickness + 2;
+  }
+  
+  memset(_shown, 0, sizeof(_shown));
+  memset(_target, 0, sizeof(_target));
+}
+
+/**
+  Function:
+    setValue(int32_t value, (bool leading_zeros))
+  
+  Parameters:
+    value           -> the number to display
+    (leading_zeros) -> whether to fill the unused digits with zeros instead of leaving them blank
+  
+  Default parameters:
+    (leading_zeros = false)
+  
+  Returns:
+    status -> SENT if the display was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Displays a number, right-aligned, sending only the segments which change.
+  
+  Notes:
+    *Negative numbers are displayed with a minus sign (segment G) before the first digit, if there is space for it.
+    *Numbers which don't fit are limited to the largest one which does (for example 999 for 3 digits).
+    *If the display is registered with TLBFISLib::addWidget(), the value is only sent by TLBFISLib::update().
+*/
+TLBFISLib::status TLBFISSegments::setValue(int32_t value, bool leading_zeros)
+{
+  bool negative = (value < 0);
+  uint32_t magnitude = negative ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+  
+  //Negative numbers need a digit for the sign.
+  uint8_t available = (negative && _digits > 1) ? _digits - 1 : _digits;
+  if (negative && _digits == 1) {
+    magnitude = 0;
+  }
+  
+  //Limit the number to the available digits.
+  uint32_t limit = 1;
+  for (uint8_t i = 0; i < available; i++) {
+    limit *= 10;
+  }
+  if (magnitude >= limit) {
+    magnitude = limit - 1;
+  }
+  
+  //Fill the digits from the right.
+  int8_t digit = _digits - 1;
+  do {
+    _target[digit--] = pgm_read_byte_near(TLBFIS_SEGMENT_DIGITS + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude && digit >= 0);
+  
+  //Place the sign (before the leading zeros, if they are used), then blank or zero the rest.
+  if (leading_zeros) {
+    while (digit >= (negative ? 1 : 0)) {
+      _target[digit--] = pgm_read_byte_near(TLBFIS_SEGMENT_DIGITS);
+    }
+  }
+  if (negative && digit >= 0) {
+    _target[digit--] = SEGMENT_G;
+  }
+  while (digit >= 0) {
+    _target[digit--] = 0;
+  }
+  
+  return request_refresh();
+}
+
+/**
+  Function:
+    setSegments(uint8_t digit, uint8_t segments)
+  
+  Parameters:
+    digit    -> which digit to change (0 = leftmost)
+    segments -> which segments to light (combination of SEGMENT_A ... SEGMENT_G)
+  
+  Returns:
+    status -> SENT if the digit was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Displays a custom pattern on a digit (for example letters or dashes).
+*/
+TLBFISLib::status TLBFISSegments::setSegments(uint8_t digit, uint8_t segments)
+{
+  if (digit >= _digits) {
+    return TLBFISLib::SENT;
+  }
+  
+  _target[digit] = segments & 0x7F;
+  return request_refresh();
+}
+
+/**
+  Function:
+    draw()
+  
+  Returns:
+    status -> SENT if the display was drawn, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Clears the display's area and draws all lit segments again (for example after the screen was initialized).
+*/
+TLBFISLib::status TLBFISSegments::draw()
+{
+  _drawn = false;
+  
+  //Clear the entire area, exiting if it fails.
+  TLBFISLib::status result = fill(_X, _Y, getWidth(), _digit_height, false);
+  if (result != TLBFISLib::SENT) {
+    return result;
+  }
+  
+  //Nothing is lit anymore.
+  memset(_shown, 0, sizeof(_shown));
+  _drawn = true;
+  
+  return refresh();
+}
+
+/**
+  Function:
+    invalidate()
+  
+  Description:
+    Makes the next update redraw the entire display (for example after the screen was initialized).
+*/
+void TLBFISSegments::invalidate()
+{
+  _drawn = false;
+  mark_dirty();
+}
+
+/**
+  Function:
+    getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the display (output, relative to the workspace)
+    W, H -> dimensions of the display (output)
+  
+  Description:
+    Provides the area covered by the display.
+*/
+void TLBFISSegments::getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  X = _X;
+  Y = _Y;
+  W = getWidth();
+  H = _digit_height;
+}
+
+/**
+  Function:
+    getWidth()
+  
+  Returns:
+    uint8_t -> width of the display (in pixels)
+  
+  Description:
+    Calculates how wide the display is: the digits and the spaces between them.
+*/
+uint8_t TLBFISSegments::getWidth()
+{
+  return _digits * _digit_width + (_digits - 1) * _spacing;
+}
+
+/**
+  Function:
+    refresh()
+  
+  Returns:
+    status -> SENT if the display was updated, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Updates every digit whose segments differ from the ones which should be lit, or draws everything if the screen doesn't match.
+*/
+TLBFISLib::status TLBFISSegments::refresh()
+{
+  if (!_drawn) {
+    return draw();
+  }
+  
+  TLBFISLib::status result = TLBFISLib::SENT;
+  for (uint8_t digit = 0; digit < _digits && result == TLBFISLib::SENT; digit++) {
+    result = update_digit(digit);
+  }
+  
+  return result;
+}
+
+/**
+  Function:
+    update_digit(uint8_t digit)
+  
+  Parameters:
+    digit -> which digit to update
+  
+  Returns:
+    status -> SENT if the digit was updated, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Sends a fill for every segment which turns on or off, or, if it takes fewer commands, clears the entire digit and draws its lit segments.
+*/
+TLBFISLib::status TLBFISSegments::update_digit(uint8_t digit)
+{
+  uint8_t shown = _shown[digit], target = _target[digit];
+  if (shown == target) {
+    return TLBFISLib::SENT;
+  }
+  
+  //Count the commands needed by each method.
+  uint8_t changed = 0, lit = 0;
+  for (uint8_t i = 0; i < 7; i++) {
+    changed += ((shown ^ target) >> i) & 1;
+    lit += (target >> i) & 1;
+  }
+  
+  uint8_t digit_X = _X + digit * (_digit_width + _spacing);
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result = TLBFISLib::SENT;
+  
+  //Clear the digit entirely if it's cheaper, so that only the lit segments must be drawn.
+  if (1 + lit < changed) {
+    result = fill(digit_X, _Y, _digit_width, _digit_height, false);
+    if (result == TLBFISLib::SENT) {
+      shown = 0;
+    }
+  }
+  
+  //Change the segments which differ, one at a time.
+  for (uint8_t i = 0; i < 7 && result == TLBFISLib::SENT; i++) {
+    uint8_t mask = 1 << i;
+    if ((shown ^ target) & mask) {
+      uint8_t X, Y, W, H;
+      segment_rect(i, X, Y, W, H);
+      result = fill(digit_X + X, _Y + Y, W, H, target & mask);
+      if (result == TLBFISLib::SENT) {
+        shown ^= mask;
+      }
+    }
+  }
+  
+  //If it failed, the digit's content is unknown, so the entire display will be drawn again (unless nothing was sent, see screen_untouched()).
+  if (result != TLBFISLib::SENT && !screen_untouched(FIS, blocks)) {
+    _drawn = false;
+  }
+  
+  _shown[digit] = shown;
+  return result;
+}
+
+/**
+  Function:
+    segment_rect(uint8_t segment_index, uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    segment_index -> which segment (0 = A ... 6 = G)
+    X, Y          -> position of the segment, relative to the digit (output)
+    W, H          -> dimensions of the segment (output)
+  
+  Description:
+    Calculates where a segment is: horizontal segments (A, G, D) are between the vertical ones, which leaves the corners empty.
+*/
+void TLBFISSegments::segment_rect(uint8_t segment_index, uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  uint8_t T = _thickness;
+  uint8_t middle = (_digit_height - T) / 2; //Y coordinate of segment G
+  
+  //Horizontal segments
+  if (segment_index == 0 || segment_index == 3 || segment_index == 6) {
+    X = T;
+    W = _digit_width - 2 * T;
+    H = T;
+    Y = (segment_index == 0) ? 0 : ((segment_index == 3) ? _digit_height - T : middle);
+    return;
+  }
+  
+  //Vertical segments (B, C on the right; E, F on the left)
+  X = (segment_index == 1 || segment_index == 2) ? _digit_width - T : 0;
+  W = T;
+  
+  //Upper half (B, F)
+  if (segment_index == 1 || segment_index == 5) {
+    Y = T;
+    H = middle - T;
+  }
+  //Lower half (C, E)
+  else {
+    Y = middle + T;
+    H = _digit_height - T - Y;
+  }
+}
+
+/**
+  Function:
+    fill(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on)
+  
+  Parameters:
+    X, Y      -> coordinates of the rectangle (relative to the workspace)
+    W, H      -> dimensions of the rectangle
+    pixels_on -> whether to turn the pixels on (true) or off (false)
+  
+  Returns:
+    status -> SENT if the fill was sent, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Fills a rectangle with a single command.
+*/
+TLBFISLib::status TLBFISSegments::fill(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on)
+{
+  //Draw the rectangle with the required color, keeping the user's color afterwards.
+  TLBFISLib::drawColor prev_color = FIS.getDrawColor();
+  FIS.setDrawColor(pixels_on ? TLBFISLib::NORMAL : TLBFISLib::INVERTED);
+  TLBFISLib::status result = FIS.drawRect(X, Y, W, H, TLBFISLib::FILLED);
+  FIS.setDrawColor(prev_color);
+  
+  return result;
+}
@@ -0,0 +1,71 @@
+#ifndef TLBFISSegments_h
+#define TLBFISSegments_h
+
+#include "TLBFISWidget.h" //widget base class
+
+#define TLBFIS_SEGMENTS_MAX_DIGITS 6 //how many digits a display can have
+
+class TLBFISSegments : public TLBFISWidget
+{
+  public:
+    //Segment masks for setSegments()
+    enum segment {
+      SEGMENT_A = 0x01, //top
+      SEGMENT_B = 0x02, //top right
+      SEGMENT_C = 0x04, //bottom right
+      SEGMENT_D = 0x08, //bottom
+      SEGMENT_E = 0x10, //bottom left
+      SEGMENT_F = 0x20, //top left
+      SEGMENT_G = 0x40  //middle
+    };
+    
+    //Constructor (the display starts at X, Y, relative to the workspace)
+    TLBFISSegments(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t digits, uint8_t digit_width = 10, uint8_t digit_height = 19, uint8_t thickness = 2, uint8_t spacing = 3);
+    
+    //Display a number, right-aligned, updating only the segments which change
+    TLBFISLib::status setValue(int32_t value, bool leading_zeros = false);
+    
+    //Display custom segments on a digit (0 = leftmost)
+    TLBFISLib::status setSegments(uint8_t digit, uint8_t segments);
+    
+    //Redraw the entire display
+    TLBFISLib::status draw();
+    
+    //Send the segments which differ from the displayed value
+    TLBFISLib::status refresh();
+    
+    //Make the next update redraw the entire display
+    void invalidate();
+    
+    //Get the area covered by the display
+    void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Get the width of the display (in pixels)
+    uint8_t getWidth();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Geometry (workspace coordinates)
+    uint8_t _X, _Y;
+    uint8_t _digits, _digit_width, _digit_height, _thickness, _spacing;
+    
+    //State
+    uint8_t _shown[TLBFIS_SEGMENTS_MAX_DIGITS]; //segments which are lit on the screen
+    uint8_t _target[TLBFIS_SEGMENTS_MAX_DIGITS]; //segments which should be lit
+    bool _drawn = false; //set when _shown matches the screen
+    
+    ///FUNCTIONS
+    
+    //Update a single digit, choosing between changing each segment and clearing the entire digit
+    TLBFISLib::status update_digit(uint8_t digit);
+    
+    //Get the rectangle of a segment (relative to the digit)
+    void segment_rect(uint8_t segment_index, uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Fill a rectangle, turning the pixels on or off
+    TLBFISLib::status fill(uint8_t X, uint8_t Y, uint8_t W, uint8_t H, bool pixels_on);
+};
+
+#endif
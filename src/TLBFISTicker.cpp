@@ -0,0 +1,402 @@
+#include "TLBFISTicker.h"
+
+/**
+  Function:
+    TLBFISTicker(TLBFISLib &fis, (uint8_t X), (uint8_t Y), (uint8_t W))
+  
+  Parameters:
+    fis    -> instance of the FIS library to draw with
+    (X, Y) -> coordinates of the top-left corner of the ticker (on the screen, like for setWorkspace())
+    (W)    -> width of the ticker (in pixels)
+  
+  Default parameters:
+    (X = 0)
+    (Y = 0)
+    (W = 64)
+  
+  Description:
+    Creates a ticker which scrolls a message from right to left, one pixel at a time, on a line of the COMPACT font.
+  
+  Notes:
+    *The ticker's area is used as the workspace while drawing, so characters crossing its edges are cut off by the cluster.
+    *If the workspace is already set to the ticker's area, every frame is a single text command; otherwise, the previous workspace is restored
+    after each frame, which takes two more commands.
+    *The text settings (font, transparency and alignment) are changed while drawing and restored afterwards.
+*/
+TLBFISTicker::TLBFISTicker(TLBFISLib &fis, uint8_t X, uint8_t Y, uint8_t W) :
+  FIS(fis),
+  _X(X),
+  _Y(Y),
+  _W(W ? W : 1)
+{
+  _offset = _W;
+}
+
+/**
+  Function:
+    setText(const char message[], (bool fromPGM))
+  
+  Parameters:
+    message[] -> the message to scroll
+    (fromPGM) -> whether or not the string is stored in PROGMEM
+  
+  Default parameters:
+    (fromPGM = false)
+  
+  Description:
+    Converts the message to the cluster's character set and measures each character, so that frames can be sent without doing it again.
+  
+  Notes:
+    *The message is limited to TLBFIS_TICKER_MAX_LENGTH characters.
+    *The message repeats without a gap, so it should end with a few spaces.
+    *LINE_CLEAR can't be scrolled, so it's skipped.
+    *Scrolling starts again from the right edge.
+*/
+void TLBFISTicker::setText(const char* message, bool fromPGM)
+{
+  //Characters are converted and measured for the COMPACT font.
+  TLBFISLib::font prev_font = FIS.getFont();
+  FIS.setFont(TLBFISLib::COMPACT);
+  
+  _length = 0;
+  _text_width = 0;
+  while (_length < TLBFIS_TICKER_MAX_LENGTH) {
+    uint8_t character = fromPGM ? pgm_read_byte_near(message) : *message;
+    if (!character) {
+      break;
+    }
+    message++;
+    
+    //Skip characters which aren't drawn, or which clear the rest of the line.
+    uint8_t width = FIS.charWidth(character);
+    if (!width || width > 6) {
+      continue;
+    }
+    
+    _text[_length] = FIS.encodeChar(character);
+    _widths[_length] = width;
+    _text_width += width;
+    _length++;
+  }
+  
+  //The blank characters of the COMPACT font: 2, 3, 5 and 6 pixels wide.
+  for (uint8_t i = 0; i < sizeof(_blanks); i++) {
+    _blanks[i] = FIS.encodeChar(i + 1);
+  }
+  
+  FIS.setFont(prev_font);
+  
+  restart();
+}
+
+/**
+  Function:
+    step((uint8_t pixels))
+  
+  Parameters:
+    (pixels) -> how many pixels to scroll by
+  
+  Default parameters:
+    (pixels = 1)
+  
+  Returns:
+    status -> SENT if the frame was sent, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Scrolls the message to the left and sends the new frame.
+  
+  Notes:
+    *A frame is a single text command, starting with the first character which is entirely visible; the character which is leaving the ticker
+    is not sent, so the columns on its left are cleared with blank characters only when it's dropped, and are left alone otherwise.
+    *Blank characters can't be narrower than 2 pixels, so when a 2-pixel-wide character (like "i") is dropped, the ticker scrolls by one more pixel.
+    *The work for each frame only depends on how many characters fit in the ticker, not on the length of the message.
+    *If the ticker is registered with TLBFISLib::addWidget(), the frame is only sent by TLBFISLib::update(); steps made in between are combined
+    into a single frame.
+*/
+TLBFISLib::status TLBFISTicker::step(uint8_t pixels)
+{
+  //Move the first visible character to the left, moving on to the next one when it starts leaving the ticker.
+  while (_length && pixels--) {
+    if (_offset) {
+      _offset--;
+    }
+    else {
+      _offset = _widths[_index] - 1;
+      _index = (_index + 1) % _length;
+    }
+  }
+  
+  return request_refresh();
+}
+
+/**
+  Function:
+    refresh()
+  
+  Returns:
+    status -> SENT if the frame was sent, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Sends the current frame, clearing only the columns between the ones which are already empty and the first visible character.
+*/
+TLBFISLib::status TLBFISTicker::refresh()
+{
+  //If the screen doesn't match the state, draw everything.
+  if (!_drawn) {
+    return draw();
+  }
+  
+  //Without a message, there is nothing to scroll.
+  if (!_length) {
+    return TLBFISLib::SENT;
+  }
+  
+  //Only the columns between the ones which are already empty and the first character must be cleared.
+  uint8_t startX = (_blank < _offset) ? _blank : _offset;
+  uint8_t blank_width = _offset - startX;
+  
+  //A single column can't be cleared with a blank character, so include one of the empty columns, or scroll by one more pixel if there are none.
+  if (blank_width == 1) {
+    if (startX) {
+      startX--;
+      blank_width++;
+    }
+    else {
+      _offset--;
+      blank_width = 0;
+    }
+  }
+  
+  //Enter the ticker's area and send the frame.
+  uint16_t blocks = sent_blocks(FIS);
+  TLBFISLib::status result = enter_area();
+  if (result == TLBFISLib::SENT) {
+    result = send_frame(startX, blank_width);
+  }
+  
+  //Restore the workspace and the settings, even if something failed.
+  TLBFISLib::status leave_result = leave_area();
+  if (result == TLBFISLib::SENT) {
+    result = leave_result;
+  }
+  
+  //If nothing was sent (see screen_untouched()), the previous frame is still displayed.
+  _drawn = (result == TLBFISLib::SENT || screen_untouched(FIS, blocks));
+  return result;
+}
+
+/**
+  Function:
+    draw()
+  
+  Returns:
+    status -> SENT if the ticker was drawn, FAILED or TIMED_OUT otherwise (see TLBFISLib::setRetryPolicy())
+  
+  Description:
+    Clears the ticker's area and draws the current frame (for example after the screen was initialized).
+*/
+TLBFISLib::status TLBFISTicker::draw()
+{
+  _drawn = false;
+  
+  //Enter and clear the ticker's area; the entire area is empty afterwards, so the characters can be sent without blanks.
+  TLBFISLib::status result = enter_area(true);
+  if (result == TLBFISLib::SENT && _length) {
+    result = send_frame(_offset, 0);
+  }
+  
+  //Restore the workspace and the settings, even if something failed.
+  TLBFISLib::status leave_result = leave_area();
+  if (result == TLBFISLib::SENT) {
+    result = leave_result;
+  }
+  
+  _drawn = (result == TLBFISLib::SENT);
+  return result;
+}
+
+/**
+  Function:
+    restart()
+  
+  Description:
+    Moves the message back to the right edge of the ticker, so that it scrolls in again.
+*/
+void TLBFISTicker::restart()
+{
+  _index = 0;
+  _offset = _W;
+  invalidate();
+}
+
+/**
+  Function:
+    invalidate()
+  
+  Description:
+    Makes the next step redraw the entire ticker (for example after the screen was initialized).
+*/
+void TLBFISTicker::invalidate()
+{
+  _drawn = false;
+  mark_dirty();
+}
+
+/**
+  Function:
+    getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+  
+  Parameters:
+    X, Y -> coordinates of the top-left corner of the ticker (output, on the screen)
+    W, H -> dimensions of the ticker (output)
+  
+  Description:
+    Provides the area covered by the ticker.
+*/
+void TLBFISTicker::getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H)
+{
+  X = _X;
+  Y = _Y;
+  W = _W;
+  H = TLBFIS_TICKER_HEIGHT;
+}
+
+/**
+  Function:
+    getTextWidth()
+  
+  Returns:
+    uint16_t -> width of the message (in pixels)
+  
+  Description:
+    Provides how many pixels the message must be scrolled by to repeat.
+*/
+uint16_t TLBFISTicker::getTextWidth()
+{
+  return _text_width;
+}
+
+/**
+  Function:
+    send_frame(uint8_t startX, uint8_t blank_width)
+  
+  Parameters:
+    startX      -> X coordinate where the frame starts, inside the ticker
+    blank_width -> how many columns to clear before the first visible character (0 or at least 2)
+  
+  Returns:
+    status -> SENT if the frame was sent, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Sends blank characters covering the given columns, followed by the characters visible in the ticker, as a single text command.
+*/
+TLBFISLib::status TLBFISTicker::send_frame(uint8_t startX, uint8_t blank_width)
+{
+  uint8_t frame[TLB_MAX_BYTES_PER_BLOCK - 5]; //the most characters a text command can contain
+  uint8_t max_length = FIS.getBlockSize() - 5; //how many fit in the block size used by the library
+  uint8_t length = 0;
+  uint16_t width = blank_width;
+  
+  //Cover the columns with the widest blank characters, making sure that the remainder can be covered too.
+  while (blank_width >= 8) {
+    frame[length++] = _blanks[3];
+    blank_width -= 6;
+  }
+  switch (blank_width) {
+    case 2: frame[length++] = _blanks[0]; break;
+    case 3: frame[length++] = _blanks[1]; break;
+    case 4: frame[length++] = _blanks[0]; frame[length++] = _blanks[0]; break;
+    case 5: frame[length++] = _blanks[2]; break;
+    case 6: frame[length++] = _blanks[3]; break;
+    case 7: frame[length++] = _blanks[2]; frame[length++] = _blanks[0]; break;
+  }
+  
+  //Add characters until the ticker is full, repeating the message.
+  uint8_t index = _index;
+  while (startX + width < _W && length < max_length) {
+    frame[length++] = _text[index];
+    width += _widths[index];
+    index = (index + 1) % _length;
+  }
+  
+  //Send the frame right away, instead of waiting for following text.
+  TLBFISLib::status result = FIS.writeEncodedText(startX, 0, length, frame, width);
+  if (result == TLBFISLib::SENT) {
+    result = FIS.flush();
+  }
+  
+  //The columns before the first character are empty now.
+  if (result == TLBFISLib::SENT) {
+    _blank = _offset;
+  }
+  
+  return result;
+}
+
+/**
+  Function:
+    enter_area((bool clear))
+  
+  Parameters:
+    (clear) -> whether or not to clear the ticker's area
+  
+  Default parameters:
+    (clear = false)
+  
+  Returns:
+    status -> SENT if the workspace was set, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Saves the workspace and the text settings, then sets the workspace to the ticker's area (unless it already is) and selects the settings
+    used by the ticker.
+*/
+TLBFISLib::status TLBFISTicker::enter_area(bool clear)
+{
+  //Save and replace the text settings.
+  _saved_font = FIS.getFont();
+  _saved_transparency = FIS.getTextTransparency();
+  _saved_alignment = FIS.getTextAlignment();
+  FIS.setFont(TLBFISLib::COMPACT);
+  FIS.setTextTransparency(TLBFISLib::OPAQUE);
+  FIS.setTextAlignment(TLBFISLib::LEFT);
+  
+  //Save the current workspace.
+  _saved_X = FIS.getWorkspaceX();
+  _saved_Y = FIS.getWorkspaceY();
+  _saved_W = FIS.getWorkspaceWidth();
+  _saved_H = FIS.getWorkspaceHeight();
+  
+  //If it's already the ticker's area, it only needs to be cleared (if requested).
+  if (_saved_X == _X && _saved_Y == _Y && _saved_W == _W && _saved_H == TLBFIS_TICKER_HEIGHT) {
+    _clipped = false;
+    return clear ? FIS.clear() : TLBFISLib::SENT;
+  }
+  
+  _clipped = true;
+  return FIS.setWorkspace(_X, _Y, _W, TLBFIS_TICKER_HEIGHT, clear);
+}
+
+/**
+  Function:
+    leave_area()
+  
+  Returns:
+    status -> SENT if the workspace was restored, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Restores the text settings and the workspace which were saved by enter_area().
+*/
+TLBFISLib::status TLBFISTicker::leave_area()
+{
+  FIS.setFont(_saved_font);
+  FIS.setTextTransparency(_saved_transparency);
+  FIS.setTextAlignment(_saved_alignment);
+  
+  //If the workspace wasn't changed, there is nothing else to do.
+  if (!_clipped) {
+    return TLBFISLib::SENT;
+  }
+  
+  _clipped = false;
+  return FIS.setWorkspace(_saved_X, _saved_Y, _saved_W, _saved_H);
+}
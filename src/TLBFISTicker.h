@@ -0,0 +1,80 @@
+#ifndef TLBFISTicker_h
+#define TLBFISTicker_h
+
+#include "TLBFISWidget.h" //widget base class
+
+#define TLBFIS_TICKER_MAX_LENGTH 64 //how many characters a ticker message can have
+#define TLBFIS_TICKER_HEIGHT     7  //height of the ticker's line (COMPACT font)
+
+class TLBFISTicker : public TLBFISWidget
+{
+  public:
+    //Constructor (the ticker occupies a single line of width W, starting at X, Y)
+    TLBFISTicker(TLBFISLib &fis, uint8_t X = 0, uint8_t Y = 0, uint8_t W = 64);
+    
+    //Set the message (it's converted once and copied, so the string doesn't need to remain valid)
+    void setText(const char* message, bool fromPGM = false);
+    
+    //Scroll the message to the left by the given number of pixels
+    TLBFISLib::status step(uint8_t pixels = 1);
+    
+    //Draw the current frame
+    TLBFISLib::status draw();
+    
+    //Send the current frame, clearing only what the previous one left behind
+    TLBFISLib::status refresh();
+    
+    //Start scrolling again from the right edge
+    void restart();
+    
+    //Make the next update redraw the entire ticker
+    void invalidate();
+    
+    //Get the area covered by the ticker
+    void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H);
+    
+    //Get the total width of the message (in pixels)
+    uint16_t getTextWidth();
+  
+  private:
+    //Instance of the FIS library.
+    TLBFISLib &FIS;
+    
+    //Area of the ticker (screen coordinates)
+    uint8_t _X, _Y, _W;
+    
+    //Message, in the cluster's character set
+    uint8_t _text[TLBFIS_TICKER_MAX_LENGTH];
+    uint8_t _widths[TLBFIS_TICKER_MAX_LENGTH]; //width of each character (in pixels)
+    uint8_t _length = 0;
+    uint16_t _text_width = 0;
+    
+    //Blank characters of the COMPACT font (2, 3, 5 and 6 pixels wide), in the cluster's character set
+    uint8_t _blanks[4];
+    
+    //State
+    uint8_t _index = 0; //first character which is entirely visible
+    uint8_t _offset = 0; //X coordinate of that character, inside the ticker
+    uint8_t _blank = 0; //how many columns on the left of the ticker are known to be empty
+    bool _drawn = false; //set when the screen matches the state above
+    
+    //Workspace which was set before the ticker started drawing
+    uint8_t _saved_X, _saved_Y, _saved_W, _saved_H;
+    bool _clipped = false; //set while the workspace is not the one the ticker was entered with
+    
+    //Text settings which were set before the ticker started drawing
+    TLBFISLib::font _saved_font;
+    TLBFISLib::transparency _saved_transparency;
+    TLBFISLib::alignment _saved_alignment;
+    
+    ///FUNCTIONS
+    
+    //Send a frame, covering the given number of columns on the left with blank characters
+    TLBFISLib::status send_frame(uint8_t startX, uint8_t blank_width);
+    
+    //Manage the workspace and text settings
+    TLBFISLib::status enter_area(bool clear = false);
+    TLBFISLib::status leave_area();
+};
+
+#endif
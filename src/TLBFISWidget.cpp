@@ -0,0 +1,164 @@
+#include "TLBFISWidget.h"
+
+/**
+  Function:
+    setRefreshInterval(uint16_t interval_ms)
+  
+  Parameters:
+    interval_ms -> shortest time between two refreshes (in milliseconds, 0 = refresh on every call to update())
+  
+  Description:
+    Limits how often TLBFISLib::update() refreshes the widget, so that a value which changes very often doesn't take up the entire bus.
+  
+  Notes:
+    *Only applies to widgets registered with TLBFISLib::addWidget(); other widgets are updated as soon as they change.
+    *Changes made between two refreshes are combined, so only the latest state is sent.
+*/
+void TLBFISWidget::setRefreshInterval(uint16_t interval_ms)
+{
+  _interval = interval_ms;
+}
+
+/**
+  Function:
+    getRefreshInterval()
+  
+  Returns:
+    uint16_t -> shortest time between two refreshes (in milliseconds)
+  
+  Description:
+    Provides the interval set by setRefreshInterval().
+*/
+uint16_t TLBFISWidget::getRefreshInterval()
+{
+  return _interval;
+}
+
+/**
+  Function:
+    isDirty()
+  
+  Returns:
+    bool -> whether or not the widget has changes which weren't displayed yet
+  
+  Description:
+    Checks if the widget is waiting to be refreshed.
+*/
+bool TLBFISWidget::isDirty()
+{
+  return _dirty;
+}
+
+/**
+  Function:
+    request_refresh()
+  
+  Returns:
+    status -> SENT if the widget was refreshed (or will be refreshed by update()), FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Marks the widget as dirty; if it isn't registered with a library, it's refreshed right away.
+*/
+TLBFISLib::status TLBFISWidget::request_refresh()
+{
+  _dirty = true;
+  
+  //Registered widgets are refreshed by update(), when their interval has passed.
+  if (_scheduler) {
+    return TLBFISLib::SENT;
+  }
+  
+  return run_refresh();
+}
+
+/**
+  Function:
+    mark_dirty()
+  
+  Description:
+    Marks the widget as dirty, without refreshing it.
+*/
+void TLBFISWidget::mark_dirty()
+{
+  _dirty = true;
+}
+
+/**
+  Function:
+    sent_blocks(TLBFISLib &fis)
+  
+  Parameters:
+    fis -> library which sends the widget's changes
+  
+  Returns:
+    uint16_t -> how many blocks the cluster has accepted (wrapping around)
+  
+  Description:
+    Provides the count which screen_untouched() compares with, taken before a change is sent.
+*/
+uint16_t TLBFISWidget::sent_blocks(TLBFISLib &fis)
+{
+  return fis._sent_blocks;
+}
+
+/**
+  Function:
+    screen_untouched(TLBFISLib &fis, uint16_t blocks_before)
+  
+  Parameters:
+    fis           -> library which sends the widget's changes
+    blocks_before -> count given by sent_blocks() before the change
+  
+  Returns:
+    bool -> whether or not the screen is known to be as it was before the change
+  
+  Description:
+    Checks if a change which wasn't sent was given up because the cluster ended its turn on a shared bus (see TLBFISBus::setSlice()), before
+    any of its blocks was accepted.
+  
+  Notes:
+    *In that case the widget keeps what it knows about the screen and only stays dirty, instead of being drawn again from scratch on every turn.
+    *Other failures leave the screen unknown, since the cluster may have shown a block it reported as failed.
+*/
+bool TLBFISWidget::screen_untouched(TLBFISLib &fis, uint16_t blocks_before)
+{
+  return fis._bus_yielded && fis._sent_blocks == blocks_before;
+}
+
+/**
+  Function:
+    is_due()
+  
+  Returns:
+    bool -> whether or not the widget should be refreshed now
+  
+  Description:
+    Checks if the widget is dirty and enough time has passed since it was last refreshed.
+*/
+bool TLBFISWidget::is_due()
+{
+  return _dirty && millis() - _last_refresh >= _interval;
+}
+
+/**
+  Function:
+    run_refresh()
+  
+  Returns:
+    status -> SENT if the widget was refreshed, FAILED or TIMED_OUT otherwise
+  
+  Description:
+    Refreshes the widget; if it fails, the widget remains dirty so that it's refreshed again later.
+*/
+TLBFISLib::status TLBFISWidget::run_refresh()
+{
+  _dirty = false;
+  _last_refresh = millis();
+  
+  TLBFISLib::status result = refresh();
+  if (result != TLBFISLib::SENT) {
+    _dirty = true;
+  }
+  
+  return result;
+}
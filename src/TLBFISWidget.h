@@ -0,0 +1,65 @@
+#ifndef TLBFISWidget_h
+#define TLBFISWidget_h
+
+#include "TLBFISLib.h" //FIS library
+
+class TLBFISWidget
+{
+  public:
+    //Redraw the entire widget
+    virtual TLBFISLib::status draw() = 0;
+    
+    //Send the changes which weren't displayed yet
+    virtual TLBFISLib::status refresh() = 0;
+    
+    //Make the next update redraw the entire widget
+    virtual void invalidate() = 0;
+    
+    //Get the area covered by the widget (in the same coordinates as the ones given to its constructor)
+    virtual void getBounds(uint8_t &X, uint8_t &Y, uint8_t &W, uint8_t &H) = 0;
+    
+    //Set the shortest time between two refreshes by TLBFISLib::update() (in milliseconds, 0 = every call)
+    void setRefreshInterval(uint16_t interval_ms);
+    //Get the shortest time between two refreshes
+    uint16_t getRefreshInterval();
+    
+    //Check if the widget has changes which weren't displayed yet
+    bool isDirty();
+  
+  protected:
+    //Record that the widget has changes to display, and display them right away unless the widget is refreshed by TLBFISLib::update()
+    TLBFISLib::status request_refresh();
+    
+    //Record that the widget has changes to display
+    void mark_dirty();
+    
+    //Count the blocks accepted by the cluster so far, before a change which may be given up
+    uint16_t sent_blocks(TLBFISLib &fis);
+    
+    //Check if a change which was given up left the screen as it was, because the cluster gave up its bus turn before accepting any of its blocks
+    bool screen_untouched(TLBFISLib &fis, uint16_t blocks_before);
+  
+  private:
+    //The registry and the scheduler are managed by the FIS library.
+    friend class TLBFISLib;
+    
+    //Registry
+    TLBFISLib* _scheduler = nullptr; //library which refreshes the widget (nullptr = not registered)
+    TLBFISWidget* _next_widget = nullptr; //next widget in the registry
+    TLBFISLib::lane _lane = TLBFISLib::LANE_NORMAL; //priority of the widget's refreshes
+    
+    //Scheduling
+    uint16_t _interval = 0; //shortest time between two refreshes (in milliseconds)
+    unsigned long _last_refresh = 0; //when the widget was last refreshed (in milliseconds)
+    bool _dirty = false; //set while there are changes which weren't displayed yet
+    
+    ///FUNCTIONS
+    
+    //Check if the widget is dirty and its interval has passed
+    bool is_due();
+    
+    //Refresh the widget, keeping it dirty if it fails
+    TLBFISLib::status run_refresh();
+};
+
+#endif